@@ -3,11 +3,21 @@
 #ifndef MASM_VM_H
 #define MASM_VM_H
 
-#include <qv4engine_p.h>
+#include <private/qv4executableallocator_p.h>
 
 namespace JSC {
 
-class VM : public QV4::ExecutionEngine {};
+// What the regular expression JIT needs from its VM. QV4::RegExpCodeCache owns the only
+// instance, so that the generated code can be shared between engines.
+class VM
+{
+public:
+    QV4::ExecutableAllocator *regExpAllocator = nullptr;
+
+    // The generated code runs on the threads of all engines. Therefore, the code doesn't set
+    // this itself. It's set by the caller, for the current thread.
+    static thread_local quint8 isExecutingInRegExpJIT;
+};
 
 }
 
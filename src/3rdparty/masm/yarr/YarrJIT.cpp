@@ -689,7 +689,7 @@ class YarrGenerator : private DefaultMacroAssembler {
 
     void generateJITFailReturn()
     {
-        if (m_abortExecution.empty() && m_hitMatchLimit.empty())
+        if (m_abortExecution.empty() && m_hitMatchLimit.empty() && m_interpretMatch.empty())
             return;
 
         JumpList finishExiting;
@@ -699,6 +699,12 @@ class YarrGenerator : private DefaultMacroAssembler {
             finishExiting.append(jump());
         }
 
+        if (!m_interpretMatch.empty()) {
+            m_interpretMatch.link(this);
+            move(TrustedImmPtr((void*)static_cast<size_t>(-3)), returnRegister);
+            finishExiting.append(jump());
+        }
+
         if (!m_hitMatchLimit.empty()) {
             m_hitMatchLimit.link(this);
             move(TrustedImmPtr((void*)static_cast<size_t>(-1)), returnRegister);
@@ -1148,6 +1154,12 @@ class YarrGenerator : private DefaultMacroAssembler {
             characterMatchFails.append(branch32(NotEqual, character, patternCharacter));
         else {
             Jump charactersMatch = branch32(Equal, character, patternCharacter);
+            if (m_charSize != Char8) {
+                // Only Latin-1 characters are folded here. Let the interpreter redo this match
+                // if there are others. The code stays valid for other subjects.
+                m_interpretMatch.append(branch32(Above, character, TrustedImm32(0xff)));
+                m_interpretMatch.append(branch32(Above, patternCharacter, TrustedImm32(0xff)));
+            }
             ExtendedAddress characterTableEntry(character, reinterpret_cast<intptr_t>(&canonicalTableLChar));
             load16(characterTableEntry, character);
             ExtendedAddress patternTableEntry(patternCharacter, reinterpret_cast<intptr_t>(&canonicalTableLChar));
@@ -1168,11 +1180,6 @@ class YarrGenerator : private DefaultMacroAssembler {
         YarrOp& op = m_ops[opIndex];
         PatternTerm* term = op.m_term;
 
-        if (m_pattern.ignoreCase() && m_charSize != Char8) {
-            m_failureReason = JITFailureReason::BackReference;
-            return;
-        }
-
         unsigned subpatternId = term->backReferenceSubpatternId;
         unsigned parenthesesFrameLocation = term->frameLocation;
 
@@ -2113,7 +2120,7 @@ class YarrGenerator : private DefaultMacroAssembler {
             break;
 
         case PatternTerm::TypeForwardReference:
-            m_failureReason = JITFailureReason::ForwardReference;
+            // A reference to a group that hasn't matched yet always matches the empty string.
             break;
 
         case PatternTerm::TypeParenthesesSubpattern:
@@ -2185,7 +2192,7 @@ class YarrGenerator : private DefaultMacroAssembler {
             break;
 
         case PatternTerm::TypeForwardReference:
-            m_failureReason = JITFailureReason::ForwardReference;
+            backtrackTermDefault(opIndex);
             break;
 
         case PatternTerm::TypeParenthesesSubpattern:
@@ -3743,14 +3750,10 @@ class YarrGenerator : private DefaultMacroAssembler {
 #elif CPU(MIPS)
         // Do nothing.
 #endif
-
-        store8(TrustedImm32(1), &m_vm->isExecutingInRegExpJIT);
     }
 
     void generateReturn()
     {
-        store8(TrustedImm32(0), &m_vm->isExecutingInRegExpJIT);
-
 #if CPU(X86_64)
 #if OS(WINDOWS)
         // Store the return value in the allocated space pointed by rcx.
@@ -3828,7 +3831,7 @@ public:
 
         if (m_pattern.m_containsBackreferences
 #if ENABLE(YARR_JIT_BACKREFERENCES)
-            && (compileMode == MatchOnly || (m_pattern.ignoreCase() && m_charSize != Char8))
+            && compileMode == MatchOnly
 #endif
             ) {
                 codeBlock.setFallBackWithFailureReason(JITFailureReason::BackReference);
@@ -3956,6 +3959,7 @@ private:
 #endif
     JumpList m_abortExecution;
     JumpList m_hitMatchLimit;
+    JumpList m_interpretMatch;
     Vector<Call> m_tryReadUnicodeCharacterCalls;
     Label m_tryReadUnicodeCharacterEntry;
 
@@ -6,6 +6,7 @@
 #include <private/qqmlcontext_p.h>
 #include <private/qqmldebugservice_p.h>
 #include <private/qv4jscall_p.h>
+#include <private/qv4mm_p.h>
 #include <private/qv4qmlcontext_p.h>
 #include <private/qv4qobjectwrapper_p.h>
 #include <private/qv4script_p.h>
@@ -13,6 +14,7 @@
 
 #include <QtQml/qqmlengine.h>
 
+#include <QtCore/qbuffer.h>
 #include <QtCore/qpointer.h>
 
 QT_BEGIN_NAMESPACE
@@ -245,6 +247,27 @@ const QStringList &GatherSourcesJob::result() const
     return sources;
 }
 
+HeapSnapshotJob::HeapSnapshotJob(QV4::ExecutionEngine *engine)
+    : engine(engine), success(false)
+{}
+
+void HeapSnapshotJob::run()
+{
+    QBuffer buffer(&snapshot);
+    buffer.open(QIODevice::WriteOnly);
+    success = engine->memoryManager->writeHeapSnapshot(&buffer);
+}
+
+bool HeapSnapshotJob::hasSnapshot() const
+{
+    return success;
+}
+
+const QByteArray &HeapSnapshotJob::result() const
+{
+    return snapshot;
+}
+
 EvalJob::EvalJob(QV4::ExecutionEngine *engine, const QString &script) :
     JavaScriptJob(engine, /*frameNr*/-1, /*context*/ -1, script), result(false)
 {}
@@ -116,6 +116,19 @@ public:
     const QStringList &result() const;
 };
 
+class HeapSnapshotJob: public QV4DebugJob
+{
+    QV4::ExecutionEngine *engine;
+    QByteArray snapshot;
+    bool success;
+
+public:
+    HeapSnapshotJob(QV4::ExecutionEngine *engine);
+    void run() override;
+    bool hasSnapshot() const;
+    const QByteArray &result() const;
+};
+
 class EvalJob: public JavaScriptJob
 {
     bool result;
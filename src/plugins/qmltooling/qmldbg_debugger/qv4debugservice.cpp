@@ -637,6 +637,66 @@ public:
         }
     }
 };
+
+// Request:
+// {
+//   "seq": 6,
+//   "type": "request",
+//   "command": "heapsnapshot"
+// }
+//
+// Response:
+// {
+//   "body": {
+//     "snapshot": "{\"snapshot\":{\"meta\": ... }"
+//   },
+//   "command": "heapsnapshot",
+//   "request_seq": 6,
+//   "running": true,
+//   "seq": 7,
+//   "success": true,
+//   "type": "response"
+// }
+//
+// The "snapshot" key holds the heap of the engine in the .heapsnapshot format of the Chrome
+// DevTools. Collecting it runs the garbage collector.
+class V4HeapSnapshotRequest: public V4CommandHandler
+{
+public:
+    V4HeapSnapshotRequest(): V4CommandHandler(QStringLiteral("heapsnapshot")) {}
+
+    void handleRequest() override
+    {
+        QV4Debugger *debugger = debugService->debuggerAgent.pausedDebugger();
+        if (!debugger) {
+            const QList<QV4Debugger *> &debuggers = debugService->debuggerAgent.debuggers();
+            if (debuggers.size() > 1) {
+                createErrorResponse(QStringLiteral("Cannot take a heap snapshot if multiple debuggers are running and none is paused"));
+                return;
+            } else if (debuggers.size() == 0) {
+                createErrorResponse(QStringLiteral("No debuggers available to take a heap snapshot"));
+                return;
+            }
+            debugger = debuggers.first();
+        }
+
+        HeapSnapshotJob job(debugger->engine());
+        debugger->runInEngine(&job);
+        if (!job.hasSnapshot()) {
+            createErrorResponse(QStringLiteral("Cannot take a heap snapshot while the garbage collector is blocked"));
+            return;
+        }
+
+        QJsonObject body;
+        body[QLatin1String("snapshot")] = QString::fromUtf8(job.result());
+
+        addCommand();
+        addRequestSequence();
+        addSuccess(true);
+        addRunning();
+        addBody(body);
+    }
+};
 } // anonymous namespace
 
 void QV4DebugServiceImpl::addHandler(V4CommandHandler* handler)
@@ -671,6 +731,7 @@ QV4DebugServiceImpl::QV4DebugServiceImpl(QObject *parent) :
     addHandler(new V4SetExceptionBreakRequest);
     addHandler(new V4ScriptsRequest);
     addHandler(new V4EvaluateRequest);
+    addHandler(new V4HeapSnapshotRequest);
 }
 
 QV4DebugServiceImpl::~QV4DebugServiceImpl()
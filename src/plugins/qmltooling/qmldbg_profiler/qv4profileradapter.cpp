@@ -41,6 +41,15 @@ qint64 QV4ProfilerAdapter::appendMemoryEvents(qint64 until, QList<QByteArray> &m
     while (memoryData.size() > m_memoryPos && memoryData[m_memoryPos].timestamp <= until) {
         const QV4::Profiling::MemoryAllocationProperties &props = memoryData[m_memoryPos];
         d << props.timestamp << int(MemoryAllocation) << int(props.type) << props.size;
+        if (props.site) {
+            d << static_cast<qint64>(props.site);
+            // The location is sent along with the first allocation of each site.
+            auto location = m_allocationSiteLocations.constFind(props.site);
+            if (location != m_allocationSiteLocations.cend()) {
+                d << location->file << location->line << location->column << location->name;
+                m_allocationSiteLocations.erase(location);
+            }
+        }
         ++m_memoryPos;
         messages.append(d.squeezedData());
         d.clear();
@@ -125,7 +134,8 @@ qint64 QV4ProfilerAdapter::sendMessages(qint64 until, QList<QByteArray> &message
 void QV4ProfilerAdapter::receiveData(
         const QV4::Profiling::FunctionLocationHash &locations,
         const QVector<QV4::Profiling::FunctionCallProperties> &functionCallData,
-        const QVector<QV4::Profiling::MemoryAllocationProperties> &memoryData)
+        const QVector<QV4::Profiling::MemoryAllocationProperties> &memoryData,
+        const QV4::Profiling::FunctionLocationHash &allocationSites)
 {
     // In rare cases it could be that another flush or stop event is processed while data from
     // the previous one is still pending. In that case we just append the data.
@@ -144,6 +154,11 @@ void QV4ProfilerAdapter::receiveData(
     else
         m_memoryData.append(memoryData);
 
+    if (m_allocationSiteLocations.isEmpty())
+        m_allocationSiteLocations = allocationSites;
+    else
+        m_allocationSiteLocations.insert(allocationSites);
+
     service->dataReady(this);
 }
 
@@ -16,6 +16,9 @@
 #include <QtCore/qstandardpaths.h>
 #include <QtCore/qxpfunctional.h>
 
+#include <algorithm>
+#include <limits>
+
 static_assert(QV4::CompiledData::QmlCompileHashSpace > QML_COMPILE_HASH_LENGTH);
 
 #if defined(QML_COMPILE_HASH) && defined(QML_COMPILE_HASH_LENGTH) && QML_COMPILE_HASH_LENGTH > 0
@@ -86,6 +89,136 @@ bool Unit::verifyHeader(QDateTime expectedSourceTimeStamp, QString *errorString)
     return true;
 }
 
+bool UnitPack::verify(qsizetype fileSize, QString *errorString) const
+{
+    if (fileSize < qsizetype(sizeof(UnitPack))) {
+        *errorString = QStringLiteral("File too small for the header fields");
+        return false;
+    }
+
+    if (strncmp(magic, unit_pack_magic_str, sizeof(magic))) {
+        *errorString = QStringLiteral("Magic bytes in the header do not match");
+        return false;
+    }
+
+    if (version != quint32(QV4_DATA_STRUCTURE_VERSION) || qtVersion != quint32(QT_VERSION)) {
+        *errorString = QStringLiteral("Pack file was created for a different version of Qt");
+        return false;
+    }
+
+    const qint64 indexSize = qint64(sizeof(UnitPack)) + qint64(entryCount) * sizeof(UnitPackEntry);
+    if (packSize > fileSize || indexSize > packSize) {
+        *errorString = QStringLiteral("Potential file corruption, file too small");
+        return false;
+    }
+
+    const QByteArray checksum = QCryptographicHash::hash(
+            QByteArrayView(dataAt(sizeof(UnitPack)), packSize - sizeof(UnitPack)),
+            QCryptographicHash::Md5);
+    if (memcmp(checksum.constData(), md5Checksum, sizeof(md5Checksum))) {
+        *errorString = QStringLiteral("Checksum of the pack file does not match");
+        return false;
+    }
+
+    for (quint32 i = 0; i < entryCount; ++i) {
+        const UnitPackEntry &entry = entries()[i];
+        if (qint64(entry.nameOffset) + entry.nameSize > packSize
+                || qint64(entry.unitOffset) + entry.unitSize > packSize
+                || entry.unitSize < sizeof(Unit) || entry.unitOffset % 16 != 0
+                || reinterpret_cast<const Unit *>(dataAt(entry.unitOffset))->unitSize
+                        != entry.unitSize) {
+            *errorString = QStringLiteral("Pack file has an invalid index");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+const Unit *UnitPack::unit(QByteArrayView fileName) const
+{
+    const UnitPackEntry *begin = entries();
+    const UnitPackEntry *end = begin + entryCount;
+    const auto nameOf = [this](const UnitPackEntry &entry) {
+        return QByteArrayView(dataAt(entry.nameOffset), entry.nameSize);
+    };
+
+    const UnitPackEntry *it = std::lower_bound(
+            begin, end, fileName, [&nameOf](const UnitPackEntry &entry, QByteArrayView name) {
+        return nameOf(entry) < name;
+    });
+    if (it == end || nameOf(*it) != fileName)
+        return nullptr;
+    return reinterpret_cast<const Unit *>(dataAt(it->unitOffset));
+}
+
+bool UnitPackBuilder::addUnit(
+        const QString &fileName, const char *data, quint32 size, QString *errorString)
+{
+    if (size < sizeof(Unit)) {
+        *errorString = QStringLiteral("Compilation unit for %1 is too small").arg(fileName);
+        return false;
+    }
+
+    const QByteArray name = fileName.toUtf8();
+    if (m_units.contains(name)) {
+        *errorString = QStringLiteral("Duplicate file name %1").arg(fileName);
+        return false;
+    }
+
+    m_units.insert(name, QByteArray(data, size));
+    return true;
+}
+
+bool UnitPackBuilder::writeToFile(const QString &outputFileName, QString *errorString) const
+{
+    std::vector<UnitPackEntry> entries(m_units.size());
+
+    qint64 offset = qint64(sizeof(UnitPack)) + qint64(entries.size()) * sizeof(UnitPackEntry);
+    auto entry = entries.begin();
+    for (auto it = m_units.constBegin(), end = m_units.constEnd(); it != end; ++it, ++entry) {
+        entry->nameOffset = quint32(offset);
+        entry->nameSize = quint32(it.key().size());
+        offset += it.key().size();
+    }
+
+    entry = entries.begin();
+    for (auto it = m_units.constBegin(), end = m_units.constEnd(); it != end; ++it, ++entry) {
+        offset = (offset + 15) & ~qint64(15);
+        entry->unitOffset = quint32(offset);
+        entry->unitSize = quint32(it.value().size());
+        offset += it.value().size();
+    }
+
+    if (offset > std::numeric_limits<quint32>::max()) {
+        *errorString = QStringLiteral("Pack file would be too large");
+        return false;
+    }
+
+    QByteArray contents(qsizetype(offset), '\0');
+    UnitPack *pack = reinterpret_cast<UnitPack *>(contents.data());
+    memcpy(pack->magic, unit_pack_magic_str, sizeof(pack->magic));
+    pack->version = QV4_DATA_STRUCTURE_VERSION;
+    pack->qtVersion = QT_VERSION;
+    pack->entryCount = quint32(entries.size());
+    pack->packSize = quint32(offset);
+    memcpy(contents.data() + sizeof(UnitPack), entries.data(),
+           entries.size() * sizeof(UnitPackEntry));
+
+    entry = entries.begin();
+    for (auto it = m_units.constBegin(), end = m_units.constEnd(); it != end; ++it, ++entry) {
+        memcpy(contents.data() + entry->nameOffset, it.key().constData(), it.key().size());
+        memcpy(contents.data() + entry->unitOffset, it.value().constData(), it.value().size());
+    }
+
+    const QByteArray checksum = QCryptographicHash::hash(
+            QByteArrayView(contents).sliced(sizeof(UnitPack)), QCryptographicHash::Md5);
+    memcpy(pack->md5Checksum, checksum.constData(), sizeof(pack->md5Checksum));
+
+    return SaveableUnitPointer::writeDataToFile(
+            outputFileName, contents.constData(), quint32(contents.size()), errorString);
+}
+
 /*!
     \internal
     This function creates a temporary key vector and sorts it to guarantuee a stable
@@ -152,6 +285,29 @@ QString CompilationUnit::localCacheFilePath(const QUrl &url)
             + QLatin1Char('.') + cacheFileSuffix;
 }
 
+static QList<quint32> readJitProfile(const Unit *unit, QByteArrayView section)
+{
+    QList<quint32> functionIndices;
+    if (section.size() < qsizetype(sizeof(JitProfile)))
+        return functionIndices;
+
+    const JitProfile *profile = reinterpret_cast<const JitProfile *>(section.data());
+    if (strncmp(profile->magic, jit_profile_magic_str, sizeof(profile->magic))
+            || memcmp(profile->unitChecksum, unit->md5Checksum, sizeof(profile->unitChecksum))
+            || profile->functionCount > unit->functionTableSize
+            || section.size() < JitProfile::calculateSize(profile->functionCount)) {
+        return functionIndices;
+    }
+
+    functionIndices.reserve(profile->functionCount);
+    const quint32_le *indices = profile->functionIndices();
+    for (quint32 i = 0; i < profile->functionCount; ++i) {
+        if (indices[i] < unit->functionTableSize)
+            functionIndices.append(indices[i]);
+    }
+    return functionIndices;
+}
+
 bool CompilationUnit::loadFromDisk(
         const QUrl &url, const QDateTime &sourceTimeStamp, QString *errorString)
 {
@@ -163,9 +319,20 @@ bool CompilationUnit::loadFromDisk(
     const QString sourcePath = QQmlFile::urlToLocalFileOrQrc(url);
     auto cacheFile = std::make_unique<CompilationUnitMapper>();
 
-    const QStringList cachePaths = { sourcePath + QLatin1Char('c'), localCacheFilePath(url) };
-    for (const QString &cachePath : cachePaths) {
-        Unit *mappedUnit = cacheFile->get(cachePath, sourceTimeStamp, errorString);
+    // The pack file of the directory comes first. Once it is mapped, looking units up in it
+    // does not need any file system access.
+    enum CacheLocation { PackFile, NextToSource, LocalCache };
+    for (int location = PackFile; location <= LocalCache; ++location) {
+        QString cachePath;
+        Unit *mappedUnit = nullptr;
+        if (location == PackFile) {
+            mappedUnit = cacheFile->getFromPack(sourcePath, sourceTimeStamp, errorString);
+        } else {
+            cachePath = (location == NextToSource)
+                    ? sourcePath + QLatin1Char('c')
+                    : localCacheFilePath(url);
+            mappedUnit = cacheFile->get(cachePath, sourceTimeStamp, errorString);
+        }
         if (!mappedUnit)
             continue;
 
@@ -195,6 +362,8 @@ bool CompilationUnit::loadFromDisk(
 
         dataPtrRevert.dismiss();
         free(const_cast<Unit*>(oldDataPtr));
+        jitProfile = readJitProfile(mappedUnit, cacheFile->trailingData());
+        localCachePath = (location == LocalCache) ? cachePath : QString();
         backingFile = std::move(cacheFile);
         return true;
     }
@@ -227,6 +396,43 @@ bool CompilationUnit::saveToDisk(const QUrl &unitUrl, QString *errorString)
             });
 }
 
+/*!
+    \internal
+    Rewrites the cache file this unit was loaded from, with a JitProfile listing
+    \a functionIndices appended to it.
+ */
+bool CompilationUnit::saveJitProfile(const QList<quint32> &functionIndices, QString *errorString)
+{
+    if (localCachePath.isEmpty()) {
+        *errorString = QStringLiteral("Unit was not loaded from the local disk cache.");
+        return false;
+    }
+
+    // The unit is mapped read-only from the cache file. It can be written back as it is.
+    const quint32 unitSize = unitData()->unitSize;
+    QByteArray contents(unitSize + JitProfile::calculateSize(functionIndices.size()),
+                        Qt::Uninitialized);
+    memcpy(contents.data(), unitData(), unitSize);
+
+    JitProfile *profile = reinterpret_cast<JitProfile *>(contents.data() + unitSize);
+    memcpy(profile->magic, jit_profile_magic_str, sizeof(profile->magic));
+    memcpy(profile->unitChecksum, unitData()->md5Checksum, sizeof(profile->unitChecksum));
+    profile->functionCount = quint32(functionIndices.size());
+    profile->padding = 0;
+    quint32_le *indices = const_cast<quint32_le *>(profile->functionIndices());
+    for (qsizetype i = 0, end = functionIndices.size(); i < end; ++i)
+        indices[i] = functionIndices[i];
+
+    if (!SaveableUnitPointer::writeDataToFile(
+                localCachePath, contents.constData(), quint32(contents.size()), errorString)) {
+        return false;
+    }
+
+    CompilationUnitMapper::invalidate(localCachePath);
+    jitProfile = functionIndices;
+    return true;
+}
+
 QStringList CompilationUnit::moduleRequests() const
 {
     QStringList requests;
@@ -20,6 +20,7 @@
 #include <QtCore/qhash.h>
 #include <QtCore/qhashfunctions.h>
 #include <QtCore/qlocale.h>
+#include <QtCore/qmap.h>
 #include <QtCore/qscopeguard.h>
 #include <QtCore/qstring.h>
 #include <QtCore/qstringlist.h>
@@ -1381,6 +1382,84 @@ struct Unit
 
 static_assert(sizeof(Unit) == 248, "Unit structure needs to have the expected size to be binary compatible on disk when generated by host compiler and loaded by target");
 
+static const char jit_profile_magic_str[] = "qv4jitpr";
+
+// Optional section following the unit in a cache file. It lists the functions the JIT compiled
+// while the unit was in use, so that they can be compiled on their first call the next time.
+// The section is not covered by the checksum of the unit. Instead it records the checksum of the
+// unit it was written for and is ignored if the unit has changed since.
+struct JitProfile
+{
+    char magic[8];
+    char unitChecksum[16];
+    quint32_le functionCount;
+    quint32_le padding;
+
+    const quint32_le *functionIndices() const
+    {
+        return reinterpret_cast<const quint32_le *>(this + 1);
+    }
+
+    static int calculateSize(int functionCount)
+    {
+        return sizeof(JitProfile) + functionCount * sizeof(quint32_le);
+    }
+};
+static_assert(sizeof(JitProfile) == 32, "JitProfile structure needs to have the expected size to be binary compatible on disk when generated by host compiler and loaded by target");
+
+static const char unit_pack_magic_str[] = "qv4cpack";
+
+// Name of the pack file the engine looks for in the directory of a QML or JavaScript file.
+static const char unit_pack_file_name[] = "qmlcache.qmlcpack";
+
+struct UnitPackEntry
+{
+    quint32_le nameOffset; // UTF-8 file name, relative to the directory of the pack
+    quint32_le nameSize;
+    quint32_le unitOffset;
+    quint32_le unitSize;
+};
+static_assert(sizeof(UnitPackEntry) == 16, "UnitPackEntry structure needs to have the expected size to be binary compatible on disk when generated by host compiler and loaded by target");
+
+// Bundles the compilation units of the files in one directory, so that they can be mapped with a
+// single file system access. The header is followed by the entries, sorted by name, the names
+// and then the units, each aligned to 16 bytes. The checksum covers everything after the header
+// and is verified once, when the pack is mapped. The units themselves are checked as usual.
+struct UnitPack
+{
+    char magic[8];
+    quint32_le version;
+    quint32_le qtVersion;
+    quint32_le entryCount;
+    quint32_le packSize;
+    char md5Checksum[16];
+
+    const UnitPackEntry *entries() const
+    {
+        return reinterpret_cast<const UnitPackEntry *>(this + 1);
+    }
+
+    const char *dataAt(quint32 offset) const
+    {
+        return reinterpret_cast<const char *>(this) + offset;
+    }
+
+    bool verify(qsizetype fileSize, QString *errorString) const;
+    const Unit *unit(QByteArrayView fileName) const;
+};
+static_assert(sizeof(UnitPack) == 40, "UnitPack structure needs to have the expected size to be binary compatible on disk when generated by host compiler and loaded by target");
+
+class Q_QML_EXPORT UnitPackBuilder
+{
+public:
+    // The unit has to be in the form SaveableUnitPointer writes to disk.
+    bool addUnit(const QString &fileName, const char *data, quint32 size, QString *errorString);
+    bool writeToFile(const QString &outputFileName, QString *errorString) const;
+
+private:
+    QMap<QByteArray, QByteArray> m_units;
+};
+
 struct TypeReference
 {
     TypeReference(const Location &loc)
@@ -1481,6 +1560,10 @@ struct CompilationUnit final : public QQmlRefCounted<CompilationUnit>
 
     std::unique_ptr<CompilationUnitMapper> backingFile;
 
+    // Indices of the functions recorded in the JitProfile of the cache file, sorted.
+    QList<quint32> jitProfile;
+    QString localCachePath; // Set if backingFile is the file saveToDisk() writes
+
     int m_totalBindingsCount = 0; // Number of bindings used in this type
     int m_totalParserStatusCount = 0; // Number of instantiated types that are QQmlParserStatus subclasses
     int m_totalObjectCount = 0; // Number of objects explicitly instantiated
@@ -1618,6 +1701,7 @@ public:
     Q_QML_EXPORT bool loadFromDisk(
             const QUrl &url, const QDateTime &sourceTimeStamp, QString *errorString);
     Q_QML_EXPORT bool saveToDisk(const QUrl &unitUrl, QString *errorString);
+    Q_QML_EXPORT bool saveJitProfile(const QList<quint32> &functionIndices, QString *errorString);
 
     int importCount() const { return qmlData->nImports; }
     const CompiledData::Import *importAt(int index) const { return qmlData->importAt(index); }
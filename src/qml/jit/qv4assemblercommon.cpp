@@ -101,12 +101,13 @@ static void printDisassembledOutputWithCalls(QByteArray processedOutput,
 JIT::PlatformAssemblerCommon::~PlatformAssemblerCommon()
 {}
 
-void PlatformAssemblerCommon::link(Function *function, const char *jitKind)
+void PlatformAssemblerCommon::finalizeCode(QV4::ExecutableAllocator *allocator,
+                                           Function *function, const char *jitKind)
 {
     for (const auto &jumpTarget : jumpsToLink)
         jumpTarget.jump.linkTo(labelForOffset[jumpTarget.offset], this);
 
-    JSC::JSGlobalData dummy(function->internalClass->engine->executableAllocator);
+    JSC::JSGlobalData dummy(allocator);
     JSC::LinkBuffer<MacroAssembler> linkBuffer(dummy, this, nullptr);
 
     for (const auto &ehTarget : ehTargets) {
@@ -114,8 +115,6 @@ void PlatformAssemblerCommon::link(Function *function, const char *jitKind)
         linkBuffer.patch(ehTarget.label, linkBuffer.locationOf(targetLabel));
     }
 
-    JSC::MacroAssemblerCodeRef codeRef;
-
     static const bool showCode = lcAsm().isDebugEnabled();
     if (showCode) {
         QBuffer buf;
@@ -125,21 +124,27 @@ void PlatformAssemblerCommon::link(Function *function, const char *jitKind)
         // We use debugAddress here because it's actually for debugging and hidden behind an
         // environment variable.
         const QByteArray name = Function::prettyName(function, linkBuffer.debugAddress()).toUtf8();
-        codeRef = linkBuffer.finalizeCodeWithDisassembly(jitKind, name.constData());
+        finalizedCode = linkBuffer.finalizeCodeWithDisassembly(jitKind, name.constData());
 
         WTF::setDataFile(stderr);
         printDisassembledOutputWithCalls(buf.data(), functions);
     } else {
-        codeRef = linkBuffer.finalizeCodeWithoutDisassembly();
+        finalizedCode = linkBuffer.finalizeCodeWithoutDisassembly();
     }
+}
 
-    function->codeRef = new JSC::MacroAssemblerCodeRef(codeRef);
+void PlatformAssemblerCommon::installCode(Function *function)
+{
+    function->codeRef = new JSC::MacroAssemblerCodeRef(finalizedCode);
     function->jittedCode = reinterpret_cast<Function::JittedCode>(function->codeRef->code().executableAddress());
 
-    generateFunctionTable(function, &codeRef);
+    generateFunctionTable(function, &finalizedCode);
 
-    if (Q_UNLIKELY(!linkBuffer.makeExecutable()))
+    JSC::ExecutableMemoryHandle *memory = finalizedCode.executableMemory();
+    if (Q_UNLIKELY(!JSC::ExecutableAllocator::makeExecutable(memory->memoryStart(),
+                                                             memory->memorySize()))) {
         function->jittedCode = nullptr; // The function is not executable, but the coderef exists.
+    }
 }
 
 void PlatformAssemblerCommon::prepareCallWithArgCount(int argc)
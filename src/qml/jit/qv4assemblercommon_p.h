@@ -141,6 +141,7 @@ public:
     static const RegisterID StackPointerRegister  = RegisterID::esp;
     static const RegisterID FramePointerRegister  = RegisterID::ebp;
     static const FPRegisterID FPScratchRegister   = FPRegisterID::xmm1;
+    static const FPRegisterID FPScratchRegister2  = FPRegisterID::xmm2;
 
     static const RegisterID Arg0Reg = RegisterID::ecx;
     static const RegisterID Arg1Reg = RegisterID::edx;
@@ -321,6 +322,7 @@ public:
     static const RegisterID StackPointerRegister  = JSC::ARM64Registers::sp;
     static const RegisterID FramePointerRegister  = JSC::ARM64Registers::fp;
     static const FPRegisterID FPScratchRegister   = JSC::ARM64Registers::q1;
+    static const FPRegisterID FPScratchRegister2  = JSC::ARM64Registers::q2;
 
     static const RegisterID Arg0Reg = JSC::ARM64Registers::x0;
     static const RegisterID Arg1Reg = JSC::ARM64Registers::x1;
@@ -657,7 +659,11 @@ public:
         ehTargets.push_back({ label, offset });
     }
 
-    void link(Function *function, const char *jitKind);
+    // Linking happens in two steps, so that code can be compiled on a thread other than the one
+    // running the function.
+    void finalizeCode(QV4::ExecutableAllocator *allocator, Function *function,
+                      const char *jitKind);
+    void installCode(Function *function);
 
     Value constant(int idx) const
     { return constantTable[idx]; }
@@ -695,6 +701,7 @@ private:
     QHash<const void *, const char *> functions;
     std::vector<Jump> catchyJumps;
     Label functionExit;
+    JSC::MacroAssemblerCodeRef finalizedCode;
 
 #ifndef QT_NO_DEBUG
     enum { NoCall = -1 };
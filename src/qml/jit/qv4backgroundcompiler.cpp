@@ -0,0 +1,116 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qv4backgroundcompiler_p.h"
+#include "qv4baselinejit_p.h"
+
+#include <private/qv4executablecompilationunit_p.h>
+#include <private/qv4function_p.h>
+
+#include <QtCore/qthread.h>
+
+#include <algorithm>
+
+#if QT_CONFIG(qml_jit) && QT_CONFIG(thread)
+
+QT_BEGIN_NAMESPACE
+
+using namespace QV4;
+using namespace QV4::JIT;
+
+BackgroundCompiler::BackgroundCompiler()
+{
+    m_threadPool.setMaxThreadCount(1);
+}
+
+BackgroundCompiler::~BackgroundCompiler()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_queued.clear();
+    }
+    m_threadPool.waitForDone();
+    m_finished.clear();
+}
+
+void BackgroundCompiler::enqueue(Function *function)
+{
+    Job job { function->executableCompilationUnit(), function,
+              std::make_unique<BaselineJIT>(function) };
+
+    QMutexLocker locker(&m_mutex);
+    m_queued.push_back(std::move(job));
+    if (!m_workerActive) {
+        m_workerActive = true;
+        m_threadPool.start([this]() { run(); });
+    }
+}
+
+void BackgroundCompiler::run()
+{
+    QMutexLocker locker(&m_mutex);
+    while (!m_queued.empty()) {
+        Job job = std::move(m_queued.front());
+        m_queued.pop_front();
+        m_runningUnit = job.unit;
+
+        locker.unlock();
+        job.jit->compile();
+        locker.relock();
+        ++m_statistics.compiled;
+        m_statistics.workerThread = QThread::currentThreadId();
+
+        // The unit may have been cancelled while we were compiling. Then nobody wants the result.
+        if (!m_runningJobCancelled) {
+            m_finished.push_back(std::move(job));
+            m_hasFinishedJobs.storeRelease(true);
+        }
+        m_runningUnit = nullptr;
+        m_runningJobCancelled = false;
+        m_jobDone.wakeAll();
+    }
+    m_workerActive = false;
+}
+
+void BackgroundCompiler::installFinishedJobs()
+{
+    std::vector<Job> finished;
+    {
+        QMutexLocker locker(&m_mutex);
+        finished.swap(m_finished);
+        m_hasFinishedJobs.storeRelease(false);
+    }
+
+    for (Job &job : finished)
+        job.jit->install();
+
+    QMutexLocker locker(&m_mutex);
+    m_statistics.installed += uint(finished.size());
+}
+
+void BackgroundCompiler::cancel(ExecutableCompilationUnit *unit)
+{
+    QMutexLocker locker(&m_mutex);
+    const auto belongsToUnit = [unit](const Job &job) { return job.unit == unit; };
+    m_queued.erase(std::remove_if(m_queued.begin(), m_queued.end(), belongsToUnit),
+                   m_queued.end());
+    m_finished.erase(std::remove_if(m_finished.begin(), m_finished.end(), belongsToUnit),
+                     m_finished.end());
+    m_hasFinishedJobs.storeRelease(!m_finished.empty());
+
+    if (m_runningUnit != unit)
+        return;
+    m_runningJobCancelled = true;
+    while (m_runningUnit == unit)
+        m_jobDone.wait(&m_mutex);
+}
+
+BackgroundCompiler::Statistics BackgroundCompiler::statistics() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_statistics;
+}
+
+QT_END_NAMESPACE
+
+#endif // QT_CONFIG(qml_jit) && QT_CONFIG(thread)
@@ -0,0 +1,100 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QV4BACKGROUNDCOMPILER_P_H
+#define QV4BACKGROUNDCOMPILER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <private/qv4global_p.h>
+#include <QtCore/qatomic.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qthreadpool.h>
+#include <QtCore/qwaitcondition.h>
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#if QT_CONFIG(qml_jit) && QT_CONFIG(thread)
+
+QT_BEGIN_NAMESPACE
+
+namespace QV4 {
+
+struct Function;
+class ExecutableCompilationUnit;
+
+namespace JIT {
+
+class BaselineJIT;
+
+/*
+    Runs the baseline JIT for hot functions on a worker thread, while the interpreter keeps
+    executing them. The BaselineJIT is created on the thread owning the engine, which takes a
+    snapshot of everything the compiler reads that could change at run time. The worker then
+    only generates and links the code. The finished code is installed by the owner thread the
+    next time it enters the interpreter, so that Function::jittedCode only ever changes there.
+*/
+class BackgroundCompiler
+{
+    Q_DISABLE_COPY_MOVE(BackgroundCompiler)
+public:
+    BackgroundCompiler();
+    ~BackgroundCompiler();
+
+    void enqueue(Function *function);
+
+    bool hasFinishedJobs() const { return m_hasFinishedJobs.loadAcquire(); }
+    void installFinishedJobs();
+
+    // Drops all jobs for functions of the given unit. Has to be called before they are deleted.
+    void cancel(ExecutableCompilationUnit *unit);
+
+    struct Statistics
+    {
+        uint compiled = 0;
+        uint installed = 0;
+        Qt::HANDLE workerThread = nullptr; // the thread that compiled the last function
+    };
+    Statistics statistics() const;
+
+private:
+    struct Job
+    {
+        ExecutableCompilationUnit *unit;
+        Function *function;
+        std::unique_ptr<BaselineJIT> jit;
+    };
+
+    void run();
+
+    QThreadPool m_threadPool;
+    mutable QMutex m_mutex;
+    QWaitCondition m_jobDone;
+    std::deque<Job> m_queued;
+    std::vector<Job> m_finished;
+    ExecutableCompilationUnit *m_runningUnit = nullptr;
+    bool m_runningJobCancelled = false;
+    bool m_workerActive = false;
+    QAtomicInteger<bool> m_hasFinishedJobs = false;
+    Statistics m_statistics;
+};
+
+} // namespace JIT
+} // namespace QV4
+
+QT_END_NAMESPACE
+
+#endif // QT_CONFIG(qml_jit) && QT_CONFIG(thread)
+
+#endif // QV4BACKGROUNDCOMPILER_P_H
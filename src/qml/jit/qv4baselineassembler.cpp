@@ -7,7 +7,9 @@
 #include "qv4engine_p.h"
 #include "qv4baselineassembler_p.h"
 #include "qv4assemblercommon_p.h"
+#include <private/qv4arraydata_p.h>
 #include <private/qv4function_p.h>
+#include <private/qv4memberdata_p.h>
 #include <private/qv4runtime_p.h>
 #include <private/qv4stackframe_p.h>
 
@@ -32,6 +34,22 @@ namespace JIT {
 
 const QV4::Value::ValueTypeInternal IntegerTag = QV4::Value::ValueTypeInternal::Integer;
 
+// Offsets of the simple array data fields the inline element access reads.
+constexpr int arrayDataMemberOffset(size_t member)
+{
+    return int(Heap::ArrayDataData::baseOffset + member);
+}
+const int ArrayDataTypeOffset = arrayDataMemberOffset(offsetof(Heap::ArrayDataOffsetStruct, type));
+const int ArrayDataElementKindOffset
+        = arrayDataMemberOffset(offsetof(Heap::ArrayDataOffsetStruct, elementKind));
+const int ArrayDataOffsetOffset = arrayDataMemberOffset(offsetof(Heap::ArrayDataOffsetStruct, offset));
+const int ArrayDataSizeOffset = int(decltype(Heap::ArrayData::values)::offset
+                                    + offsetof(ValueArray<0>, size));
+const int ArrayDataAllocOffset = int(decltype(Heap::ArrayData::values)::offset
+                                     + offsetof(ValueArray<0>, alloc));
+const int ArrayDataValuesOffset = int(decltype(Heap::ArrayData::values)::offset
+                                      + offsetof(ValueArray<0>, values));
+
 static ReturnedValue toNumberHelper(ReturnedValue v)
 {
     return Encode(Value::fromReturnedValue(v).toNumber());
@@ -338,6 +356,174 @@ public:
         return done;
     }
 
+    // src has to hold an integer or a double. Clobbers ScratchRegister2.
+    void numberToDouble(RegisterID src, FPRegisterID dest)
+    {
+        urshift64(src, TrustedImm32(Value::QuickType_Shift), ScratchRegister2);
+        Jump isDouble = branch32(NotEqual, TrustedImm32(Value::QT_Int), ScratchRegister2);
+        convertInt32ToDouble(src, dest);
+        Jump done = jump();
+
+        isDouble.link(this);
+        move(TrustedImm64(Value::EncodeMask), ScratchRegister2);
+        xor64(src, ScratchRegister2);
+        move64ToDouble(ScratchRegister2, dest);
+        done.link(this);
+    }
+
+    // Runs fastPath with the lhs in FPScratchRegister and the accumulator in FPScratchRegister2
+    // if both are numbers. fastPath leaves its result in FPScratchRegister.
+    Jump binopBothNumberPath(Address lhsAddr, std::function<void(void)> fastPath)
+    {
+        JumpList slowPath;
+        move(TrustedImm64(Value::NumberMask), ScratchRegister);
+        and64(AccumulatorRegister, ScratchRegister);
+        move(TrustedImm64(Value::NumberDiscriminator), ScratchRegister2);
+        slowPath.append(branch64(LessThan, ScratchRegister, ScratchRegister2));
+        load64(lhsAddr, ScratchRegister);
+        move(TrustedImm64(Value::NumberMask), ScratchRegister2);
+        and64(ScratchRegister2, ScratchRegister);
+        move(TrustedImm64(Value::NumberDiscriminator), ScratchRegister2);
+        slowPath.append(branch64(LessThan, ScratchRegister, ScratchRegister2));
+
+        // both numbers
+        load64(lhsAddr, ScratchRegister);
+        numberToDouble(ScratchRegister, FPScratchRegister);
+        numberToDouble(AccumulatorRegister, FPScratchRegister2);
+        fastPath();
+
+        // NaN needs its canonical encoding, leave that to the runtime.
+        slowPath.append(branchDouble(DoubleNotEqualOrUnordered,
+                                     FPScratchRegister, FPScratchRegister));
+        encodeDoubleIntoAccumulator(FPScratchRegister);
+        Jump done = jump();
+
+        slowPath.link(this);
+        return done;
+    }
+
+    // Loads the property a Getter0Inline or Getter0MemberData lookup has cached into the
+    // accumulator. call is the state the lookup was in when the JIT was started; anything but
+    // those two is left to the runtime. The lookup is re-checked every time, as it changes its
+    // state (and the meaning of its fields) once it sees a second internal class; the miss jumps
+    // are taken then.
+    bool inlineObjectLookup(const Lookup *lookup, Lookup::Call call, JumpList *miss)
+    {
+        if (call != Lookup::Call::Getter0Inline && call != Lookup::Call::Getter0MemberData)
+            return false;
+
+        move(TrustedImm64(Value::ManagedMask), ScratchRegister);
+        and64(AccumulatorRegister, ScratchRegister);
+        miss->append(branchTest64(NonZero, ScratchRegister));
+        miss->append(branchTest64(Zero, AccumulatorRegister));
+
+        move(TrustedImmPtr(lookup), ScratchRegister2);
+        load16(Address(ScratchRegister2, offsetof(Lookup, call)), ScratchRegister);
+        miss->append(branch32(NotEqual, ScratchRegister, TrustedImm32(int(call))));
+        loadPtr(Address(AccumulatorRegister, offsetof(Heap::Base, internalClass)), ScratchRegister);
+        miss->append(branchPtr(NotEqual, ScratchRegister,
+                               Address(ScratchRegister2, offsetof(Lookup, objectLookup.ic))));
+
+        load32(Address(ScratchRegister2, offsetof(Lookup, objectLookup.offset)), ScratchRegister);
+        if (call == Lookup::Call::Getter0MemberData) {
+            loadPtr(Address(AccumulatorRegister, decltype(Heap::Object::memberData)::offset),
+                    ScratchRegister2);
+            load64(BaseIndex(ScratchRegister2, ScratchRegister, TimesEight,
+                             decltype(Heap::MemberData::values)::offset
+                             + offsetof(ValueArray<0>, values)),
+                   AccumulatorRegister);
+        } else {
+            // the offset already includes the header of the object
+            load64(BaseIndex(AccumulatorRegister, ScratchRegister, TimesEight),
+                   AccumulatorRegister);
+        }
+        return true;
+    }
+
+    // Loads the array data of base into ScratchRegister if base is a plain array with packed
+    // simple array data. ScratchRegister2 is left with the element kind.
+    void loadPackedArrayData(Address base, JumpList *miss)
+    {
+        load64(base, ScratchRegister);
+        urshift64(ScratchRegister, TrustedImm32(Value::Tag_Shift), ScratchRegister2);
+        miss->append(branchTest32(NonZero, ScratchRegister2,
+                                  TrustedImm32(int(Value::ManagedMask >> Value::Tag_Shift))));
+        miss->append(branchTest64(Zero, ScratchRegister));
+
+        loadPtr(Address(ScratchRegister, offsetof(Heap::Base, internalClass)), ScratchRegister2);
+        miss->append(branchPtr(NotEqual, ScratchRegister2,
+                               Address(EngineRegister, offsetof(EngineBase, classes)
+                                       + EngineBase::Class_ArrayObject * sizeof(void *))));
+        loadPtr(Address(ScratchRegister, decltype(Heap::Object::arrayData)::offset),
+                ScratchRegister);
+        miss->append(branchTestPtr(Zero, ScratchRegister));
+
+        load16(Address(ScratchRegister, ArrayDataTypeOffset), ScratchRegister2);
+        miss->append(branch32(NotEqual, ScratchRegister2, TrustedImm32(Heap::ArrayData::Simple)));
+        load16(Address(ScratchRegister, ArrayDataElementKindOffset), ScratchRegister2);
+        miss->append(branch32(Equal, ScratchRegister2, TrustedImm32(Heap::ArrayData::Generic)));
+    }
+
+    // Turns the index in the given register into the slot of the element in the array data in
+    // ScratchRegister, which it leaves in ScratchRegister2. Misses if it's out of bounds.
+    void mapPackedIndex(RegisterID index, JumpList *miss)
+    {
+        miss->append(branch32(AboveOrEqual, index, Address(ScratchRegister, ArrayDataSizeOffset)));
+        zeroExtend32ToPtr(index, ScratchRegister2);
+        add32(Address(ScratchRegister, ArrayDataOffsetOffset), ScratchRegister2);
+        Jump inRange = branch32(Below, ScratchRegister2,
+                                Address(ScratchRegister, ArrayDataAllocOffset));
+        sub32(Address(ScratchRegister, ArrayDataAllocOffset), ScratchRegister2);
+        inRange.link(this);
+    }
+
+    void checkPositiveInt(RegisterID reg, RegisterID scratch, JumpList *miss)
+    {
+        miss->append(branch32(LessThan, reg, TrustedImm32(0)));
+        urshift64(reg, TrustedImm32(Value::Tag_Shift), scratch);
+        miss->append(branch32(NotEqual, scratch, TrustedImm32(int(IntegerTag))));
+    }
+
+    // Loads base[accumulator] if base is a plain array with packed simple array data and the
+    // accumulator is an index below its size. Anything else takes the miss jumps.
+    bool inlineLoadElement(Address base, JumpList *miss)
+    {
+        checkPositiveInt(AccumulatorRegister, ScratchRegister, miss);
+        loadPackedArrayData(base, miss);
+        mapPackedIndex(AccumulatorRegister, miss);
+        load64(BaseIndex(ScratchRegister, ScratchRegister2, TimesEight, ArrayDataValuesOffset),
+               AccumulatorRegister);
+        return true;
+    }
+
+    // Stores the accumulator to base[index] under the same conditions, as long as the value
+    // keeps the element kind. Values that would change it are left to the runtime.
+    bool inlineStoreElement(Address base, Address index, JumpList *miss)
+    {
+        load64(index, ScratchRegister);
+        checkPositiveInt(ScratchRegister, ScratchRegister, miss);
+        loadPackedArrayData(base, miss);
+
+        Jump isPackedDouble = branch32(Equal, ScratchRegister2,
+                                       TrustedImm32(Heap::ArrayData::PackedDouble));
+        urshift64(AccumulatorRegister, TrustedImm32(Value::Tag_Shift), ScratchRegister2);
+        miss->append(branch32(NotEqual, ScratchRegister2, TrustedImm32(int(IntegerTag))));
+        Jump valueFits = jump();
+        isPackedDouble.link(this);
+        move(TrustedImm64(Value::NumberMask), ScratchRegister2);
+        and64(AccumulatorRegister, ScratchRegister2);
+        miss->append(branch64(Below, ScratchRegister2,
+                              TrustedImm64(Value::NumberDiscriminator)));
+        valueFits.link(this);
+
+        load64(index, ScratchRegister2);
+        mapPackedIndex(ScratchRegister2, miss);
+        // numbers are not managed, no write barrier required here
+        store64(AccumulatorRegister,
+                BaseIndex(ScratchRegister, ScratchRegister2, TimesEight, ArrayDataValuesOffset));
+        return true;
+    }
+
     void callWithAccumulatorByValueAsFirstArgument(std::function<void()> doCall)
     {
         passAsArg(AccumulatorRegister, 0);
@@ -768,6 +954,38 @@ public:
         return done;
     }
 
+    Jump binopBothNumberPath(Address lhsAddr, std::function<void(void)> fastPath)
+    {
+        // There are not enough scratch registers to unpack two doubles here. Leave them to the
+        // runtime.
+        Q_UNUSED(lhsAddr);
+        Q_UNUSED(fastPath);
+        return Jump();
+    }
+
+    bool inlineObjectLookup(const Lookup *lookup, Lookup::Call call, JumpList *miss)
+    {
+        Q_UNUSED(lookup);
+        Q_UNUSED(call);
+        Q_UNUSED(miss);
+        return false;
+    }
+
+    bool inlineLoadElement(Address base, JumpList *miss)
+    {
+        Q_UNUSED(base);
+        Q_UNUSED(miss);
+        return false;
+    }
+
+    bool inlineStoreElement(Address base, Address index, JumpList *miss)
+    {
+        Q_UNUSED(base);
+        Q_UNUSED(index);
+        Q_UNUSED(miss);
+        return false;
+    }
+
     void callWithAccumulatorByValueAsFirstArgument(std::function<void()> doCall)
     {
         if (ArgInRegCount < 2) {
@@ -821,9 +1039,14 @@ void BaselineAssembler::generateEpilogue()
     pasm()->generateCatchTrampoline();
 }
 
-void BaselineAssembler::link(Function *function)
+void BaselineAssembler::finalize(ExecutableAllocator *allocator, Function *function)
+{
+    pasm()->finalizeCode(allocator, function, "BaselineJIT");
+}
+
+void BaselineAssembler::install(Function *function)
 {
-    pasm()->link(function, "BaselineJIT");
+    pasm()->installCode(function);
 }
 
 void BaselineAssembler::addLabel(int offset)
@@ -831,6 +1054,26 @@ void BaselineAssembler::addLabel(int offset)
     pasm()->addLabelForOffset(offset);
 }
 
+void BaselineAssembler::generateLoopEntries(const QSet<int> &labels)
+{
+    // Fresh frames start at 0. Any other instruction pointer was set by the interpreter when
+    // switching over in the middle of a loop, and is a jump target.
+    Address ipAddr(PlatformAssembler::CppStackFrameRegister,
+                   offsetof(JSTypesStackFrame, instructionPointer));
+    pasm()->load32(ipAddr, PlatformAssembler::ScratchRegister);
+    auto freshFrame = pasm()->branch32(PlatformAssembler::Equal, PlatformAssembler::ScratchRegister,
+                                       TrustedImm32(0));
+    for (int offset : labels) {
+        if (offset == 0)
+            continue;
+        pasm()->addJumpToOffset(pasm()->branch32(PlatformAssembler::Equal,
+                                                 PlatformAssembler::ScratchRegister,
+                                                 TrustedImm32(offset)),
+                                offset);
+    }
+    freshFrame.link(pasm());
+}
+
 void BaselineAssembler::loadConst(int constIndex)
 {
     //###
@@ -924,6 +1167,58 @@ void BaselineAssembler::loadImport(int index)
     pasm()->loadAccumulator(Address(PlatformAssembler::ScratchRegister));
 }
 
+void BaselineAssembler::getLookup(const Lookup *lookup, Lookup::Call feedback,
+                                  std::function<void()> genericLookup)
+{
+    PlatformAssembler::JumpList miss;
+    if (!pasm()->inlineObjectLookup(lookup, feedback, &miss)) {
+        genericLookup();
+        return;
+    }
+    auto done = pasm()->jump();
+
+    // slow path:
+    miss.link(pasm());
+    genericLookup();
+
+    // done.
+    done.link(pasm());
+}
+
+void BaselineAssembler::loadElement(int base, std::function<void()> genericLoad)
+{
+    PlatformAssembler::JumpList miss;
+    if (!pasm()->inlineLoadElement(regAddr(base), &miss)) {
+        genericLoad();
+        return;
+    }
+    auto done = pasm()->jump();
+
+    // slow path:
+    miss.link(pasm());
+    genericLoad();
+
+    // done.
+    done.link(pasm());
+}
+
+void BaselineAssembler::storeElement(int base, int index, std::function<void()> genericStore)
+{
+    PlatformAssembler::JumpList miss;
+    if (!pasm()->inlineStoreElement(regAddr(base), regAddr(index), &miss)) {
+        genericStore();
+        return;
+    }
+    auto done = pasm()->jump();
+
+    // slow path:
+    miss.link(pasm());
+    genericStore();
+
+    // done.
+    done.link(pasm());
+}
+
 void BaselineAssembler::toNumber()
 {
     pasm()->toNumber();
@@ -1028,6 +1323,9 @@ void BaselineAssembler::add(int lhs)
                                   PlatformAssembler::ScratchRegister);
         return overflowed;
     });
+    auto doubleDone = pasm()->binopBothNumberPath(regAddr(lhs), [this](){
+        pasm()->addDouble(PlatformAssembler::FPScratchRegister2, PlatformAssembler::FPScratchRegister);
+    });
 
     // slow path:
     saveAccumulatorInFrame();
@@ -1040,6 +1338,8 @@ void BaselineAssembler::add(int lhs)
 
     // done.
     done.link(pasm());
+    if (doubleDone.isSet())
+        doubleDone.link(pasm());
 }
 
 void BaselineAssembler::bitAnd(int lhs)
@@ -1181,6 +1481,9 @@ void BaselineAssembler::mul(int lhs)
                                   PlatformAssembler::ScratchRegister);
         return overflowed;
     });
+    auto doubleDone = pasm()->binopBothNumberPath(regAddr(lhs), [this](){
+        pasm()->mulDouble(PlatformAssembler::FPScratchRegister2, PlatformAssembler::FPScratchRegister);
+    });
 
     // slow path:
     saveAccumulatorInFrame();
@@ -1192,6 +1495,8 @@ void BaselineAssembler::mul(int lhs)
 
     // done.
     done.link(pasm());
+    if (doubleDone.isSet())
+        doubleDone.link(pasm());
 }
 
 void BaselineAssembler::div(int lhs)
@@ -1224,6 +1529,9 @@ void BaselineAssembler::sub(int lhs)
                                   PlatformAssembler::ScratchRegister);
         return overflowed;
     });
+    auto doubleDone = pasm()->binopBothNumberPath(regAddr(lhs), [this](){
+        pasm()->subDouble(PlatformAssembler::FPScratchRegister2, PlatformAssembler::FPScratchRegister);
+    });
 
     // slow path:
     saveAccumulatorInFrame();
@@ -1235,6 +1543,8 @@ void BaselineAssembler::sub(int lhs)
 
     // done.
     done.link(pasm());
+    if (doubleDone.isSet())
+        doubleDone.link(pasm());
 }
 
 void BaselineAssembler::cmpeqNull()
@@ -17,7 +17,11 @@
 
 #include <private/qv4global_p.h>
 #include <private/qv4function_p.h>
+#include <private/qv4lookup_p.h>
 #include <QHash>
+#include <QSet>
+
+#include <functional>
 
 #if QT_CONFIG(qml_jit)
 
@@ -40,8 +44,10 @@ public:
     // codegen infrastructure
     void generatePrologue();
     void generateEpilogue();
-    void link(Function *function);
+    void finalize(ExecutableAllocator *allocator, Function *function);
+    void install(Function *function);
     void addLabel(int offset);
+    void generateLoopEntries(const QSet<int> &labels);
 
     // loads/stores/moves
     void loadConst(int constIndex);
@@ -56,6 +62,14 @@ public:
     void storeHeapObject(int reg);
     void loadImport(int index);
 
+    // property lookups
+    void getLookup(const Lookup *lookup, Lookup::Call feedback,
+                   std::function<void()> genericLookup);
+
+    // element access
+    void loadElement(int base, std::function<void()> genericLoad);
+    void storeElement(int base, int index, std::function<void()> genericStore);
+
     // numeric ops
     void unot();
     void toNumber();
@@ -3,6 +3,7 @@
 
 #include "qv4baselinejit_p.h"
 #include "qv4baselineassembler_p.h"
+#include <private/qv4engine_p.h>
 #include <private/qv4lookup_p.h>
 #include <private/qv4generatorobject_p.h>
 
@@ -15,13 +16,28 @@ using namespace QV4::Moth;
 
 BaselineJIT::BaselineJIT(Function *function)
     : function(function)
+      , allocator(function->internalClass->engine->executableAllocator)
       , as(new BaselineAssembler(&(function->compilationUnit->constants->asValue<Value>())))
-{}
+{
+    // The lookups keep changing while the function runs. Take a consistent copy of their states
+    // in case we are compiled on another thread.
+    const ExecutableCompilationUnit *unit = function->executableCompilationUnit();
+    const uint lookupTableSize = unit->unitData()->lookupTableSize;
+    lookupFeedback.reserve(lookupTableSize);
+    for (uint i = 0; i < lookupTableSize; ++i)
+        lookupFeedback.push_back(unit->runtimeLookups[i].call);
+}
 
 BaselineJIT::~BaselineJIT()
 {}
 
 void BaselineJIT::generate()
+{
+    compile();
+    install();
+}
+
+void BaselineJIT::compile()
 {
 //    qDebug()<<"jitting" << function->name()->toQString();
     const char *code = function->codeData;
@@ -33,13 +49,20 @@ void BaselineJIT::generate()
     as->generatePrologue();
     // Make sure the ACC register is initialized and not clobbered by the caller.
     as->loadAccumulatorFromFrame();
+    // Frames handed over by the interpreter in the middle of a loop continue at a jump target.
+    as->generateLoopEntries(labels);
     decode(code, len);
     as->generateEpilogue();
 
-    as->link(function);
+    as->finalize(allocator, function);
 //    qDebug()<<"done";
 }
 
+void BaselineJIT::install()
+{
+    as->install(function);
+}
+
 #define STORE_IP() as->storeInstructionPointer(nextInstructionOffset())
 #define STORE_ACC() as->saveAccumulatorInFrame()
 #define LOAD_ACC() as->loadAccumulatorFromFrame()
@@ -216,26 +239,30 @@ void BaselineJIT::generate_StoreNameStrict(int name)
 
 void BaselineJIT::generate_LoadElement(int base)
 {
-    STORE_IP();
-    STORE_ACC();
-    as->prepareCallWithArgCount(3);
-    as->passAccumulatorAsArg(2);
-    as->passJSSlotAsArg(base, 1);
-    as->passEngineAsArg(0);
-    BASELINEJIT_GENERATE_RUNTIME_CALL(LoadElement, CallResultDestination::InAccumulator);
+    as->loadElement(base, [this, base]() {
+        STORE_IP();
+        STORE_ACC();
+        as->prepareCallWithArgCount(3);
+        as->passAccumulatorAsArg(2);
+        as->passJSSlotAsArg(base, 1);
+        as->passEngineAsArg(0);
+        BASELINEJIT_GENERATE_RUNTIME_CALL(LoadElement, CallResultDestination::InAccumulator);
+    });
 }
 
 void BaselineJIT::generate_StoreElement(int base, int index)
 {
-    STORE_IP();
-    STORE_ACC();
-    as->prepareCallWithArgCount(4);
-    as->passAccumulatorAsArg(3);
-    as->passJSSlotAsArg(index, 2);
-    as->passJSSlotAsArg(base, 1);
-    as->passEngineAsArg(0);
-    BASELINEJIT_GENERATE_RUNTIME_CALL(StoreElement, CallResultDestination::Ignore);
-    LOAD_ACC();
+    as->storeElement(base, index, [this, base, index]() {
+        STORE_IP();
+        STORE_ACC();
+        as->prepareCallWithArgCount(4);
+        as->passAccumulatorAsArg(3);
+        as->passJSSlotAsArg(index, 2);
+        as->passJSSlotAsArg(base, 1);
+        as->passEngineAsArg(0);
+        BASELINEJIT_GENERATE_RUNTIME_CALL(StoreElement, CallResultDestination::Ignore);
+        LOAD_ACC();
+    });
 }
 
 void BaselineJIT::generate_LoadProperty(int name)
@@ -258,14 +285,19 @@ void BaselineJIT::generate_LoadOptionalProperty(int name, int offset)
 
 void BaselineJIT::generate_GetLookup(int index)
 {
-    STORE_IP();
-    STORE_ACC();
-    as->prepareCallWithArgCount(4);
-    as->passInt32AsArg(index, 3);
-    as->passAccumulatorAsArg(2);
-    as->passFunctionAsArg(1);
-    as->passEngineAsArg(0);
-    BASELINEJIT_GENERATE_RUNTIME_CALL(GetLookup, CallResultDestination::InAccumulator);
+    // The interpreter has already run this function a few times. Lookups that have only seen
+    // one internal class so far are inlined, with the runtime call as fallback.
+    const Lookup *lookup = function->executableCompilationUnit()->runtimeLookups + index;
+    as->getLookup(lookup, lookupFeedback[index], [this, index]() {
+        STORE_IP();
+        STORE_ACC();
+        as->prepareCallWithArgCount(4);
+        as->passInt32AsArg(index, 3);
+        as->passAccumulatorAsArg(2);
+        as->passFunctionAsArg(1);
+        as->passEngineAsArg(0);
+        BASELINEJIT_GENERATE_RUNTIME_CALL(GetLookup, CallResultDestination::InAccumulator);
+    });
 }
 
 void BaselineJIT::generate_GetOptionalLookup(int index, int offset)
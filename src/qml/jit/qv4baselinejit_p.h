@@ -19,8 +19,11 @@
 #include <private/qv4function_p.h>
 #include <private/qv4instr_moth_p.h>
 #include <private/qv4bytecodehandler_p.h>
+#include <private/qv4lookup_p.h>
 #include <QtCore/qset.h>
 
+#include <vector>
+
 #if QT_CONFIG(qml_jit)
 
 QT_BEGIN_NAMESPACE
@@ -38,6 +41,11 @@ public:
 
     Q_AUTOTEST_EXPORT void generate();
 
+    // generate(), split in two. compile() can run on any thread, while the function keeps
+    // running in the interpreter. install() has to run on the thread that owns the function.
+    void compile();
+    void install();
+
     void generate_Ret() override;
     void generate_Debug() override;
     void generate_LoadConst(int index) override;
@@ -178,8 +186,10 @@ public:
 
 private:
     QV4::Function *function;
+    QV4::ExecutableAllocator *allocator;
     QScopedPointer<BaselineAssembler> as;
     QSet<int> labels;
+    std::vector<Lookup::Call> lookupFeedback;
 };
 
 } // namespace JIT
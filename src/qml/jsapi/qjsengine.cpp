@@ -20,6 +20,7 @@
 #include <private/qv4stackframe_p.h>
 #include <private/qv4module_p.h>
 #include <private/qv4symbol_p.h>
+#include <private/qv4jsonobject_p.h>
 
 #include <QtCore/qdatetime.h>
 #include <QtCore/qmetaobject.h>
@@ -398,6 +399,57 @@ QJSEngine::~QJSEngine()
 void QJSEngine::collectGarbage()
 {
     m_v4Engine->memoryManager->runFullGC();
+    // only does something if QV4_GC_COMPACT is set and no JavaScript is running
+    m_v4Engine->memoryManager->compact();
+}
+
+/*!
+    \since 6.10
+
+    Runs the garbage collector and writes a snapshot of the JavaScript heap to \a device.
+
+    The snapshot uses the \c .heapsnapshot format of the Chrome DevTools, which can be loaded
+    into their Memory panel to inspect each object with its internal class, its self and
+    retained size, and the paths that keep it alive. Objects retained through the engine
+    itself, the JavaScript stack, persistent values (for example those held by bindings) and
+    QObjects that are kept alive by their ownership show up under separate roots.
+
+    Returns \c false if the garbage collector could not complete because the engine is
+    currently in a critical section, or if writing to \a device failed.
+
+    \sa collectGarbage()
+ */
+bool QJSEngine::writeHeapSnapshot(QIODevice *device)
+{
+    return m_v4Engine->memoryManager->writeHeapSnapshot(device);
+}
+
+/*!
+    \since 6.10
+
+    Serializes \a value to JSON the same way as \c{JSON.stringify()} and writes the result to
+    \a device, encoded as UTF-8. If \a indent is greater than zero, nested members are put on
+    lines of their own, indented by that many spaces per level (up to 10).
+
+    The output is written in chunks while it is being produced. Large object graphs can
+    therefore be persisted without holding the complete JSON text in memory.
+
+    Returns \c false if \a value has no JSON representation, if an exception is thrown while
+    serializing it, for example because it contains a cycle, or if writing to \a device failed.
+    Some output may already have been written to \a device in the latter two cases.
+ */
+bool QJSEngine::writeJson(const QJSValue &value, QIODevice *device, int indent)
+{
+    QV4::ExecutionEngine *otherEngine = QJSValuePrivate::engine(&value);
+    if (otherEngine && otherEngine != m_v4Engine) {
+        qWarning("QJSEngine: Trying to write a value from a different engine as JSON");
+        return false;
+    }
+
+    QV4::Scope scope(m_v4Engine);
+    QV4::ScopedValue v(scope, QJSValuePrivate::convertToReturnedValue(m_v4Engine, value));
+    return QV4::JsonObject::stringify(m_v4Engine, v, QString(qBound(0, indent, 10), u' '),
+                                      device);
 }
 
 /*!
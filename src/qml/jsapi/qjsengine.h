@@ -21,6 +21,7 @@ template <typename T>
 inline T qjsvalue_cast(const QJSValue &);
 
 class QJSEnginePrivate;
+class QIODevice;
 class Q_QML_EXPORT QJSEngine
     : public QObject
 {
@@ -277,6 +278,8 @@ public:
     }
 
     void collectGarbage();
+    bool writeHeapSnapshot(QIODevice *device);
+    bool writeJson(const QJSValue &value, QIODevice *device, int indent = 0);
 
     enum ObjectOwnership { CppOwnership, JavaScriptOwnership };
     static void setObjectOwnership(QObject *, ObjectOwnership);
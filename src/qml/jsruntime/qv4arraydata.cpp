@@ -54,6 +54,18 @@ void Heap::ArrayData::markObjects(Heap::Base *base, MarkStack *stack)
     a->values.mark(stack);
 }
 
+Heap::ArrayData::ElementKind Heap::ArrayData::elementKindOf(const Value *values, uint n)
+{
+    ElementKind kind = PackedInt32;
+    for (uint i = 0; i < n; ++i) {
+        if (values[i].isInteger())
+            continue;
+        if (!values[i].isDouble())
+            return Generic;
+        kind = PackedDouble;
+    }
+    return kind;
+}
 
 void ArrayData::realloc(Object *o, Type newType, uint requested, bool enforceAttributes)
 {
@@ -95,10 +107,17 @@ void ArrayData::realloc(Object *o, Type newType, uint requested, bool enforceAtt
         n->init();
         n->offset = 0;
         n->values.size = d ? d->d()->values.size : 0;
+        if (!n->values.size)
+            n->elementKind = enforceAttributes ? Heap::ArrayData::Generic : Heap::ArrayData::PackedInt32;
+        else if (d->type() == Heap::ArrayData::Simple && !enforceAttributes)
+            n->elementKind = d->d()->elementKind;
+        else
+            n->elementKind = Heap::ArrayData::Generic;
         newData = n;
     } else {
         Heap::SparseArrayData *n = scope.engine->memoryManager->allocManaged<SparseArrayData>(size);
         n->init();
+        n->elementKind = Heap::ArrayData::Generic;
         newData = n;
     }
     newData->setAlloc(alloc);
@@ -192,6 +211,8 @@ bool SimpleArrayData::put(Object *o, uint index, const Value &value)
     Heap::SimpleArrayData *dd = o->d()->arrayData.cast<Heap::SimpleArrayData>();
     Q_ASSERT(index >= dd->values.size || !dd->attrs || !dd->attrs[index].isAccessor());
     // ### honour attributes
+    if (index > dd->values.size)
+        dd->elementKind = Heap::ArrayData::Generic; // leaves a hole
     dd->setData(o->engine(), index, value);
     if (index >= dd->values.size) {
         if (dd->attrs)
@@ -220,6 +241,7 @@ bool SimpleArrayData::del(Object *o, uint index)
 
 void SimpleArrayData::setAttribute(Object *o, uint index, PropertyAttributes attrs)
 {
+    o->arrayData()->elementKind = Heap::ArrayData::Generic;
     o->arrayData()->attrs[index] = attrs;
 }
 
@@ -722,6 +744,10 @@ void ArrayData::sort(ExecutionEngine *engine, Object *thisObject, const Value &c
         // ArrayElementLessThan sorts empty and undefined to the end of the array anyway, but we
         // probably shouldn't rely on the unused slots to be actually undefined or empty.
 
+        // Values beyond len may get swapped into slots outside of the array.
+        if (len < thisArrayData->values.size)
+            thisArrayData->elementKind = Heap::ArrayData::Generic;
+
         const uint gap = startIndex - endIndex;
         const uint allocEnd = thisArrayData->values.alloc - 1;
         for (uint i = 0; i < gap; ++i) {
@@ -56,7 +56,7 @@ namespace Heap {
 
 #define ArrayDataMembers(class, Member) \
     Member(class, NoMark, ushort, type) \
-    Member(class, NoMark, ushort, unused) \
+    Member(class, NoMark, ushort, elementKind) \
     Member(class, NoMark, uint, offset) \
     Member(class, NoMark, PropertyAttributes *, attrs) \
     Member(class, NoMark, SparseArray *, sparse) \
@@ -67,7 +67,21 @@ DECLARE_HEAP_OBJECT(ArrayData, Base) {
 
     enum Type { Simple = 0, Sparse = 1, Custom = 2 };
 
+    // What simple array data is known to hold. While it is packed, every value below values.size
+    // is a number (an integer for PackedInt32): there are no holes, no accessors and no
+    // attributes. Element access can then skip those checks. Any other write turns it generic
+    // for good.
+    enum ElementKind : ushort { Generic = 0, PackedInt32 = 1, PackedDouble = 2 };
+
     bool isSparse() const { return type == Sparse; }
+    bool isPacked() const { return type == Simple && elementKind != Generic; }
+
+    void updateElementKind(Value newVal) {
+        if (Q_LIKELY(elementKind == Generic) || newVal.isInteger())
+            return;
+        elementKind = newVal.isDouble() ? PackedDouble : Generic;
+    }
+    static ElementKind elementKindOf(const Value *values, uint n);
 
     const ArrayVTable *vtable() const { return reinterpret_cast<const ArrayVTable *>(internalClass->vtable); }
 
@@ -88,6 +102,7 @@ DECLARE_HEAP_OBJECT(ArrayData, Base) {
     }
 
     void setArrayData(EngineBase *e, uint index, Value newVal) {
+        updateElementKind(newVal);
         values.set(e, index, newVal);
     }
 
@@ -99,9 +114,19 @@ struct SimpleArrayData : public ArrayData {
     uint mappedIndex(uint index) const { index += offset; if (index >= values.alloc) index -= values.alloc; return index; }
     const Value &data(uint index) const { return values[mappedIndex(index)]; }
     void setData(EngineBase *e, uint index, Value newVal) {
+        updateElementKind(newVal);
         values.set(e, mappedIndex(index), newVal);
     }
 
+    // Numbers are not managed, so packed stores don't need a write barrier.
+    bool canStorePacked(Value newVal) const {
+        return newVal.isInteger() || (elementKind == PackedDouble && newVal.isDouble());
+    }
+    void storePacked(uint index, Value newVal) {
+        Q_ASSERT(isPacked() && index < values.size && canStorePacked(newVal));
+        values.values[mappedIndex(index)] = newVal;
+    }
+
     PropertyAttributes attributes(uint i) const {
         return attrs ? attrs[i] : Attr_Data;
     }
@@ -332,6 +357,7 @@ void ArrayData::setProperty(QV4::EngineBase *e, uint index, const Property *p)
 {
     uint mapped = mappedIndex(index);
     Q_ASSERT(mapped != UINT_MAX);
+    updateElementKind(p->value);
     values.set(e, mapped, p->value);
     if (attributes(index).isAccessor())
         values.set(e, mapped + 1 /*QV4::Object::SetterOffset*/, p->set);
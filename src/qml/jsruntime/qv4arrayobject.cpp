@@ -126,6 +126,20 @@ ReturnedValue ArrayPrototype::method_isArray(const FunctionObject *, const Value
     return Encode(argv->objectValue()->isArray());
 }
 
+// Reads an element the way instance->get() does, but skips the property lookup for plain arrays
+// with packed array data. As callbacks can change the array, this has to be checked per element.
+static inline ReturnedValue getElement(const Object *instance, uint index, bool *exists = nullptr)
+{
+    Heap::Object *o = instance->d();
+    if (o->internalClass->vtable == ArrayObject::staticVTable() && o->arrayData
+            && o->arrayData->isPacked() && index < o->arrayData->values.size) {
+        if (exists)
+            *exists = true;
+        return o->arrayData.cast<Heap::SimpleArrayData>()->data(index).asReturnedValue();
+    }
+    return instance->get(index, exists);
+}
+
 static ScopedObject createObjectFromCtorOrArray(Scope &scope, ScopedFunctionObject ctor, bool useLen, int len)
 {
     ScopedObject a(scope, Value::undefinedValue());
@@ -520,7 +534,7 @@ ReturnedValue ArrayPrototype::method_find(const FunctionObject *b, const Value *
     ScopedValue that(scope, argc > 1 ? argv[1] : Value::undefinedValue());
 
     for (uint k = 0; k < len; ++k) {
-        arguments[0] = instance->get(k);
+        arguments[0] = getElement(instance, k);
         CHECK_EXCEPTION();
 
         arguments[1] = Value::fromDouble(k);
@@ -554,7 +568,7 @@ ReturnedValue ArrayPrototype::method_findIndex(const FunctionObject *b, const Va
     ScopedValue that(scope, argc > 1 ? argv[1] : Value::undefinedValue());
 
     for (uint k = 0; k < len; ++k) {
-        arguments[0] = instance->get(k);
+        arguments[0] = getElement(instance, k);
         CHECK_EXCEPTION();
 
         arguments[1] = Value::fromDouble(k);
@@ -1074,6 +1088,23 @@ ReturnedValue ArrayPrototype::method_includes(const FunctionObject *b, const Val
         }
     }
 
+    if (instance->d()->internalClass->vtable == ArrayObject::staticVTable()
+            && instance->arrayData() && instance->arrayData()->isPacked()
+            && len <= instance->arrayData()->values.size && k < len) {
+        // Nothing in here can run JavaScript, so the array can't change under our feet.
+        Heap::SimpleArrayData *sa = instance->d()->arrayData.cast<Heap::SimpleArrayData>();
+        if (argc < 1 || !argv[0].isNumber())
+            return Encode(false);
+        const double d = argv[0].asDouble();
+        const bool findNaN = qIsNaN(d);
+        for (uint idx = uint(k); idx < len; ++idx) {
+            const double element = sa->data(idx).asDouble();
+            if (element == d || (findNaN && qIsNaN(element)))
+                return Encode(true);
+        }
+        return Encode(false);
+    }
+
     ScopedValue val(scope);
     while (k < len) {
         val = instance->get(k);
@@ -1140,6 +1171,18 @@ ReturnedValue ArrayPrototype::method_indexOf(const FunctionObject *b, const Valu
         Heap::SimpleArrayData *sa = instance->d()->arrayData.cast<Heap::SimpleArrayData>();
         if (len > sa->values.size)
             len = sa->values.size;
+        if (sa->isPacked()) {
+            // Only numbers can be strictly equal to a packed element. This also gets NaN and
+            // -0 right.
+            if (!searchValue->isNumber())
+                return Encode(-1);
+            const double d = searchValue->asDouble();
+            for (uint idx = fromIndex; idx < len; ++idx) {
+                if (sa->data(idx).asDouble() == d)
+                    return Encode(idx);
+            }
+            return Encode(-1);
+        }
         uint idx = fromIndex;
         while (idx < len) {
             value = sa->data(idx);
@@ -1228,7 +1271,7 @@ ReturnedValue ArrayPrototype::method_every(const FunctionObject *b, const Value
     bool ok = true;
     for (uint k = 0; ok && k < len; ++k) {
         bool exists;
-        arguments[0] = instance->get(k, &exists);
+        arguments[0] = getElement(instance, k, &exists);
         if (!exists)
             continue;
 
@@ -1303,7 +1346,7 @@ ReturnedValue ArrayPrototype::method_some(const FunctionObject *b, const Value *
 
     for (uint k = 0; k < len; ++k) {
         bool exists;
-        arguments[0] = instance->get(k, &exists);
+        arguments[0] = getElement(instance, k, &exists);
         if (!exists)
             continue;
 
@@ -1335,7 +1378,7 @@ ReturnedValue ArrayPrototype::method_forEach(const FunctionObject *b, const Valu
 
     for (uint k = 0; k < len; ++k) {
         bool exists;
-        arguments[0] = instance->get(k, &exists);
+        arguments[0] = getElement(instance, k, &exists);
         if (!exists)
             continue;
 
@@ -1373,7 +1416,7 @@ ReturnedValue ArrayPrototype::method_map(const FunctionObject *b, const Value *t
 
     for (uint k = 0; k < len; ++k) {
         bool exists;
-        arguments[0] = instance->get(k, &exists);
+        arguments[0] = getElement(instance, k, &exists);
         if (!exists)
             continue;
 
@@ -1409,7 +1452,7 @@ ReturnedValue ArrayPrototype::method_filter(const FunctionObject *b, const Value
     uint to = 0;
     for (uint k = 0; k < len; ++k) {
         bool exists;
-        arguments[0] = instance->get(k, &exists);
+        arguments[0] = getElement(instance, k, &exists);
         if (!exists)
             continue;
 
@@ -1447,7 +1490,7 @@ ReturnedValue ArrayPrototype::method_reduce(const FunctionObject *b, const Value
     } else {
         bool kPresent = false;
         while (k < len && !kPresent) {
-            v = instance->get(k, &kPresent);
+            v = getElement(instance, k, &kPresent);
             if (kPresent)
                 acc = v;
             ++k;
@@ -1460,7 +1503,7 @@ ReturnedValue ArrayPrototype::method_reduce(const FunctionObject *b, const Value
 
     while (k < len) {
         bool kPresent;
-        v = instance->get(k, &kPresent);
+        v = getElement(instance, k, &kPresent);
         if (kPresent) {
             arguments[0] = acc;
             arguments[1] = v;
@@ -1501,7 +1544,7 @@ ReturnedValue ArrayPrototype::method_reduceRight(const FunctionObject *b, const
     } else {
         bool kPresent = false;
         while (k > 0 && !kPresent) {
-            v = instance->get(k - 1, &kPresent);
+            v = getElement(instance, k - 1, &kPresent);
             if (kPresent)
                 acc = v;
             --k;
@@ -1514,7 +1557,7 @@ ReturnedValue ArrayPrototype::method_reduceRight(const FunctionObject *b, const
 
     while (k > 0) {
         bool kPresent;
-        v = instance->get(k - 1, &kPresent);
+        v = getElement(instance, k - 1, &kPresent);
         if (kPresent) {
             arguments[0] = acc;
             arguments[1] = v;
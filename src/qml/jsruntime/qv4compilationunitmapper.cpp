@@ -9,6 +9,8 @@
 #include <QtCore/qmutex.h>
 #include <QtCore/qhash.h>
 
+#include <memory>
+
 QT_BEGIN_NAMESPACE
 
 using namespace QV4;
@@ -46,6 +48,68 @@ private:
 QHash<QString, CompilationUnitMapper> StaticUnitCache::s_staticUnits;
 QMutex StaticUnitCache::s_mutex;
 
+class UnitPackCache
+{
+public:
+    UnitPackCache() : m_lock(&s_mutex) {}
+
+    // Each directory is only checked once for a pack file, whether it has one or not.
+    const CompiledData::UnitPack *get(const QString &directory, QString *errorString)
+    {
+        const auto it = s_packs.constFind(directory);
+        if (it != s_packs.constEnd()) {
+            if (!*it)
+                *errorString = QStringLiteral("No valid pack file in the directory");
+            return *it;
+        }
+
+        const CompiledData::UnitPack *pack = map(directory, errorString);
+        s_packs.insert(directory, pack);
+        return pack;
+    }
+
+private:
+    static const CompiledData::UnitPack *map(const QString &directory, QString *errorString)
+    {
+        auto file = std::make_unique<QFile>(
+                directory + QLatin1String(CompiledData::unit_pack_file_name));
+        if (!file->open(QIODevice::ReadOnly)) {
+            *errorString = file->errorString();
+            return nullptr;
+        }
+
+        const qint64 size = file->size();
+        if (size < qint64(sizeof(CompiledData::UnitPack))) {
+            *errorString = QStringLiteral("File too small for the header fields");
+            return nullptr;
+        }
+
+        uchar *data = file->map(0, size);
+        if (!data) {
+            *errorString = file->errorString();
+            return nullptr;
+        }
+
+        const auto *pack = reinterpret_cast<const CompiledData::UnitPack *>(data);
+        if (!pack->verify(size, errorString)) {
+            file->unmap(data);
+            return nullptr;
+        }
+
+        // Like static units, the units of a pack are never unmapped. Keep the file open for good.
+        file.release();
+        return pack;
+    }
+
+    QMutexLocker<QMutex> m_lock;
+
+    static QMutex s_mutex;
+    static QHash<QString, const CompiledData::UnitPack *> s_packs;
+};
+
+QHash<QString, const CompiledData::UnitPack *> UnitPackCache::s_packs;
+QMutex UnitPackCache::s_mutex;
+
 CompiledData::Unit *CompilationUnitMapper::get(
         const QString &cacheFilePath, const QDateTime &sourceTimeStamp, QString *errorString)
 {
@@ -72,6 +136,45 @@ CompiledData::Unit *CompilationUnitMapper::get(
     }
 }
 
+CompiledData::Unit *CompilationUnitMapper::getFromPack(
+        const QString &sourceFilePath, const QDateTime &sourceTimeStamp, QString *errorString)
+{
+    const qsizetype nameStart = sourceFilePath.lastIndexOf(QLatin1Char('/')) + 1;
+    const CompiledData::UnitPack *pack
+            = UnitPackCache().get(sourceFilePath.left(nameStart), errorString);
+    if (!pack)
+        return nullptr;
+
+    const CompiledData::Unit *unit
+            = pack->unit(QStringView(sourceFilePath).sliced(nameStart).toUtf8());
+    if (!unit) {
+        *errorString = QStringLiteral("File is not contained in the pack file");
+        return nullptr;
+    }
+
+    if (!unit->verifyHeader(sourceTimeStamp, errorString))
+        return nullptr;
+
+    if (!(unit->flags & CompiledData::Unit::StaticData)) {
+        *errorString = QStringLiteral("Unit in the pack file is not static");
+        return nullptr;
+    }
+
+    close();
+    dataPtr = const_cast<CompiledData::Unit *>(unit);
+    length = unit->unitSize;
+    return const_cast<CompiledData::Unit *>(unit);
+}
+
+QByteArrayView CompilationUnitMapper::trailingData() const
+{
+    if (!dataPtr)
+        return QByteArrayView();
+    const quint32 unitSize = reinterpret_cast<const CompiledData::Unit *>(dataPtr)->unitSize;
+    Q_ASSERT(length >= unitSize);
+    return QByteArrayView(static_cast<const char *>(dataPtr) + unitSize, qsizetype(length - unitSize));
+}
+
 void CompilationUnitMapper::invalidate(const QString &cacheFilePath)
 {
     StaticUnitCache cache;
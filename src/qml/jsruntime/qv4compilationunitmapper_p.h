@@ -17,6 +17,7 @@
 
 #include <private/qv4global_p.h>
 #include <QFile>
+#include <QtCore/qbytearrayview.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -33,14 +34,20 @@ public:
             const QString &cacheFilePath, const QDateTime &sourceTimeStamp, QString *errorString);
     static void invalidate(const QString &cacheFilePath);
 
+    // Looks the unit up in the pack file in the directory of the source file. Pack files are
+    // mapped once per process and never unmapped.
+    CompiledData::Unit *getFromPack(
+            const QString &sourceFilePath, const QDateTime &sourceTimeStamp, QString *errorString);
+
+    // Whatever the file holds after the unit, such as a CompiledData::JitProfile.
+    QByteArrayView trailingData() const;
+
 private:
     CompiledData::Unit *open(
             const QString &cacheFilePath, const QDateTime &sourceTimeStamp, QString *errorString);
     void close();
 
-#if defined(Q_OS_UNIX)
     size_t length = 0;
-#endif
     void *dataPtr = nullptr;
 };
 
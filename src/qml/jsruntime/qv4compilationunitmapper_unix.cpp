@@ -48,9 +48,9 @@ CompiledData::Unit *CompilationUnitMapper::open(const QString &cacheFileName, co
        later (even before verifying the checksum), potentially causing out-of-bound
        reads
        Also, no need to wait until checksum verification if we know beforehand
-       that the cached unit is bogus
+       that the cached unit is bogus. The unit may be followed by optional sections.
     */
-    if (length != header.unitSize) {
+    if (length < header.unitSize) {
         *errorString = QStringLiteral("Potential file corruption, file too small");
         return nullptr;
     }
@@ -56,17 +56,18 @@ CompiledData::Unit *CompilationUnitMapper::open(const QString &cacheFileName, co
        later (even before verifying the checksum), potentially causing out-of-bound
        reads
        Also, no need to wait until checksum verification if we know beforehand
-       that the cached unit is bogus
+       that the cached unit is bogus. The unit may be followed by optional sections.
     */
     LARGE_INTEGER fileSize;
     if (!GetFileSizeEx(handle, &fileSize)) {
         *errorString = QStringLiteral("Could not determine file size");
         return nullptr;
     }
-    if (header.unitSize != fileSize.QuadPart) {
+    if (header.unitSize > fileSize.QuadPart) {
         *errorString = QStringLiteral("Potential file corruption, file too small");
         return nullptr;
     }
+    length = static_cast<size_t>(fileSize.QuadPart);
 
 
     HANDLE fileMappingHandle = CreateFileMapping(handle, 0, PAGE_READONLY, 0, 0, 0);
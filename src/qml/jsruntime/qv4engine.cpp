@@ -37,6 +37,7 @@
 #include <private/qv4identifiertable_p.h>
 #include <private/qv4iterator_p.h>
 #include <private/qv4jsonobject_p.h>
+#include <private/qv4lookup_p.h>
 #include <private/qv4mapiterator_p.h>
 #include <private/qv4mapobject_p.h>
 #include <private/qv4mathobject_p.h>
@@ -90,6 +91,9 @@
 #if QT_CONFIG(qml_locale)
 #include <private/qqmllocale_p.h>
 #endif
+#if QT_CONFIG(qml_jit) && QT_CONFIG(thread)
+#include <private/qv4backgroundcompiler_p.h>
+#endif
 #if QT_CONFIG(qml_xml_http_request)
 #include <private/qv4domerrors_p.h>
 #include <private/qqmlxmlhttprequest_p.h>
@@ -115,6 +119,7 @@ Q_CONSTINIT static QBasicAtomicInt engineSerial = Q_BASIC_ATOMIC_INITIALIZER(1);
 Q_CONSTINIT static QBasicAtomicInt hasPreview = Q_BASIC_ATOMIC_INITIALIZER(0);
 int ExecutionEngine::s_maxCallDepth = -1;
 int ExecutionEngine::s_jitCallCountThreshold = 3;
+int ExecutionEngine::s_jitBackEdgeThreshold = 1000;
 int ExecutionEngine::s_maxJSStackSize = 4 * 1024 * 1024;
 int ExecutionEngine::s_maxGCStackSize = 2 * 1024 * 1024;
 
@@ -320,8 +325,14 @@ void ExecutionEngine::initializeStaticMembers()
     s_jitCallCountThreshold = qEnvironmentVariableIntValue("QV4_JIT_CALL_THRESHOLD", &ok);
     if (!ok)
         s_jitCallCountThreshold = 3;
-    if (qEnvironmentVariableIsSet("QV4_FORCE_INTERPRETER"))
+    ok = false;
+    s_jitBackEdgeThreshold = qEnvironmentVariableIntValue("QV4_JIT_LOOP_THRESHOLD", &ok);
+    if (!ok)
+        s_jitBackEdgeThreshold = 1000;
+    if (qEnvironmentVariableIsSet("QV4_FORCE_INTERPRETER")) {
         s_jitCallCountThreshold = std::numeric_limits<int>::max();
+        s_jitBackEdgeThreshold = std::numeric_limits<int>::max();
+    }
 
     qMetaTypeId<QJSValue>();
     qMetaTypeId<QList<int> >();
@@ -340,7 +351,6 @@ void ExecutionEngine::initializeStaticMembers()
 
 ExecutionEngine::ExecutionEngine(QJSEngine *jsEngine)
     : executableAllocator(new QV4::ExecutableAllocator)
-    , regExpAllocator(new QV4::ExecutableAllocator)
     , bumperPointerAllocator(new WTF::BumpPointerAllocator)
     , jsStack(new WTF::PageAllocation)
     , gcStack(new WTF::PageAllocation)
@@ -368,6 +378,11 @@ ExecutionEngine::ExecutionEngine(QJSEngine *jsEngine)
         callDepth = 0;
     }
 
+#if QT_CONFIG(qml_jit) && QT_CONFIG(thread)
+    if (m_canAllocateExecutableMemory && qEnvironmentVariableIntValue("QV4_JIT_BACKGROUND"))
+        backgroundCompiler = new JIT::BackgroundCompiler;
+#endif
+
     // We allocate guard pages around our stacks.
     const size_t guardPages = 2 * WTF::pageSize();
 
@@ -856,6 +871,11 @@ ExecutionEngine::ExecutionEngine(QJSEngine *jsEngine)
 
 ExecutionEngine::~ExecutionEngine()
 {
+#if QT_CONFIG(qml_jit) && QT_CONFIG(thread)
+    // Stop compiling before anything the compiler reads goes away.
+    delete backgroundCompiler;
+    backgroundCompiler = nullptr;
+#endif
     qDeleteAll(m_extensionData);
     delete m_multiplyWrappedQObjects;
     m_multiplyWrappedQObjects = nullptr;
@@ -871,7 +891,7 @@ ExecutionEngine::~ExecutionEngine()
 
     delete bumperPointerAllocator;
     delete regExpCache;
-    delete regExpAllocator;
+    delete megamorphicLookupCache;
     delete executableAllocator;
     jsStack->deallocate();
     delete jsStack;
@@ -1001,6 +1021,7 @@ Heap::ArrayObject *ExecutionEngine::newArrayObject(const Value *values, int leng
         // this doesn't require a write barrier, things will be ok, when the new array data gets inserted into
         // the parent object
         memcpy(&d->values.values, values, length*sizeof(Value));
+        d->elementKind = Heap::ArrayData::elementKindOf(values, length);
         a->d()->arrayData.set(this, d);
         a->setArrayLengthUnchecked(length);
     }
@@ -2244,6 +2265,8 @@ static ExecutionEngine::DiskCacheOptions transFormDiskCache(const char *v)
             result |= DiskCache::QmlcWrite;
         else if (option == "qmlc")
             result |= DiskCache::Qmlc;
+        else if (option == "jit-profile")
+            result |= DiskCache::JitProfile;
         else
             qWarning() << "Ignoring unknown option to QML_DISK_CACHE:" << option;
     }
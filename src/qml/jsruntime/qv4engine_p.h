@@ -117,6 +117,9 @@ class Debugger;
 namespace Profiling {
 class Profiler;
 } // namespace Profiling
+namespace JIT {
+class BackgroundCompiler;
+} // namespace JIT
 namespace CompiledData {
 struct CompilationUnit;
 }
@@ -144,6 +147,7 @@ public:
         AotNative   = 1 << 1,
         QmlcRead    = 1 << 2,
         QmlcWrite   = 1 << 3,
+        JitProfile  = 1 << 4, // Not part of Enabled
         Aot         = AotByteCode | AotNative,
         Qmlc        = QmlcRead | QmlcWrite,
         Enabled     = Aot | Qmlc,
@@ -153,7 +157,9 @@ public:
     Q_DECLARE_FLAGS(DiskCacheOptions, DiskCache);
 
     ExecutableAllocator *executableAllocator = nullptr;
-    ExecutableAllocator *regExpAllocator = nullptr;
+#if QT_CONFIG(qml_jit) && QT_CONFIG(thread)
+    JIT::BackgroundCompiler *backgroundCompiler = nullptr; // Set if QV4_JIT_BACKGROUND is enabled
+#endif
 
     WTF::BumpPointerAllocator *bumperPointerAllocator = nullptr; // Used by Yarr Regex engine.
 
@@ -502,6 +508,7 @@ public:
     quint32 m_engineId = 0;
 
     RegExpCache *regExpCache = nullptr;
+    MegamorphicLookupCache *megamorphicLookupCache = nullptr; // Created on first use
 
     // Scarce resources are "exceptionally high cost" QVariant types where allowing the
     // normal JavaScript GC to clean them up is likely to lead to out-of-memory or other
@@ -708,6 +715,21 @@ public:
 #endif
     }
 
+    // Counts a loop iteration run by the interpreter and tells whether the loop is hot enough to
+    // continue in JIT code.
+    template<typename Jittable>
+    bool canJITOnBackEdge(Jittable *jittable) const
+    {
+#if QT_CONFIG(qml_jit)
+        return m_canAllocateExecutableMemory
+                && jittable->isJittable()
+                && ++jittable->interpreterBackEdgeCount >= s_jitBackEdgeThreshold;
+#else
+        Q_UNUSED(jittable);
+        return false;
+#endif
+    }
+
     QV4::ReturnedValue global();
     void initQmlGlobalObject();
     void initializeGlobal();
@@ -788,6 +810,7 @@ public:
 
     static void setMaxCallDepth(int maxCallDepth) { s_maxCallDepth = maxCallDepth; }
     static int maxCallDepth() { return s_maxCallDepth; }
+    static int jitCallCountThreshold() { return s_jitCallCountThreshold; }
 
     template<typename Value>
     static QJSPrimitiveValue createPrimitive(const Value &v)
@@ -850,6 +873,7 @@ private:
 
     static int s_maxCallDepth;
     static int s_jitCallCountThreshold;
+    static int s_jitBackEdgeThreshold;
     static int s_maxJSStackSize;
     static int s_maxGCStackSize;
 
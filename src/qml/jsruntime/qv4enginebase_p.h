@@ -43,7 +43,6 @@ struct Q_QML_EXPORT EngineBase {
 #   error V4 needs either 8bit or 16bit atomics.
 #endif
 
-    quint8 isExecutingInRegExpJIT = false;
     quint8 isInitialized = false;
     quint8 inShutdown = false;
     quint8 isGCOngoing = false; // incremental gc is ongoing (but mutator might be running)
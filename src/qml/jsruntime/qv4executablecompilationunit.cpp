@@ -20,12 +20,18 @@
 #include <private/qqmltypewrapper_p.h>
 #include <private/qv4resolvedtypereference_p.h>
 #include <private/qv4objectiterator_p.h>
+#include <private/qqmlscriptblob_p.h>
+#if QT_CONFIG(qml_jit) && QT_CONFIG(thread)
+#include <private/qv4backgroundcompiler_p.h>
+#endif
 
 #include <QtQml/qqmlpropertymap.h>
 
 #include <QtCore/qfileinfo.h>
 #include <QtCore/qcryptographichash.h>
 
+#include <algorithm>
+
 QT_BEGIN_NAMESPACE
 
 namespace QV4 {
@@ -172,6 +178,13 @@ void ExecutableCompilationUnit::populate()
                                                     advanceAotFunction(i));
     }
 
+    static const bool ignoreJitProfile = qEnvironmentVariableIsSet("QV4_FORCE_INTERPRETER");
+    if (!ignoreJitProfile && (engine->diskCacheOptions() & ExecutionEngine::DiskCache::JitProfile)) {
+        // These functions were hot the last time the unit was used. Compile them on first call.
+        for (quint32 index : std::as_const(m_compilationUnit->jitProfile))
+            runtimeFunctions[index]->interpreterCallCount = ExecutionEngine::jitCallCountThreshold();
+    }
+
     Scope scope(engine);
     Scoped<InternalClass> ic(scope);
 
@@ -241,6 +254,13 @@ Heap::Object *ExecutableCompilationUnit::templateObjectAt(int index) const
 
 void ExecutableCompilationUnit::clear()
 {
+#if QT_CONFIG(qml_jit) && QT_CONFIG(thread)
+    if (engine && engine->backgroundCompiler)
+        engine->backgroundCompiler->cancel(this);
+#endif
+
+    saveJitProfile();
+
     delete [] imports;
     imports = nullptr;
 
@@ -269,6 +289,34 @@ void ExecutableCompilationUnit::clear()
     m_compilationUnit = nullUnit;
 }
 
+void ExecutableCompilationUnit::saveJitProfile()
+{
+    if (!engine || m_compilationUnit->localCachePath.isEmpty()
+            || !(engine->diskCacheOptions() & ExecutionEngine::DiskCache::JitProfile)) {
+        return;
+    }
+
+    const QList<quint32> &oldProfile = m_compilationUnit->jitProfile;
+    QList<quint32> functionIndices = oldProfile;
+    for (quint32 i = 0, end = quint32(runtimeFunctions.size()); i < end; ++i) {
+        if (runtimeFunctions[i]->codeRef
+                && !std::binary_search(oldProfile.cbegin(), oldProfile.cend(), i)) {
+            functionIndices.append(i);
+        }
+    }
+
+    // Don't rewrite the cache file if nothing new got hot.
+    if (functionIndices.size() == oldProfile.size())
+        return;
+
+    std::sort(functionIndices.begin(), functionIndices.end());
+    QString errorString;
+    if (!m_compilationUnit->saveJitProfile(functionIndices, &errorString)) {
+        qCDebug(DBG_DISK_CACHE) << "Error saving JIT profile of" << fileName() << "to disk cache:"
+                                << errorString;
+    }
+}
+
 void ExecutableCompilationUnit::markObjects(QV4::MarkStack *markStack) const
 {
     const CompiledData::Unit *data = m_compilationUnit->data;
@@ -260,6 +260,8 @@ private:
 
     QUrl urlAt(int index) const { return QUrl(stringAt(index)); }
 
+    void saveJitProfile();
+
     Q_NEVER_INLINE IdentifierHash createNamedObjectsPerComponent(int componentObjectIndex);
     const CompiledData::ExportEntry *lookupNameInExportTable(
             const CompiledData::ExportEntry *firstExportEntry, int tableSize,
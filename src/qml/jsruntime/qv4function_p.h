@@ -95,6 +95,8 @@ public:
     // first nArguments names in internalClass are the actual arguments
     QV4::WriteBarrier::Pointer<Heap::InternalClass> internalClass;
     int interpreterCallCount = 0;
+    int interpreterBackEdgeCount = 0;
+    bool jitQueued = false; // Waiting for the background compiler
     quint16 nFormals = 0;
     enum Kind : quint8 { JsUntyped, JsTyped, AotCompiled, Eval };
     Kind kind = JsUntyped;
@@ -4,6 +4,7 @@
 #include "qv4symbol_p.h"
 #include <private/qv4identifierhashdata_p.h>
 #include <private/qprimefornumbits_p.h>
+#include <private/qv4mm_p.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -115,13 +116,21 @@ Heap::String *IdentifierTable::resolveStringEntry(const QString &s, uint hash, u
 {
     uint idx = hash % alloc;
     while (Heap::StringOrSymbol *e = entriesByHash[idx]) {
-        if (e->stringHash == hash && e->toQString() == s)
+        if (e->stringHash == hash && e->textEquals(QStringView(s)))
             return static_cast<Heap::String *>(e);
         ++idx;
         idx %= alloc;
     }
 
-    Heap::String *str = engine->newString(s);
+    // Nobody has seen the text of the new string yet. We can store it in compact form right away.
+    Heap::String *str;
+    if (s.size() && QtPrivate::isLatin1(QStringView(s))) {
+        QByteArray latin1 = s.toLatin1();
+        str = engine->memoryManager->allocWithStringData<String>(
+                latin1.size(), std::move(latin1.data_ptr()));
+    } else {
+        str = engine->newString(s);
+    }
     str->stringHash = hash;
     str->subtype = subtype;
     addEntry(str);
@@ -136,7 +145,7 @@ Heap::Symbol *IdentifierTable::insertSymbol(const QString &s)
     uint hash = String::createHashValue(s.constData(), s.size(), &subtype);
     uint idx = hash % alloc;
     while (Heap::StringOrSymbol *e = entriesByHash[idx]) {
-        if (e->stringHash == hash && e->toQString() == s)
+        if (e->stringHash == hash && e->textEquals(QStringView(s)))
             return static_cast<Heap::Symbol *>(e);
         ++idx;
         idx %= alloc;
@@ -163,7 +172,7 @@ PropertyKey IdentifierTable::asPropertyKeyImpl(const Heap::String *str)
 
     uint idx = hash % alloc;
     while (Heap::StringOrSymbol *e = entriesByHash[idx]) {
-        if (e->stringHash == hash && e->toQString() == str->toQString()) {
+        if (e->stringHash == hash && e->textEquals(str)) {
             str->identifier = e->identifier;
             QV4::WriteBarrier::markCustom(engine, [&](QV4::MarkStack *stack) {
                 e->identifier.asStringOrSymbol()->mark(stack);
@@ -174,6 +183,17 @@ PropertyKey IdentifierTable::asPropertyKeyImpl(const Heap::String *str)
         idx %= alloc;
     }
 
+    // The text of str may be borrowed by its users. Therefore, we don't compact it in place, but
+    // rather intern a compact copy if that's possible.
+    if (Heap::String *compact = str->compactCopy()) {
+        addEntry(compact);
+        QV4::WriteBarrier::markCustom(engine, [&](QV4::MarkStack *stack) {
+            compact->mark(stack);
+        });
+        str->identifier = compact->identifier;
+        return str->identifier;
+    }
+
     addEntry(const_cast<QV4::Heap::String *>(str));
     return str->identifier;
 }
@@ -218,6 +238,7 @@ void IdentifierTable::markObjects(MarkStack *markStack)
 void IdentifierTable::sweep()
 {
     int freed = 0;
+    qsizetype widenedSize = 0;
 
     Heap::StringOrSymbol **newTable = (Heap::StringOrSymbol **)malloc(alloc*sizeof(Heap::String *));
     memset(newTable, 0, alloc*sizeof(Heap::StringOrSymbol *));
@@ -228,6 +249,8 @@ void IdentifierTable::sweep()
             continue;
         if (!e->isMarked()) {
             ++freed;
+            if (e->textIsLatin1)
+                widenedSize += widenedTexts.take(e).size();
             continue;
         }
         uint idx = e->hashValue() % alloc;
@@ -250,6 +273,25 @@ void IdentifierTable::sweep()
     entriesByHash = newTable;
 
     size -= freed;
+    if (widenedSize)
+        engine->memoryManager->changeUnmanagedHeapSizeUsage(-widenedSize * qptrdiff(sizeof(QChar)));
+}
+
+/*!
+    \internal
+    Returns the text of the compact identifier \a str as UTF-16. The widened text is created on
+    first use and kept until \a str is swept, so that repeated calls don't allocate.
+*/
+QStringPrivate IdentifierTable::widenedText(const Heap::StringOrSymbol *str)
+{
+    QString &utf16 = widenedTexts[str];
+    if (utf16.isNull()) {
+        const Heap::StringOrSymbol::Latin1Text &latin1 = str->latin1Text();
+        utf16 = QLatin1StringView(latin1.data(), latin1.size).toString();
+        engine->memoryManager->changeUnmanagedHeapSizeUsage(
+                qptrdiff(utf16.size()) * qptrdiff(sizeof(QChar)));
+    }
+    return utf16.data_ptr();
 }
 
 PropertyKey IdentifierTable::asPropertyKey(const QString &s,
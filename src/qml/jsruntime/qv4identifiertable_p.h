@@ -17,6 +17,7 @@
 #include "qv4identifierhash_p.h"
 #include "qv4string_p.h"
 #include "qv4engine_p.h"
+#include <qhash.h>
 #include <qset.h>
 #include <limits.h>
 
@@ -36,6 +37,10 @@ struct Q_QML_EXPORT IdentifierTable
 
     QSet<IdentifierHashData *> idHashes;
 
+    // UTF-16 forms of compact identifiers, created on first use and dropped when the
+    // identifiers are swept.
+    QHash<const Heap::StringOrSymbol *, QString> widenedTexts;
+
     void addEntry(Heap::StringOrSymbol *str);
 
 public:
@@ -64,6 +69,8 @@ public:
     Heap::String *stringForId(PropertyKey i) const;
     Heap::Symbol *symbolForId(PropertyKey i) const;
 
+    QStringPrivate widenedText(const Heap::StringOrSymbol *str);
+
     void markObjects(MarkStack *markStack);
     void sweep();
 
@@ -10,6 +10,8 @@
 #include "qv4mm_p.h"
 #include <private/qprimefornumbits_p.h>
 
+#include <vector>
+
 QT_BEGIN_NAMESPACE
 
 namespace QV4 {
@@ -46,7 +48,13 @@ void PropertyHash::detach(bool grow, int classSize)
     if (d->refCount == 1 && !grow)
         return;
 
-    PropertyHashData *dd = new PropertyHashData(grow ? d->numBits + 1 : d->numBits);
+    // Size the copy for the class it's made for, rather than for the class it's detached from.
+    // Siblings in the class tree often have far fewer members than the parent's table holds.
+    int numBits = 3;
+    while (qPrimeForNumBits(numBits) <= 2 * (classSize + 1))
+        ++numBits;
+
+    PropertyHashData *dd = new PropertyHashData(numBits);
     for (int i = 0; i < d->alloc; ++i) {
         const Entry &e = d->entries[i];
         if (!e.identifier.isValid() || e.index >= static_cast<unsigned>(classSize))
@@ -81,8 +89,10 @@ SharedInternalClassDataPrivate<PropertyKey>::SharedInternalClassDataPrivate(cons
     : refcount(1),
       engine(other.engine)
 {
-    data.set(engine, MemberData::allocate(engine, other.alloc(), nullptr));
-    memcpy(data, other.data, sizeof(Heap::MemberData) - sizeof(Value) + pos*sizeof(Value));
+    // Like the attributes, only leave some room for growth instead of copying the whole
+    // allocation. Siblings in the class tree only share the members up to pos.
+    data.set(engine, MemberData::allocate(engine, qMin(other.alloc(), pos + 8), nullptr));
+    memcpy(data->values.values, other.data->values.values, pos * sizeof(Value));
     data->values.size = pos + 1;
     data->values.set(engine, pos, Value::fromReturnedValue(value.id()));
 }
@@ -135,6 +145,11 @@ void SharedInternalClassDataPrivate<PropertyKey>::mark(MarkStack *s)
         data->mark(s);
 }
 
+size_t SharedInternalClassDataPrivate<PropertyKey>::memoryUsage() const
+{
+    return data ? sizeof(Heap::MemberData) + (alloc() - 1) * sizeof(Value) : 0;
+}
+
 SharedInternalClassDataPrivate<PropertyAttributes>::SharedInternalClassDataPrivate(
         const SharedInternalClassDataPrivate<PropertyAttributes> &other, uint pos,
         PropertyAttributes value)
@@ -256,7 +271,10 @@ void InternalClass::init(Heap::InternalClass *other)
     parent = other;
     size = other->size;
     numRedundantTransitions = other->numRedundantTransitions;
-    flags = other->flags;
+
+    // Only the class created by dictionary() is a dictionary. Anything derived from it has a
+    // fixed layout again.
+    flags = other->flags & ~Dictionary;
     protoId = engine->newProtoId();
 
     internalClass.set(engine, other->internalClass);
@@ -363,7 +381,28 @@ static Heap::InternalClass *cleanInternalClass(Heap::InternalClass *orig)
             });
             Q_ASSERT(it != parent->d()->transitions.end());
 
-            if (it->flags & InternalClassTransition::StructureChange) {
+            if (it->flags == InternalClassTransition::Dictionary) {
+                // The members a dictionary class has added in place have no transitions of their
+                // own. Treat each of them as an addition. We cannot stop in the middle of a class,
+                // so all of them are examined.
+                Heap::InternalClass *dictionary = child->d();
+                for (uint i = dictionary->size; i > parent->d()->size; --i) {
+                    const PropertyKey id = dictionary->nameMap.at(i - 1);
+                    if (!id.isValid())
+                        continue; // the setter slot of an accessor
+
+                    if (properties.contains(id)) {
+                        if (remainingRedundantTransitions > 0)
+                            --remainingRedundantTransitions;
+                        continue;
+                    }
+
+                    properties.insert(id);
+                    InternalClassTransition addition = { { id }, nullptr,
+                                                         int(dictionary->propertyData.at(i - 1).all()) };
+                    transitions.push_back(addition);
+                }
+            } else if (it->flags & InternalClassTransition::StructureChange) {
                 // A structural change. Each kind of structural change has to be recorded only once.
                 if ((structureChanges & it->flags) != it->flags) {
                     transitions.push_back(*it);
@@ -566,6 +605,25 @@ InternalClass *InternalClass::locked()
 void InternalClass::addMember(QV4::Object *object, PropertyKey id, PropertyAttributes data, InternalClassEntry *entry)
 {
     Heap::InternalClass *oldClass = object->internalClass();
+    if (!data.isEmpty())
+        data.resolve();
+
+    if (!oldClass->findEntry(id)) {
+        if (oldClass->isDictionary()) {
+            oldClass->appendMember(id, data, entry);
+            object->setInternalClass(oldClass);
+            return;
+        }
+
+        if (oldClass->shouldBecomeDictionary(id, data)) {
+            Scope scope(oldClass->engine);
+            Scoped<QV4::InternalClass> dictionary(scope, oldClass->dictionary());
+            dictionary->d()->appendMember(id, data, entry);
+            object->setInternalClass(dictionary->d());
+            return;
+        }
+    }
+
     Heap::InternalClass *newClass = oldClass->addMember(id, data, entry);
     if (newClass != oldClass)
         object->setInternalClass(newClass);
@@ -616,12 +674,66 @@ Heap::InternalClass *InternalClass::addMemberImpl(PropertyKey identifier, Proper
     return newClass;
 }
 
+bool InternalClass::shouldBecomeDictionary(PropertyKey identifier, PropertyAttributes data)
+{
+    if (size < DictionaryThreshold || !engine->isInitialized)
+        return false;
+
+    // If another object has taken the same transition before, the shape is shared and worth
+    // keeping in the tree.
+    const Transition temp = { { identifier }, nullptr, int(data.all()) };
+    return !std::binary_search(transitions.begin(), transitions.end(), temp);
+}
+
+Heap::InternalClass *InternalClass::dictionary()
+{
+    Scope scope(engine);
+    Scoped<QV4::InternalClass> scopedNewClass(scope, engine->newClass(this));
+    auto newClass = scopedNewClass->d();
+    newClass->flags |= Dictionary;
+
+    // The class belongs to a single object. It's registered under a key nobody else can look up,
+    // so that it stays part of the tree for updateProtoUsage(), but is never shared.
+    Transition temp = { { PropertyKey::fromId(newClass->protoId) }, newClass, Transition::Dictionary };
+    lookupOrInsertTransition(temp);
+    return newClass;
+}
+
+void InternalClass::appendMember(PropertyKey identifier, PropertyAttributes data, InternalClassEntry *entry)
+{
+    Q_ASSERT(isDictionary());
+    Q_ASSERT(identifier.isStringOrSymbol());
+    Q_ASSERT(!findEntry(identifier));
+
+    if (entry) {
+        entry->index = size;
+        entry->setterIndex = data.isAccessor() ? size + 1 : UINT_MAX;
+        entry->attributes = data;
+    }
+
+    PropertyHash::Entry e = { identifier, size, data.isAccessor() ? size + 1 : UINT_MAX };
+    propertyTable.addEntry(e, size);
+    nameMap.add(size, identifier);
+    propertyData.add(size, data);
+    ++size;
+    if (data.isAccessor())
+        addDummyEntry(this, e);
+
+    // Existing members keep their indices, so cached lookups for them stay valid. Lookups that
+    // rely on the absence of a member check the protoId, though.
+    protoId = engine->newProtoId();
+}
+
 void InternalClass::removeChildEntry(InternalClass *child)
 {
     Q_ASSERT(engine);
-    for (auto &t : transitions) {
-        if (t.lookup == child) {
-            t.lookup = nullptr;
+    for (auto it = transitions.begin(); it != transitions.end(); ++it) {
+        if (it->lookup == child) {
+            // Dictionary transitions are never looked up again.
+            if (it->flags == Transition::Dictionary)
+                transitions.erase(it);
+            else
+                it->lookup = nullptr;
             return;
         }
     }
@@ -796,6 +908,47 @@ void InternalClass::markObjects(Heap::Base *b, MarkStack *stack)
 
 }
 
+InternalClassStatistics internalClassStatistics(ExecutionEngine *engine)
+{
+    InternalClassStatistics statistics;
+    QSet<const void *> seenTables;
+
+    // All internal classes descend from the empty one. The tree can be deep, so don't recurse.
+    std::vector<Heap::InternalClass *> pending { engine->internalClasses(EngineBase::Class_Empty) };
+    while (!pending.empty()) {
+        Heap::InternalClass *ic = pending.back();
+        pending.pop_back();
+
+        ++statistics.classes;
+        if (ic->isDictionary())
+            ++statistics.dictionaryClasses;
+        statistics.classBytes += sizeof(Heap::InternalClass);
+        if (ic->transitions.capacity() > 1)
+            statistics.transitionBytes += ic->transitions.capacity() * sizeof(InternalClassTransition);
+
+        if (!seenTables.contains(ic->propertyTable.d)) {
+            seenTables.insert(ic->propertyTable.d);
+            statistics.propertyTableBytes += sizeof(PropertyHashData)
+                    + ic->propertyTable.d->alloc * sizeof(PropertyHash::Entry);
+        }
+        if (!seenTables.contains(ic->nameMap.d)) {
+            seenTables.insert(ic->nameMap.d);
+            statistics.nameMapBytes += ic->nameMap.d->memoryUsage();
+        }
+        if (!seenTables.contains(ic->propertyData.d)) {
+            seenTables.insert(ic->propertyData.d);
+            statistics.attributeBytes += ic->propertyData.d->memoryUsage();
+        }
+
+        for (const InternalClassTransition &t : ic->transitions) {
+            if (t.lookup)
+                pending.push_back(t.lookup);
+        }
+    }
+
+    return statistics;
+}
+
 }
 
 QT_END_NAMESPACE
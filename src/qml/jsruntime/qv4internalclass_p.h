@@ -144,6 +144,11 @@ struct SharedInternalClassDataPrivate<PropertyAttributes> {
 
     void mark(MarkStack *) {}
 
+    size_t memoryUsage() const
+    {
+        return m_alloc > NumAttributesInPointer ? m_alloc * sizeof(PropertyAttributes) : 0;
+    }
+
     int refcount = 1;
 private:
     uint m_alloc;
@@ -195,6 +200,8 @@ struct SharedInternalClassDataPrivate<PropertyKey> {
 
     void mark(MarkStack *s);
 
+    size_t memoryUsage() const;
+
     int refcount = 1;
 private:
     ExecutionEngine *engine;
@@ -302,6 +309,7 @@ struct InternalClassTransition
         Sealed          = StructureChange | (1 << 4),
         Frozen          = StructureChange | (1 << 5),
         Locked          = StructureChange | (1 << 6),
+        Dictionary      = StructureChange | (1 << 7),
     };
 
     bool operator==(const InternalClassTransition &other) const
@@ -311,6 +319,24 @@ struct InternalClassTransition
     { return flags < other.flags || (flags == other.flags && id < other.id); }
 };
 
+struct InternalClassStatistics
+{
+    quint64 classes = 0;
+    quint64 dictionaryClasses = 0;
+    quint64 classBytes = 0;         // the InternalClass objects themselves
+    quint64 transitionBytes = 0;    // out-of-line transition arrays
+    quint64 propertyTableBytes = 0; // property hashes, counted once per shared table
+    quint64 nameMapBytes = 0;       // name maps, counted once per shared table
+    quint64 attributeBytes = 0;     // out-of-line attributes, counted once per shared table
+
+    quint64 totalBytes() const
+    {
+        return classBytes + transitionBytes + propertyTableBytes + nameMapBytes + attributeBytes;
+    }
+};
+
+Q_QML_EXPORT InternalClassStatistics internalClassStatistics(ExecutionEngine *engine);
+
 namespace Heap {
 
 struct InternalClass : Base {
@@ -320,9 +346,14 @@ struct InternalClass : Base {
         Frozen        = 1 << 2,
         UsedAsProto   = 1 << 3,
         Locked        = 1 << 4,
+        Dictionary    = 1 << 5,
     };
     enum { MaxRedundantTransitions = 255 };
 
+    // An object that adds a new member beyond this many, on a shape no other object has taken
+    // yet, gets a dictionary class of its own. New members are then added to that class in place.
+    enum { DictionaryThreshold = 128 };
+
     ExecutionEngine *engine;
     const VTable *vtable;
     quintptr protoId; // unique across the engine, gets changed whenever the proto chain changes
@@ -346,6 +377,7 @@ struct InternalClass : Base {
     bool isFrozen() const { return flags & Frozen; }
     bool isUsedAsProto() const { return flags & UsedAsProto; }
     bool isLocked() const { return flags & Locked; }
+    bool isDictionary() const { return flags & Dictionary; }
 
     void init(ExecutionEngine *engine);
     void init(InternalClass *other);
@@ -478,6 +510,10 @@ private:
     Q_QML_EXPORT InternalClass *changePrototypeImpl(Heap::Object *proto);
     InternalClass *addMemberImpl(PropertyKey identifier, PropertyAttributes data, InternalClassEntry *entry);
 
+    bool shouldBecomeDictionary(PropertyKey identifier, PropertyAttributes data);
+    Q_REQUIRED_RESULT InternalClass *dictionary();
+    void appendMember(PropertyKey identifier, PropertyAttributes data, InternalClassEntry *entry);
+
     void removeChildEntry(InternalClass *child);
     friend struct ::QV4::ExecutionEngine;
 };
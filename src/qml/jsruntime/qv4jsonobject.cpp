@@ -14,6 +14,9 @@
 
 #include <qstack.h>
 #include <qstringlist.h>
+#include <qiodevice.h>
+
+#include <private/qsimd_p.h>
 
 #include <wtf/MathExtras.h>
 
@@ -35,6 +38,8 @@ static int indent = 0;
 DEFINE_OBJECT_VTABLE(JsonObject);
 
 static const int nestingLimit = 1024;
+static const int shapeCacheSize = 64;
+static const int flushThreshold = 1 << 16;
 
 
 JsonParser::JsonParser(ExecutionEngine *engine, const QChar *json, int length)
@@ -85,19 +90,69 @@ enum {
     Quote = 0x22
 };
 
-bool JsonParser::eatSpace()
+static inline bool isSpace(char16_t ch)
 {
-    while (json < end) {
+    return ch == Space || ch == Tab || ch == LineFeed || ch == Return;
+}
+
+// The scanners below look at eight characters at a time where SSE2 is available. They return the
+// first character that is not whitespace, or that ends a run of plain characters in a string.
+
+static inline const QChar *skipSpace(const QChar *json, const QChar *end)
+{
+#if defined(__SSE2__)
+    const __m128i space = _mm_set1_epi16(Space);
+    const __m128i tab = _mm_set1_epi16(Tab);
+    const __m128i lineFeed = _mm_set1_epi16(LineFeed);
+    const __m128i carriageReturn = _mm_set1_epi16(Return);
+    for (; end - json >= 8; json += 8) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(json));
+        const __m128i blank = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi16(chunk, space), _mm_cmpeq_epi16(chunk, tab)),
+                _mm_or_si128(_mm_cmpeq_epi16(chunk, lineFeed),
+                             _mm_cmpeq_epi16(chunk, carriageReturn)));
+        const uint nonBlank = ~uint(_mm_movemask_epi8(blank)) & 0xffff;
+        if (nonBlank)
+            return json + qCountTrailingZeroBits(nonBlank) / 2;
+    }
+#endif
+    while (json < end && isSpace(json->unicode()))
+        ++json;
+    return json;
+}
+
+// Finds the closing quote, a backslash or a control character, which is an error.
+static inline const QChar *skipPlainCharacters(const QChar *json, const QChar *end)
+{
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi16(Quote);
+    const __m128i backslash = _mm_set1_epi16(u'\\');
+    // There is no unsigned 16 bit comparison in SSE2. Flip the sign bits and compare signed.
+    const __m128i signBit = _mm_set1_epi16(short(0x8000));
+    const __m128i firstPrintable = _mm_set1_epi16(short(0x8000 | Space));
+    for (; end - json >= 8; json += 8) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(json));
+        const __m128i special = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi16(chunk, quote), _mm_cmpeq_epi16(chunk, backslash)),
+                _mm_cmplt_epi16(_mm_xor_si128(chunk, signBit), firstPrintable));
+        if (const uint mask = _mm_movemask_epi8(special))
+            return json + qCountTrailingZeroBits(mask) / 2;
+    }
+#endif
+    for (; json < end; ++json) {
         const char16_t ch = json->unicode();
-        if (ch > Space)
-            break;
-        if (ch != Space &&
-            ch != Tab &&
-            ch != LineFeed &&
-            ch != Return)
+        if (ch == Quote || ch == u'\\' || ch < Space)
             break;
-        ++json;
     }
+    return json;
+}
+
+bool JsonParser::eatSpace()
+{
+    // Tokens are mostly followed by a single blank or none. Only indentation is worth a scan.
+    if (json < end && json->unicode() > Space)
+        return true;
+    json = skipSpace(json, end);
     return (json < end);
 }
 
@@ -137,6 +192,7 @@ ReturnedValue JsonParser::parse(QJsonParseError *error)
     eatSpace();
 
     Scope scope(engine);
+    shapeCache = scope.alloc(2 * shapeCacheSize);
     ScopedValue v(scope);
     if (!parseValue(v)) {
 #ifdef PARSER_DEBUG
@@ -214,8 +270,9 @@ bool JsonParser::parseMember(Object *o)
     BEGIN << "parseMember";
     Scope scope(engine);
 
-    QString key;
-    if (!parseString(&key))
+    QStringView key;
+    QString keyBuffer;
+    if (!parseKey(&key, &keyBuffer))
         return false;
     QChar token = nextToken();
     if (token.unicode() != NameSeparator) {
@@ -226,13 +283,34 @@ bool JsonParser::parseMember(Object *o)
     if (!parseValue(val))
         return false;
 
-    ScopedString s(scope, engine->newString(key));
+    // Objects of the same layout, like the elements of an array usually are, add their members
+    // in the same order. If the last object that had this internal class added the same key
+    // next, we can take the same transition without creating a string for the key.
+    Heap::InternalClass *from = o->internalClass();
+    Value *cached = shapeCache + 2 * ((quintptr(from) >> 5) & (shapeCacheSize - 1));
+    if (cached[0].heapObject() == from) {
+        Heap::InternalClass *to = static_cast<Heap::InternalClass *>(cached[1].heapObject());
+        // The key was inserted by a previous parseMember(), so it's always a string.
+        if (to->nameMap.at(from->size).asStringOrSymbol()->textEquals(key)) {
+            o->setInternalClass(to);
+            o->setProperty(from->size, *val.ptr);
+            END;
+            return true;
+        }
+    }
+
+    ScopedString s(scope, engine->newString(key.toString()));
     PropertyKey skey = s->toPropertyKey();
     if (skey.isArrayIndex()) {
         o->put(skey.asArrayIndex(), val);
     } else {
         // avoid trouble with properties named __proto__
         o->insertMember(s, val);
+        Heap::InternalClass *to = o->internalClass();
+        if (to->size == from->size + 1 && !to->isDictionary()) {
+            cached[0] = Value::fromHeapObject(from);
+            cached[1] = Value::fromHeapObject(to);
+        }
     }
 
     END;
@@ -437,16 +515,24 @@ bool JsonParser::parseNumber(Value *val)
             ++json;
     }
 
-    QString number(start, json - start);
+    const QStringView number(start, json - start);
     DEBUG << "numberstring" << number;
 
     if (isInt) {
-        bool ok;
-        int n = number.toInt(&ok);
-        if (ok && n < (1<<25) && n > -(1<<25)) {
-            *val = Value::fromInt32(n);
-            END;
-            return true;
+        // At most 8 digits, anything longer is out of range anyway
+        const bool negative = *start == u'-';
+        const QChar *digits = start + (negative ? 1 : 0);
+        if (digits < json && json - digits <= 8) {
+            int n = 0;
+            for (const QChar *digit = digits; digit < json; ++digit)
+                n = n * 10 + (digit->unicode() - u'0');
+            if (negative)
+                n = -n;
+            if (n < (1<<25) && n > -(1<<25)) {
+                *val = Value::fromInt32(n);
+                END;
+                return true;
+            }
         }
     }
 
@@ -550,26 +636,26 @@ bool JsonParser::parseString(QString *string)
     BEGIN << "parse string stringPos=" << json;
 
     while (json < end) {
+        const QChar *special = skipPlainCharacters(json, end);
+        string->append(json, special - json);
+        json = special;
+        if (json == end)
+            break;
         if (*json == u'"')
             break;
-        else if (*json == u'\\') {
-            uint ch = 0;
-            if (!scanEscapeSequence(json, end, &ch)) {
-                lastError = QJsonParseError::IllegalEscapeSequence;
-                return false;
-            }
-            if (QChar::requiresSurrogates(ch)) {
-                *string += QChar(QChar::highSurrogate(ch)) + QChar(QChar::lowSurrogate(ch));
-            } else {
-                *string += QChar(ch);
-            }
+        if (*json != u'\\') {
+            lastError = QJsonParseError::IllegalEscapeSequence;
+            return false;
+        }
+        uint ch = 0;
+        if (!scanEscapeSequence(json, end, &ch)) {
+            lastError = QJsonParseError::IllegalEscapeSequence;
+            return false;
+        }
+        if (QChar::requiresSurrogates(ch)) {
+            *string += QChar(QChar::highSurrogate(ch)) + QChar(QChar::lowSurrogate(ch));
         } else {
-            if (json->unicode() <= 0x1f) {
-                lastError = QJsonParseError::IllegalEscapeSequence;
-                return false;
-            }
-            *string += *json;
-            ++json;
+            *string += QChar(ch);
         }
     }
     ++json;
@@ -583,6 +669,22 @@ bool JsonParser::parseString(QString *string)
     return true;
 }
 
+// Member names rarely contain escape sequences. Refer to the input for those instead of copying.
+bool JsonParser::parseKey(QStringView *key, QString *buffer)
+{
+    const QChar *special = skipPlainCharacters(json, end);
+    if (special < end && *special == u'"') {
+        *key = QStringView(json, special - json);
+        json = special + 1;
+        return true;
+    }
+
+    if (!parseString(buffer))
+        return false;
+    *key = *buffer;
+    return true;
+}
+
 
 struct Stringify
 {
@@ -594,6 +696,12 @@ struct Stringify
     QString indent;
     QStack<Object *> stack;
 
+    // All output is appended to result. If a device is set, the output is written to it
+    // as UTF-8 whenever result grows beyond flushThreshold.
+    QString result;
+    QIODevice *device = nullptr;
+    bool deviceError = false;
+
     bool stackContains(Object *o) {
         for (int i = 0; i < stack.size(); ++i)
             if (stack.at(i)->d() == o->d())
@@ -603,11 +711,22 @@ struct Stringify
 
     Stringify(ExecutionEngine *e) : v4(e), replacerFunction(nullptr), propertyList(nullptr), propertyListSize(0) {}
 
-    QString Str(const QString &key, const Value &v);
-    QString JA(Object *a);
-    QString JO(Object *o);
+    bool Str(const QString &key, const Value &v);
+    ReturnedValue resolve(const QString &key, const Value &v);
+    void serialize(const Value &value);
+    void JA(Object *a);
+    void JO(Object *o);
+
+    void quote(QStringView str);
+    void separate(bool first);
+    void close(const QString &stepback, bool empty, char16_t bracket);
 
-    QString makeMember(const QString &key, const Value &v);
+    void maybeFlush()
+    {
+        if (device && result.size() >= flushThreshold)
+            flush(false);
+    }
+    void flush(bool final);
 };
 
 class [[nodiscard]] CallDepthAndCycleChecker
@@ -633,51 +752,75 @@ private:
     ExecutionEngineCallDepthRecorder<1> m_callDepthRecorder;
 };
 
-static QString quote(const QString &str)
+void Stringify::quote(QStringView str)
 {
-    QString product;
-    const int length = str.size();
-    product.reserve(length + 2);
-    product += u'"';
-    for (int i = 0; i < length; ++i) {
-        QChar c = str.at(i);
-        switch (c.unicode()) {
+    result += u'"';
+    const QChar *run = str.begin();
+    const QChar *end = str.end();
+    for (const QChar *it = run; it != end; ++it) {
+        const char16_t c = it->unicode();
+        if (c > 0x1f && c != u'"' && c != u'\\')
+            continue;
+
+        // Append the characters that need no escaping in one go.
+        result.append(run, it - run);
+        run = it + 1;
+        switch (c) {
         case u'"':
-            product += QLatin1String("\\\"");
+            result += QLatin1String("\\\"");
             break;
         case u'\\':
-            product += QLatin1String("\\\\");
+            result += QLatin1String("\\\\");
             break;
         case u'\b':
-            product += QLatin1String("\\b");
+            result += QLatin1String("\\b");
             break;
         case u'\f':
-            product += QLatin1String("\\f");
+            result += QLatin1String("\\f");
             break;
         case u'\n':
-            product += QLatin1String("\\n");
+            result += QLatin1String("\\n");
             break;
         case u'\r':
-            product += QLatin1String("\\r");
+            result += QLatin1String("\\r");
             break;
         case u'\t':
-            product += QLatin1String("\\t");
+            result += QLatin1String("\\t");
             break;
         default:
-            if (c.unicode() <= 0x1f) {
-                product += QLatin1String("\\u00");
-                product += (c.unicode() > 0xf ? u'1' : u'0') +
-                        QLatin1Char("0123456789abcdef"[c.unicode() & 0xf]);
-            } else {
-                product += c;
-            }
+            result += QLatin1String("\\u00");
+            result += QLatin1Char(c > 0xf ? '1' : '0');
+            result += QLatin1Char("0123456789abcdef"[c & 0xf]);
+            break;
         }
     }
-    product += u'"';
-    return product;
+    result.append(run, end - run);
+    result += u'"';
+}
+
+void Stringify::flush(bool final)
+{
+    Q_ASSERT(device);
+    qsizetype size = result.size();
+    // Don't split a surrogate pair between two chunks. The UTF-8 encoder would replace both
+    // halves then.
+    if (!final && size && result.at(size - 1).isHighSurrogate())
+        --size;
+    if (!deviceError) {
+        const QByteArray utf8 = QStringView(result).first(size).toUtf8();
+        if (device->write(utf8) != utf8.size())
+            deviceError = true;
+    }
+    // Keeps the capacity, so that the buffer doesn't need to grow again.
+    result.remove(0, size);
 }
 
-QString Stringify::Str(const QString &key, const Value &v)
+/*
+    Calls toJSON and the replacer function on the value, if present, and unwraps Number,
+    String and Boolean objects. Returns undefined if the result has no JSON representation,
+    so that the caller can omit it before writing anything for it.
+*/
+ReturnedValue Stringify::resolve(const QString &key, const Value &v)
 {
     Scope scope(v4);
 
@@ -692,7 +835,7 @@ QString Stringify::Str(const QString &key, const Value &v)
             jsCallData.args[0] = v4->newString(key);
             value = toJSON->call(jsCallData);
             if (v4->hasException)
-                return QString();
+                return Encode::undefined();
         }
     }
 
@@ -711,7 +854,7 @@ QString Stringify::Str(const QString &key, const Value &v)
 
         value = replacerFunction->call(jsCallData);
         if (v4->hasException)
-            return QString();
+            return Encode::undefined();
     }
 
     o = value->asReturnedValue();
@@ -724,80 +867,114 @@ QString Stringify::Str(const QString &key, const Value &v)
             value = Encode(b->value());
     }
 
-    if (value->isNull())
-        return QStringLiteral("null");
-    if (value->isBoolean())
-        return value->booleanValue() ? QStringLiteral("true") : QStringLiteral("false");
-    if (value->isString())
-        return quote(value->stringValue()->toQString());
+    if (value->isNull() || value->isBoolean() || value->isString() || value->isNumber())
+        return value->asReturnedValue();
 
-    if (value->isNumber()) {
-        double d = value->toNumber();
-        return std::isfinite(d) ? value->toQString() : QStringLiteral("null");
-    }
+    o = value->asReturnedValue();
+    if (o && !o->as<FunctionObject>())
+        return value->asReturnedValue();
 
-    if (const QV4::VariantObject *v = value->as<QV4::VariantObject>()) {
-        return quote(v->d()->data().toString());
-    }
+    return Encode::undefined();
+}
 
-    o = value->asReturnedValue();
-    if (o) {
-        if (!o->as<FunctionObject>()) {
-            if (o->isArrayLike()) {
-                return JA(o.getPointer());
-            } else {
-                return JO(o);
-            }
-        }
+void Stringify::serialize(const Value &value)
+{
+    if (value.isNull()) {
+        result += QLatin1String("null");
+    } else if (value.isBoolean()) {
+        result += value.booleanValue() ? QLatin1String("true") : QLatin1String("false");
+    } else if (String *s = value.stringValue()) {
+        quote(s->toQString());
+    } else if (value.isNumber()) {
+        const double d = value.toNumber();
+        if (std::isfinite(d))
+            result += value.toQString();
+        else
+            result += QLatin1String("null");
+    } else if (const QV4::VariantObject *v = value.as<QV4::VariantObject>()) {
+        quote(v->d()->data().toString());
+    } else {
+        Object *o = value.objectValue();
+        Q_ASSERT(o && !o->as<FunctionObject>());
+        if (o->isArrayLike())
+            JA(o);
+        else
+            JO(o);
     }
+}
+
+bool Stringify::Str(const QString &key, const Value &v)
+{
+    Scope scope(v4);
+    ScopedValue value(scope, resolve(key, v));
+    if (v4->hasException || value->isUndefined())
+        return false;
+    serialize(value);
+    return true;
+}
 
-    return QString();
+void Stringify::separate(bool first)
+{
+    if (!first)
+        result += u',';
+    if (!gap.isEmpty()) {
+        result += u'\n';
+        result += indent;
+    }
 }
 
-QString Stringify::makeMember(const QString &key, const Value &v)
+void Stringify::close(const QString &stepback, bool empty, char16_t bracket)
 {
-    QString strP = Str(key, v);
-    if (!strP.isEmpty()) {
-        QString member = quote(key) + u':';
-        if (!gap.isEmpty())
-            member += u' ';
-        member += strP;
-        return member;
+    if (!empty && !gap.isEmpty()) {
+        result += u'\n';
+        result += stepback;
     }
-    return QString();
+    result += bracket;
 }
 
-QString Stringify::JO(Object *o)
+void Stringify::JO(Object *o)
 {
     CallDepthAndCycleChecker check(this, o);
     if (check.foundProblem())
-        return QString();
+        return;
 
     Scope scope(v4);
 
-    QString result;
     stack.push(o);
     QString stepback = indent;
     indent += gap;
 
-    QStringList partial;
+    result += u'{';
+    bool empty = true;
+    ScopedValue value(scope);
+    const auto member = [&](const QString &key, const Value &v) {
+        value = resolve(key, v);
+        if (value->isUndefined())
+            return;
+        separate(empty);
+        empty = false;
+        quote(key);
+        result += u':';
+        if (!gap.isEmpty())
+            result += u' ';
+        serialize(value);
+        maybeFlush();
+    };
+
     if (!propertyListSize) {
         ObjectIterator it(scope, o, ObjectIterator::EnumerableOnly);
         ScopedValue name(scope);
 
         ScopedValue val(scope);
-        while (1) {
+        while (!v4->hasException) {
             name = it.nextPropertyNameAsString(val);
             if (name->isNull())
                 break;
-            QString key = name->toQString();
-            QString member = makeMember(key, val);
-            if (!member.isEmpty())
-                partial += member;
+            member(name->toQString(), val);
         }
     } else {
         ScopedValue v(scope);
-        for (int i = 0; i < propertyListSize; ++i) {
+        for (int i = 0; i < propertyListSize && !v4->hasException; ++i) {
             bool exists;
             String *s = propertyList + i;
             if (!s)
@@ -805,69 +982,67 @@ QString Stringify::JO(Object *o)
             v = o->get(s, &exists);
             if (!exists)
                 continue;
-            QString member = makeMember(s->toQString(), v);
-            if (!member.isEmpty())
-                partial += member;
+            member(s->toQString(), v);
         }
     }
 
-    if (partial.isEmpty()) {
-        result = QStringLiteral("{}");
-    } else if (gap.isEmpty()) {
-        result = u'{' + partial.join(u',') + u'}';
-    } else {
-        QString separator = QLatin1String(",\n") + indent;
-        result = QLatin1String("{\n") + indent + partial.join(separator) + u'\n'
-                 + stepback + u'}';
-    }
+    close(stepback, empty, u'}');
 
     indent = stepback;
     stack.pop();
-    return result;
 }
 
-QString Stringify::JA(Object *a)
+void Stringify::JA(Object *a)
 {
     CallDepthAndCycleChecker check(this, a);
     if (check.foundProblem())
-        return QString();
+        return;
 
     Scope scope(a->engine());
 
-    QString result;
     stack.push(a);
     QString stepback = indent;
     indent += gap;
 
-    QStringList partial;
+    result += u'[';
     uint len = a->getLength();
     ScopedValue v(scope);
-    for (uint i = 0; i < len; ++i) {
+    for (uint i = 0; i < len && !v4->hasException; ++i) {
+        separate(i == 0);
         bool exists;
         v = a->get(i, &exists);
-        if (!exists) {
-            partial += QStringLiteral("null");
-            continue;
-        }
-        QString strP = Str(QString::number(i), v);
-        if (!strP.isEmpty())
-            partial += strP;
+        if (exists)
+            v = resolve(QString::number(i), v);
+        if (!exists || v->isUndefined())
+            result += QLatin1String("null");
         else
-            partial += QStringLiteral("null");
+            serialize(v);
+        maybeFlush();
     }
 
-    if (partial.isEmpty()) {
-        result = QStringLiteral("[]");
-    } else if (gap.isEmpty()) {
-        result = u'[' + partial.join(u',') + u']';
-    } else {
-        QString separator = QLatin1String(",\n") + indent;
-        result = QLatin1String("[\n") + indent + partial.join(separator) + u'\n' + stepback + u']';
-    }
+    close(stepback, len == 0, u']');
 
     indent = stepback;
     stack.pop();
-    return result;
+}
+
+bool JsonObject::stringify(ExecutionEngine *engine, const Value &value, const QString &gap,
+                           QIODevice *device)
+{
+    Scope scope(engine);
+    Stringify stringify(engine);
+    stringify.gap = gap.left(10);
+    stringify.device = device;
+
+    ScopedValue v(scope, value);
+    const bool produced = stringify.Str(QString(), v);
+    if (scope.hasException()) {
+        engine->catchException();
+        return false;
+    }
+    if (produced)
+        stringify.flush(true);
+    return produced && !stringify.deviceError;
 }
 
 
@@ -948,10 +1123,9 @@ ReturnedValue JsonObject::method_stringify(const FunctionObject *b, const Value
 
 
     ScopedValue arg0(scope, argc ? argv[0] : Value::undefinedValue());
-    QString result = stringify.Str(QString(), arg0);
-    if (result.isEmpty() || scope.hasException())
+    if (!stringify.Str(QString(), arg0) || scope.hasException())
         RETURN_UNDEFINED();
-    return Encode(scope.engine->newString(result));
+    return Encode(scope.engine->newString(stringify.result));
 }
 
 
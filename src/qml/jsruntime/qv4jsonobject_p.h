@@ -23,6 +23,8 @@
 
 QT_BEGIN_NAMESPACE
 
+class QIODevice;
+
 namespace QV4 {
 
 namespace Heap {
@@ -55,6 +57,11 @@ public:
     static ReturnedValue method_parse(const FunctionObject *, const Value *thisObject, const Value *argv, int argc);
     static ReturnedValue method_stringify(const FunctionObject *, const Value *thisObject, const Value *argv, int argc);
 
+    // Serializes value like JSON.stringify() without a replacer, writing the UTF-8 output to
+    // device in chunks as it is produced.
+    static bool stringify(ExecutionEngine *engine, const Value &value, const QString &gap,
+                          QIODevice *device);
+
     static ReturnedValue fromJsonValue(ExecutionEngine *engine, const QJsonValue &value);
     static ReturnedValue fromJsonObject(ExecutionEngine *engine, const QJsonObject &object);
     static ReturnedValue fromJsonArray(ExecutionEngine *engine, const QJsonArray &array);
@@ -86,6 +93,7 @@ private:
     ReturnedValue parseObject();
     ReturnedValue parseArray();
     bool parseMember(Object *o);
+    bool parseKey(QStringView *key, QString *buffer);
     bool parseString(QString *string);
     bool parseValue(Value *val);
     bool parseNumber(Value *val);
@@ -95,6 +103,9 @@ private:
     const QChar *json;
     const QChar *end;
 
+    // Pairs of internal classes and the one the last member added to them led to
+    Value *shapeCache = nullptr;
+
     int nestingLevel;
     QJsonParseError::ParseError lastError;
 };
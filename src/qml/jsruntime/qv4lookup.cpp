@@ -10,6 +10,8 @@
 #include <private/qv4runtime_p.h>
 #include <private/qv4stackframe_p.h>
 
+#include <algorithm>
+
 QT_BEGIN_NAMESPACE
 
 using namespace QV4;
@@ -156,17 +158,171 @@ static inline void setupProtoLookupTwoClasses(Lookup *lookup, const Lookup &firs
     lookup->protoLookupTwoClasses.data2 = data2;
 }
 
+using PolymorphicEntry = PolymorphicLookup::Entry;
+
+static PolymorphicEntry ownEntry(Heap::InternalClass *ic, PolymorphicEntry::Kind kind, uint offset)
+{
+    PolymorphicEntry entry;
+    entry.protoId = ic->protoId;
+    entry.offset = offset;
+    entry.kind = kind;
+    return entry;
+}
+
+static PolymorphicEntry protoEntry(quintptr protoId, PolymorphicEntry::Kind kind, const Value *data)
+{
+    PolymorphicEntry entry;
+    entry.protoId = protoId;
+    entry.data = data;
+    entry.kind = kind;
+    return entry;
+}
+
+// Writes the shapes a monomorphic or two-class getter has seen to entries, and returns how many
+// there are. Returns 0 if the lookup is in any other state.
+static uint polymorphicEntries(const Lookup &lookup, PolymorphicEntry *entries)
+{
+    const auto &own = lookup.objectLookup;
+    const auto &ownTwo = lookup.objectLookupTwoClasses;
+    const auto &proto = lookup.protoLookup;
+    const auto &protoTwo = lookup.protoLookupTwoClasses;
+
+    switch (lookup.call) {
+    case Lookup::Call::Getter0Inline:
+        entries[0] = ownEntry(own.ic, PolymorphicEntry::Inline, own.offset);
+        return 1;
+    case Lookup::Call::Getter0MemberData:
+        entries[0] = ownEntry(own.ic, PolymorphicEntry::MemberData, own.offset);
+        return 1;
+    case Lookup::Call::GetterAccessor:
+        entries[0] = ownEntry(own.ic, PolymorphicEntry::Accessor, own.offset);
+        return 1;
+    case Lookup::Call::GetterProto:
+        entries[0] = protoEntry(proto.protoId, PolymorphicEntry::Proto, proto.data);
+        return 1;
+    case Lookup::Call::GetterProtoAccessor:
+        entries[0] = protoEntry(proto.protoId, PolymorphicEntry::ProtoAccessor, proto.data);
+        return 1;
+    case Lookup::Call::Getter0InlineGetter0Inline:
+        entries[0] = ownEntry(ownTwo.ic, PolymorphicEntry::Inline, ownTwo.offset);
+        entries[1] = ownEntry(ownTwo.ic2, PolymorphicEntry::Inline, ownTwo.offset2);
+        return 2;
+    case Lookup::Call::Getter0InlineGetter0MemberData:
+        entries[0] = ownEntry(ownTwo.ic, PolymorphicEntry::Inline, ownTwo.offset);
+        entries[1] = ownEntry(ownTwo.ic2, PolymorphicEntry::MemberData, ownTwo.offset2);
+        return 2;
+    case Lookup::Call::Getter0MemberDataGetter0MemberData:
+        entries[0] = ownEntry(ownTwo.ic, PolymorphicEntry::MemberData, ownTwo.offset);
+        entries[1] = ownEntry(ownTwo.ic2, PolymorphicEntry::MemberData, ownTwo.offset2);
+        return 2;
+    case Lookup::Call::GetterProtoTwoClasses:
+        entries[0] = protoEntry(protoTwo.protoId, PolymorphicEntry::Proto, protoTwo.data);
+        entries[1] = protoEntry(protoTwo.protoId2, PolymorphicEntry::Proto, protoTwo.data2);
+        return 2;
+    case Lookup::Call::GetterProtoAccessorTwoClasses:
+        entries[0] = protoEntry(protoTwo.protoId, PolymorphicEntry::ProtoAccessor, protoTwo.data);
+        entries[1] = protoEntry(protoTwo.protoId2, PolymorphicEntry::ProtoAccessor, protoTwo.data2);
+        return 2;
+    default:
+        break;
+    }
+    return 0;
+}
+
+static ReturnedValue polymorphicGet(
+        const PolymorphicEntry &entry, ExecutionEngine *engine, Heap::Object *o,
+        const Value &object)
+{
+    const Value *getter = nullptr;
+    switch (entry.kind) {
+    case PolymorphicEntry::Inline:
+        return o->inlinePropertyDataWithOffset(entry.offset)->asReturnedValue();
+    case PolymorphicEntry::MemberData:
+        return o->memberData->values.data()[entry.offset].asReturnedValue();
+    case PolymorphicEntry::Proto:
+        return entry.data->asReturnedValue();
+    case PolymorphicEntry::Accessor:
+        getter = o->propertyData(entry.offset);
+        break;
+    case PolymorphicEntry::ProtoAccessor:
+        getter = entry.data;
+        break;
+    }
+
+    if (!getter->isFunctionObject()) // ### catch at resolve time
+        return Encode::undefined();
+
+    return checkedResult(engine, static_cast<const FunctionObject *>(getter)->call(
+                                 &object, nullptr, 0));
+}
+
+// Does the resolution on a second lookup, so that the state of the first one is retained.
+static ReturnedValue resolveGetterOnCopy(
+        const Lookup *lookup, ExecutionEngine *engine, const Object *object, Lookup *second)
+{
+    memset(second, 0, sizeof(Lookup));
+    second->nameIndex = lookup->nameIndex;
+    second->forCall = lookup->forCall;
+    second->call = Lookup::Call::GetterGeneric;
+    return second->resolveGetter(engine, object);
+}
+
+static PropertyKey lookupName(const Lookup *lookup, ExecutionEngine *engine)
+{
+    return engine->identifierTable->asPropertyKey(
+            engine->currentStackFrame->v4Function->compilationUnit->runtimeStrings[lookup->nameIndex]);
+}
+
+static MegamorphicLookupCache *megamorphicCache(ExecutionEngine *engine)
+{
+    if (!engine->megamorphicLookupCache)
+        engine->megamorphicLookupCache = new MegamorphicLookupCache;
+    return engine->megamorphicLookupCache;
+}
+
+static void insertMegamorphic(MegamorphicLookupCache *cache, PropertyKey name, const PolymorphicEntry &entry)
+{
+    MegamorphicLookupCache::Entry &slot = cache->slot(entry.protoId, name);
+    slot.shape = entry;
+    slot.key = name.id();
+}
+
+// Merges the shapes of a lookup that has seen one or two of them with the one just resolved.
+static ReturnedValue setupPolymorphicGetter(Lookup *lookup, Lookup *second, ReturnedValue result)
+{
+    PolymorphicEntry entries[3];
+    const uint size = polymorphicEntries(*lookup, entries);
+    if (size && polymorphicEntries(*second, entries + size) == 1) {
+        PolymorphicLookup *shapes = new PolymorphicLookup;
+        std::copy_n(entries, size + 1, shapes->entries);
+        shapes->size = size + 1;
+
+        // The internal classes of the previous state are not needed anymore.
+        lookup->markDef.h1 = nullptr;
+        lookup->markDef.h2 = nullptr;
+        lookup->polymorphicLookup.shapes = shapes;
+        lookup->call = Lookup::Call::GetterPolymorphic;
+        return result;
+    }
+
+    second->releasePropertyCache();
+
+    // A getter run during the resolution may have used the same lookup.
+    if (lookup->call != Lookup::Call::GetterPolymorphic
+            && lookup->call != Lookup::Call::GetterMegamorphic) {
+        lookup->releasePropertyCache();
+        lookup->call = Lookup::Call::GetterQObjectPropertyFallback;
+    }
+    return result;
+}
+
 ReturnedValue Lookup::getterTwoClasses(Lookup *lookup, ExecutionEngine *engine, const Value &object)
 {
     if (const Object *o = object.as<Object>()) {
 
         // Do the resolution on a second lookup, then merge.
         Lookup second;
-        memset(&second, 0, sizeof(Lookup));
-        second.nameIndex = lookup->nameIndex;
-        second.forCall = lookup->forCall;
-        second.call = Call::GetterGeneric;
-        const ReturnedValue result = second.resolveGetter(engine, o);
+        const ReturnedValue result = resolveGetterOnCopy(lookup, engine, o, &second);
 
         switch (lookup->call) {
         case Call::Getter0Inline: {
@@ -223,14 +379,26 @@ ReturnedValue Lookup::getterTwoClasses(Lookup *lookup, ExecutionEngine *engine,
             break;
         }
 
-        // If any of the above options were true, the propertyCache was inactive.
-        second.releasePropertyCache();
+        return setupPolymorphicGetter(lookup, &second, result);
     }
 
     lookup->call = Call::GetterQObjectPropertyFallback;
     return getterFallback(lookup, engine, object);
 }
 
+// Called when a two-class getter sees a third internal class.
+static ReturnedValue twoClassesMiss(Lookup *lookup, ExecutionEngine *engine, const Value &object)
+{
+    if (const Object *o = object.as<Object>()) {
+        Lookup second;
+        const ReturnedValue result = resolveGetterOnCopy(lookup, engine, o, &second);
+        return setupPolymorphicGetter(lookup, &second, result);
+    }
+
+    lookup->call = Lookup::Call::GetterQObjectPropertyFallback;
+    return Lookup::getterFallback(lookup, engine, object);
+}
+
 ReturnedValue Lookup::getterFallback(Lookup *lookup, ExecutionEngine *engine, const Value &object)
 {
     QV4::Scope scope(engine);
@@ -291,8 +459,7 @@ ReturnedValue Lookup::getter0Inlinegetter0Inline(Lookup *lookup, ExecutionEngine
         if (lookup->objectLookupTwoClasses.ic2 == o->internalClass)
             return o->inlinePropertyDataWithOffset(lookup->objectLookupTwoClasses.offset2)->asReturnedValue();
     }
-    lookup->call = Call::GetterQObjectPropertyFallback;
-    return getterFallback(lookup, engine, object);
+    return twoClassesMiss(lookup, engine, object);
 }
 
 ReturnedValue Lookup::getter0Inlinegetter0MemberData(Lookup *lookup, ExecutionEngine *engine, const Value &object)
@@ -306,8 +473,7 @@ ReturnedValue Lookup::getter0Inlinegetter0MemberData(Lookup *lookup, ExecutionEn
         if (lookup->objectLookupTwoClasses.ic2 == o->internalClass)
             return o->memberData->values.data()[lookup->objectLookupTwoClasses.offset2].asReturnedValue();
     }
-    lookup->call = Call::GetterQObjectPropertyFallback;
-    return getterFallback(lookup, engine, object);
+    return twoClassesMiss(lookup, engine, object);
 }
 
 ReturnedValue Lookup::getter0MemberDatagetter0MemberData(Lookup *lookup, ExecutionEngine *engine, const Value &object)
@@ -321,8 +487,7 @@ ReturnedValue Lookup::getter0MemberDatagetter0MemberData(Lookup *lookup, Executi
         if (lookup->objectLookupTwoClasses.ic2 == o->internalClass)
             return o->memberData->values.data()[lookup->objectLookupTwoClasses.offset2].asReturnedValue();
     }
-    lookup->call = Call::GetterQObjectPropertyFallback;
-    return getterFallback(lookup, engine, object);
+    return twoClassesMiss(lookup, engine, object);
 }
 
 ReturnedValue Lookup::getterProtoTwoClasses(Lookup *lookup, ExecutionEngine *engine, const Value &object)
@@ -338,10 +503,8 @@ ReturnedValue Lookup::getterProtoTwoClasses(Lookup *lookup, ExecutionEngine *eng
             return lookup->protoLookupTwoClasses.data->asReturnedValue();
         if (lookup->protoLookupTwoClasses.protoId2 == o->internalClass->protoId)
             return lookup->protoLookupTwoClasses.data2->asReturnedValue();
-        return getterFallback(lookup, engine, object);
     }
-    lookup->call = Call::GetterQObjectPropertyFallback;
-    return getterFallback(lookup, engine, object);
+    return twoClassesMiss(lookup, engine, object);
 }
 
 ReturnedValue Lookup::getterAccessor(Lookup *lookup, ExecutionEngine *engine, const Value &object)
@@ -359,8 +522,7 @@ ReturnedValue Lookup::getterAccessor(Lookup *lookup, ExecutionEngine *engine, co
                                      &object, nullptr, 0));
         }
     }
-    lookup->call = Call::GetterQObjectPropertyFallback;
-    return getterFallback(lookup, engine, object);
+    return getterTwoClasses(lookup, engine, object);
 }
 
 ReturnedValue Lookup::getterProtoAccessor(Lookup *lookup, ExecutionEngine *engine, const Value &object)
@@ -404,8 +566,7 @@ ReturnedValue Lookup::getterProtoAccessorTwoClasses(Lookup *lookup, ExecutionEng
                                      &object, nullptr, 0));
         }
     }
-    lookup->call = Call::GetterQObjectPropertyFallback;
-    return getterFallback(lookup, engine, object);
+    return twoClassesMiss(lookup, engine, object);
 }
 
 ReturnedValue Lookup::getterIndexed(Lookup *lookup, ExecutionEngine *engine, const Value &object)
@@ -425,6 +586,87 @@ ReturnedValue Lookup::getterIndexed(Lookup *lookup, ExecutionEngine *engine, con
     return getterFallback(lookup, engine, object);
 }
 
+ReturnedValue Lookup::getterPolymorphic(Lookup *lookup, ExecutionEngine *engine, const Value &object)
+{
+    // Otherwise we cannot trust the protoIds
+    Q_ASSERT(engine->isInitialized);
+
+    // we can safely cast to a QV4::Object here. If object is actually a string,
+    // the protoId won't match
+    Heap::Object *o = static_cast<Heap::Object *>(object.heapObject());
+    if (o) {
+        const quintptr protoId = o->internalClass->protoId;
+        const PolymorphicLookup *shapes = lookup->polymorphicLookup.shapes;
+        for (uint i = 0; i < shapes->size; ++i) {
+            if (shapes->entries[i].protoId == protoId)
+                return polymorphicGet(shapes->entries[i], engine, o, object);
+        }
+    }
+
+    const Object *obj = object.as<Object>();
+    if (!obj)
+        return getterFallback(lookup, engine, object);
+
+    Lookup second;
+    const ReturnedValue result = resolveGetterOnCopy(lookup, engine, obj, &second);
+    PolymorphicEntry entry;
+
+    // Objects we cannot cache, and getters that have used the same lookup, leave it alone.
+    if (polymorphicEntries(second, &entry) != 1 || lookup->call != Call::GetterPolymorphic) {
+        second.releasePropertyCache();
+        return result;
+    }
+
+    PolymorphicLookup *shapes = lookup->polymorphicLookup.shapes;
+    if (shapes->size < PolymorphicLookup::MaxShapes) {
+        shapes->entries[shapes->size++] = entry;
+        return result;
+    }
+
+    // Too many shapes. Move them to the engine-wide cache.
+    MegamorphicLookupCache *cache = megamorphicCache(engine);
+    const PropertyKey name = lookupName(lookup, engine);
+    for (const PolymorphicEntry &shape : shapes->entries)
+        insertMegamorphic(cache, name, shape);
+    insertMegamorphic(cache, name, entry);
+
+    lookup->releasePropertyCache();
+    lookup->call = Call::GetterMegamorphic;
+    return result;
+}
+
+ReturnedValue Lookup::getterMegamorphic(Lookup *lookup, ExecutionEngine *engine, const Value &object)
+{
+    // Otherwise we cannot trust the protoIds
+    Q_ASSERT(engine->isInitialized);
+
+    MegamorphicLookupCache *cache = megamorphicCache(engine);
+    const PropertyKey name = lookupName(lookup, engine);
+
+    // we can safely cast to a QV4::Object here. If object is actually a string,
+    // the protoId won't match
+    Heap::Object *o = static_cast<Heap::Object *>(object.heapObject());
+    if (o) {
+        const quintptr protoId = o->internalClass->protoId;
+        const MegamorphicLookupCache::Entry &slot = cache->slot(protoId, name);
+        if (slot.shape.protoId == protoId && slot.key == name.id())
+            return polymorphicGet(slot.shape, engine, o, object);
+    }
+
+    const Object *obj = object.as<Object>();
+    if (!obj)
+        return getterFallback(lookup, engine, object);
+
+    Lookup second;
+    const ReturnedValue result = resolveGetterOnCopy(lookup, engine, obj, &second);
+    PolymorphicEntry entry;
+    if (polymorphicEntries(second, &entry) == 1)
+        insertMegamorphic(cache, name, entry);
+    else
+        second.releasePropertyCache();
+    return result;
+}
+
 ReturnedValue Lookup::getterQObject(Lookup *lookup, ExecutionEngine *engine, const Value &object)
 {
     const auto revertLookup = [lookup, engine, &object]() {
@@ -619,6 +861,116 @@ bool Lookup::setterGeneric(Lookup *lookup, ExecutionEngine *engine, Value &objec
     return o->put(name, value);
 }
 
+using PolymorphicSetterEntry = PolymorphicSetterLookup::Entry;
+
+// Returns the shapes a setter lookup has seen so far, in a form usable for a polymorphic setter.
+static uint polymorphicSetterEntries(const Lookup &lookup, PolymorphicSetterEntry *entries)
+{
+    switch (lookup.call) {
+    case Lookup::Call::Setter0Inline:
+    case Lookup::Call::Setter0MemberData:
+        entries[0] = { lookup.objectLookup.ic->protoId, nullptr, lookup.objectLookup.index };
+        return 1;
+    case Lookup::Call::Setter0Setter0:
+        entries[0] = { lookup.objectLookupTwoClasses.ic->protoId, nullptr,
+                       lookup.objectLookupTwoClasses.offset };
+        entries[1] = { lookup.objectLookupTwoClasses.ic2->protoId, nullptr,
+                       lookup.objectLookupTwoClasses.offset2 };
+        return 2;
+    case Lookup::Call::SetterInsert:
+        entries[0] = { lookup.insertionLookup.protoId, lookup.insertionLookup.newClass,
+                       lookup.insertionLookup.offset };
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+// Does the resolution, and therefore the store, on a second lookup, so that the state of the
+// first one is retained.
+static bool resolveSetterOnCopy(
+        const Lookup *lookup, ExecutionEngine *engine, Object *object, const Value &value,
+        Lookup *second)
+{
+    memset(second, 0, sizeof(Lookup));
+    second->nameIndex = lookup->nameIndex;
+    second->forCall = lookup->forCall;
+    second->call = Lookup::Call::SetterGeneric;
+    return second->resolveSetter(engine, object, value);
+}
+
+static void addPolymorphicSetterEntry(
+        ExecutionEngine *engine, PolymorphicSetterLookup *shapes, const PolymorphicSetterEntry &entry)
+{
+    // The table is not a heap object. Make sure an ongoing incremental GC sees the new class.
+    if (Heap::InternalClass *newClass = entry.newClass) {
+        WriteBarrier::markCustom(engine, [newClass](MarkStack *stack) {
+            if constexpr (WriteBarrier::isInsertionBarrier)
+                newClass->mark(stack);
+        });
+    }
+    shapes->entries[shapes->size++] = entry;
+}
+
+// Merges the shapes of a setter lookup that has seen one or two of them with the one just resolved.
+static void setupPolymorphicSetter(
+        Lookup *lookup, ExecutionEngine *engine, const PolymorphicSetterEntry *entries, uint size,
+        Lookup::Call previousCall, Lookup *second)
+{
+    PolymorphicSetterEntry resolved;
+    if (size && lookup->call == previousCall
+            && polymorphicSetterEntries(*second, &resolved) == 1) {
+        PolymorphicSetterLookup *shapes = new PolymorphicSetterLookup;
+        for (uint i = 0; i < size; ++i)
+            addPolymorphicSetterEntry(engine, shapes, entries[i]);
+        addPolymorphicSetterEntry(engine, shapes, resolved);
+
+        // The internal classes of the previous state are not needed anymore.
+        lookup->markDef.h1 = nullptr;
+        lookup->markDef.h2 = nullptr;
+        lookup->polymorphicSetterLookup.shapes = shapes;
+        lookup->call = Lookup::Call::SetterPolymorphic;
+        return;
+    }
+
+    second->releasePropertyCache();
+
+    // A setter run during the resolution may have used the same lookup.
+    if (lookup->call == previousCall) {
+        lookup->releasePropertyCache();
+        lookup->call = Lookup::Call::SetterQObjectPropertyFallback;
+    }
+}
+
+// Called when a setter lookup that has seen one or two internal classes meets another one.
+static bool setterMiss(Lookup *lookup, ExecutionEngine *engine, Value &object, const Value &value)
+{
+    if (!object.isObject()) {
+        lookup->releasePropertyCache();
+        lookup->call = Lookup::Call::SetterQObjectPropertyFallback;
+        return Lookup::setterFallback(lookup, engine, object, value);
+    }
+
+    // Stash the current shapes before resolving, as a setter called during the resolution may
+    // change the state of the lookup.
+    PolymorphicSetterEntry entries[2];
+    const uint size = polymorphicSetterEntries(*lookup, entries);
+    const Lookup::Call previousCall = lookup->call;
+
+    Lookup second;
+    if (!resolveSetterOnCopy(lookup, engine, static_cast<Object *>(&object), value, &second)) {
+        second.releasePropertyCache();
+        if (lookup->call == previousCall) {
+            lookup->releasePropertyCache();
+            lookup->call = Lookup::Call::SetterQObjectPropertyFallback;
+        }
+        return false;
+    }
+
+    setupPolymorphicSetter(lookup, engine, entries, size, previousCall, &second);
+    return true;
+}
+
 bool Lookup::setterTwoClasses(Lookup *lookup, ExecutionEngine *engine, Value &object, const Value &value)
 {
     // A precondition of this method is that lookup->objectLookup is the active variant of the union.
@@ -629,23 +981,29 @@ bool Lookup::setterTwoClasses(Lookup *lookup, ExecutionEngine *engine, Value &ob
         // As lookup->objectLookup is active, we can stash some members here, before resolving.
         Heap::InternalClass *ic = lookup->objectLookup.ic;
         const uint index = lookup->objectLookup.index;
+        const Call previousCall = lookup->call;
 
-        if (!lookup->resolveSetter(engine, static_cast<Object *>(&object), value)) {
-            lookup->call = Call::SetterQObjectPropertyFallback;
+        Lookup second;
+        if (!resolveSetterOnCopy(lookup, engine, static_cast<Object *>(&object), value, &second)) {
+            second.releasePropertyCache();
+            if (lookup->call == previousCall)
+                lookup->call = Call::SetterQObjectPropertyFallback;
             return false;
         }
 
-        if (lookup->call == Call::Setter0MemberData || lookup->call == Call::Setter0Inline) {
-            auto engine = ic->engine;
+        if (lookup->call == previousCall
+                && (second.call == Call::Setter0MemberData || second.call == Call::Setter0Inline)) {
             lookup->objectLookupTwoClasses.ic.set(engine, ic);
-            lookup->objectLookupTwoClasses.ic2.set(engine, ic);
+            lookup->objectLookupTwoClasses.ic2.set(engine, second.objectLookup.ic);
             lookup->objectLookupTwoClasses.offset = index;
-            lookup->objectLookupTwoClasses.offset2 = index;
+            lookup->objectLookupTwoClasses.offset2 = second.objectLookup.index;
             lookup->call = Call::Setter0Setter0;
             return true;
         }
 
-        lookup->releasePropertyCache();
+        const PolymorphicSetterEntry entry = { ic->protoId, nullptr, index };
+        setupPolymorphicSetter(lookup, engine, &entry, 1, previousCall, &second);
+        return true;
     }
 
     lookup->call = Call::SetterQObjectPropertyFallback;
@@ -699,8 +1057,7 @@ bool Lookup::setter0setter0(Lookup *lookup, ExecutionEngine *engine, Value &obje
         }
     }
 
-    lookup->call = Call::SetterQObjectPropertyFallback;
-    return setterFallback(lookup, engine, object, value);
+    return setterMiss(lookup, engine, object, value);
 }
 
 bool Lookup::setterInsert(Lookup *lookup, ExecutionEngine *engine, Value &object, const Value &value)
@@ -715,8 +1072,46 @@ bool Lookup::setterInsert(Lookup *lookup, ExecutionEngine *engine, Value &object
         return true;
     }
 
-    lookup->call = Call::SetterQObjectPropertyFallback;
-    return setterFallback(lookup, engine, object, value);
+    return setterMiss(lookup, engine, object, value);
+}
+
+bool Lookup::setterPolymorphic(Lookup *lookup, ExecutionEngine *engine, Value &object, const Value &value)
+{
+    // Otherwise we cannot trust the protoIds
+    Q_ASSERT(engine->isInitialized);
+
+    if (!object.isObject())
+        return setterFallback(lookup, engine, object, value);
+
+    Object *o = static_cast<Object *>(&object);
+    const quintptr protoId = o->internalClass()->protoId;
+    const PolymorphicSetterLookup *shapes = lookup->polymorphicSetterLookup.shapes;
+    for (uint i = 0; i < shapes->size; ++i) {
+        const PolymorphicSetterEntry &entry = shapes->entries[i];
+        if (entry.protoId != protoId)
+            continue;
+        if (entry.newClass)
+            o->setInternalClass(entry.newClass);
+        o->d()->setProperty(engine, entry.index, value);
+        return true;
+    }
+
+    Lookup second;
+    if (!resolveSetterOnCopy(lookup, engine, o, value, &second)) {
+        second.releasePropertyCache();
+        return false;
+    }
+
+    // Once the table is full, further shapes are resolved every time, like a generic setter would.
+    PolymorphicSetterEntry entry;
+    if (lookup->call == Call::SetterPolymorphic
+            && lookup->polymorphicSetterLookup.shapes->size < PolymorphicSetterLookup::MaxShapes
+            && polymorphicSetterEntries(second, &entry) == 1) {
+        addPolymorphicSetterEntry(engine, lookup->polymorphicSetterLookup.shapes, entry);
+    } else {
+        second.releasePropertyCache();
+    }
+    return true;
 }
 
 bool Lookup::setterQObject(Lookup *lookup, ExecutionEngine *engine, Value &object, const Value &v)
@@ -21,6 +21,9 @@
 #include <private/qqmltypewrapper_p.h>
 #include <private/qv4mm_p.h>
 
+#include <algorithm>
+#include <iterator>
+
 QT_BEGIN_NAMESPACE
 
 namespace QV4 {
@@ -32,6 +35,71 @@ namespace Heap {
 template <typename T, int PhantomTag>
 using HeapObjectWrapper = WriteBarrier::HeapObjectWrapper<T, PhantomTag>;
 
+// The shapes seen by a getter lookup that went past two internal classes. Shapes are identified by
+// the protoId of the internal class. protoIds are never reused, and change whenever the prototype
+// chain changes. Therefore the entries don't need to keep anything alive.
+struct PolymorphicLookup
+{
+    enum { MaxShapes = 4 };
+
+    struct Entry
+    {
+        enum Kind : quint8 { Inline, MemberData, Accessor, Proto, ProtoAccessor };
+
+        quintptr protoId;
+        union {
+            uint offset;        // Inline, MemberData, Accessor
+            const Value *data;  // Proto, ProtoAccessor
+        };
+        Kind kind;
+    };
+
+    Entry entries[MaxShapes];
+    uint size = 0;
+};
+
+// The shapes seen by a setter lookup that went past a single internal class, keyed by the protoId
+// of the internal class before the store. Stores that add a property also remember the class the
+// object transitions to. The transition tables of internal classes don't keep their targets
+// alive. Therefore, Lookup::markObjects marks these classes strongly, like for insertionLookup.
+struct PolymorphicSetterLookup
+{
+    enum { MaxShapes = 4 };
+
+    struct Entry
+    {
+        quintptr protoId;
+        Heap::InternalClass *newClass; // nullptr if the property already exists
+        uint index;
+    };
+
+    Entry entries[MaxShapes];
+    uint size = 0;
+};
+
+// Engine-wide cache for getter lookups that have seen more than PolymorphicLookup::MaxShapes
+// shapes. It's keyed by protoId and property key, and cleared on every garbage collection, as
+// property keys of dead identifiers can be reused.
+struct MegamorphicLookupCache
+{
+    enum { Size = 1024 };
+
+    struct Entry
+    {
+        PolymorphicLookup::Entry shape;
+        quint64 key;
+    };
+
+    Entry &slot(quintptr protoId, PropertyKey key)
+    {
+        return entries[((protoId >> 1) ^ (key.id() >> 4)) & (Size - 1)];
+    }
+
+    void clear() { std::fill(std::begin(entries), std::end(entries), Entry()); }
+
+    Entry entries[Size] = {};
+};
+
 // Note: We cannot hide the copy ctor and assignment operator of this class because it needs to
 //       be trivially copyable. But you should never ever copy it. There are refcounted members
 //       in there.
@@ -66,6 +134,8 @@ struct Q_QML_EXPORT Lookup {
         GetterEnumValue,
         GetterGeneric,
         GetterIndexed,
+        GetterMegamorphic,
+        GetterPolymorphic,
         GetterProto,
         GetterProtoAccessor,
         GetterProtoAccessorTwoClasses,
@@ -88,6 +158,7 @@ struct Q_QML_EXPORT Lookup {
         SetterArrayLength,
         SetterGeneric,
         SetterInsert,
+        SetterPolymorphic,
         SetterQObjectProperty,
         SetterQObjectPropertyFallback,
         SetterValueTypeProperty,
@@ -145,6 +216,16 @@ struct Q_QML_EXPORT Lookup {
             uint index;
             uint unused;
         } indexedLookup;
+        struct {
+            quintptr _unused;
+            quintptr _unused2;
+            PolymorphicLookup *shapes;
+        } polymorphicLookup;
+        struct {
+            quintptr _unused;
+            quintptr _unused2;
+            PolymorphicSetterLookup *shapes;
+        } polymorphicSetterLookup;
         struct {
             HeapObjectWrapper<Heap::InternalClass, 5> ic;
             HeapObjectWrapper<Heap::InternalClass, 6> qmlTypeIc; // only used when lookup goes through QQmlTypeWrapper
@@ -237,6 +318,8 @@ struct Q_QML_EXPORT Lookup {
     static ReturnedValue getterProtoAccessor(Lookup *lookup, ExecutionEngine *engine, const Value &object);
     static ReturnedValue getterProtoAccessorTwoClasses(Lookup *lookup, ExecutionEngine *engine, const Value &object);
     static ReturnedValue getterIndexed(Lookup *lookup, ExecutionEngine *engine, const Value &object);
+    static ReturnedValue getterPolymorphic(Lookup *lookup, ExecutionEngine *engine, const Value &object);
+    static ReturnedValue getterMegamorphic(Lookup *lookup, ExecutionEngine *engine, const Value &object);
     static ReturnedValue getterQObject(Lookup *lookup, ExecutionEngine *engine, const Value &object);
     static ReturnedValue getterQObjectMethod(Lookup *lookup, ExecutionEngine *engine, const Value &object);
     static ReturnedValue getterFallbackMethod(Lookup *lookup, ExecutionEngine *engine, const Value &object);
@@ -259,6 +342,7 @@ struct Q_QML_EXPORT Lookup {
     static bool setter0Inline(Lookup *lookup, ExecutionEngine *engine, Value &object, const Value &value);
     static bool setter0setter0(Lookup *lookup, ExecutionEngine *engine, Value &object, const Value &value);
     static bool setterInsert(Lookup *lookup, ExecutionEngine *engine, Value &object, const Value &value);
+    static bool setterPolymorphic(Lookup *lookup, ExecutionEngine *engine, Value &object, const Value &value);
     static bool setterQObject(Lookup *lookup, ExecutionEngine *engine, Value &object, const Value &value);
     static bool arrayLengthSetter(Lookup *lookup, ExecutionEngine *engine, Value &object, const Value &value);
 
@@ -267,6 +351,13 @@ struct Q_QML_EXPORT Lookup {
             markDef.h1->mark(stack);
         if (markDef.h2 && !(reinterpret_cast<quintptr>(markDef.h2) & 1))
             markDef.h2->mark(stack);
+        if (call == Call::SetterPolymorphic) {
+            const PolymorphicSetterLookup *shapes = polymorphicSetterLookup.shapes;
+            for (uint i = 0; i < shapes->size; ++i) {
+                if (Heap::InternalClass *newClass = shapes->entries[i].newClass)
+                    newClass->mark(stack);
+            }
+        }
     }
 
     ReturnedValue contextGetter(ExecutionEngine *engine, Value *base)
@@ -353,6 +444,10 @@ struct Q_QML_EXPORT Lookup {
             return getterGeneric(this, engine, object);
         case Call::GetterIndexed:
             return getterIndexed(this, engine, object);
+        case Call::GetterMegamorphic:
+            return getterMegamorphic(this, engine, object);
+        case Call::GetterPolymorphic:
+            return getterPolymorphic(this, engine, object);
         case Call::GetterProto:
             return getterProto(this, engine, object);
         case Call::GetterProtoAccessor:
@@ -404,6 +499,8 @@ struct Q_QML_EXPORT Lookup {
             return setterGeneric(this, engine, object, value);
         case Call::SetterInsert:
             return setterInsert(this, engine, object, value);
+        case Call::SetterPolymorphic:
+            return setterPolymorphic(this, engine, object, value);
         case Call::SetterQObjectProperty:
             return setterQObject(this, engine, object, value);
         case Call::SetterValueTypeProperty:
@@ -416,9 +513,18 @@ struct Q_QML_EXPORT Lookup {
         Q_UNREACHABLE_RETURN(Encode::undefined());
     }
 
+    // Also releases the other out-of-line data a lookup may hold.
     void releasePropertyCache()
     {
         switch (call) {
+        case Call::GetterPolymorphic:
+            delete polymorphicLookup.shapes;
+            polymorphicLookup.shapes = nullptr;
+            break;
+        case Call::SetterPolymorphic:
+            delete polymorphicSetterLookup.shapes;
+            polymorphicSetterLookup.shapes = nullptr;
+            break;
         case Call::ContextGetterContextObjectProperty:
         case Call::ContextGetterScopeObjectProperty:
         case Call::GetterQObjectProperty:
@@ -507,6 +507,8 @@ bool Object::internalPut(PropertyKey id, const Value &value, Value *receiver)
                     if (!ok)
                         return false;
                 } else {
+                    if (id.isArrayIndex())
+                        arrayData()->updateElementKind(value);
                     propertyIndex.set(scope.engine, value);
                 }
                 return true;
@@ -715,6 +717,7 @@ void Object::copyArrayData(Object *other)
             Heap::ArrayData *dd = d()->arrayData;
             dd->values.size = other->d()->arrayData->values.size;
             dd->offset = other->d()->arrayData->offset;
+            dd->elementKind = other->d()->arrayData->elementKind;
         }
         // ### need a write barrier
         memcpy(d()->arrayData->values.values, other->d()->arrayData->values.values, other->d()->arrayData->values.alloc*sizeof(Value));
@@ -827,6 +830,12 @@ bool Object::virtualResolveLookupSetter(Object *object, ExecutionEngine *engine,
         return false;
     }
 
+    if (object->internalClass()->isDictionary()) {
+        // Dictionary classes belong to a single object and grow in place. Don't hand them out.
+        lookup->call = Lookup::Call::SetterGeneric;
+        return true;
+    }
+
     if (object->internalClass() == c) {
         // ### setter in the prototype, should handle this
         lookup->call = Lookup::Call::SetterQObjectPropertyFallback;
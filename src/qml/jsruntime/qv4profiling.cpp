@@ -3,8 +3,11 @@
 
 #include "qv4profiling_p.h"
 #include <private/qv4mm_p.h>
+#include <private/qv4stackframe_p.h>
 #include <private/qv4string_p.h>
 
+#include <atomic>
+
 QT_BEGIN_NAMESPACE
 
 namespace QV4 {
@@ -44,6 +47,33 @@ void Profiler::stopProfiling()
     featuresEnabled = 0;
     reportData();
     m_sentLocations.clear();
+    m_allocationSiteIds.clear();
+}
+
+quintptr Profiler::allocationSite(MemoryType type)
+{
+    const CppStackFrame *frame = m_engine->currentStackFrame;
+    if (!frame || !frame->v4Function)
+        return 0;
+
+    const AllocationSite site = {frame->v4Function, frame->lineNumber(), type};
+    auto it = m_allocationSiteIds.constFind(site);
+    if (it != m_allocationSiteIds.constEnd())
+        return it->id;
+
+    // Function IDs are the addresses of the functions. Use odd numbers to avoid clashes.
+    // The IDs are shared by all engines and never reused, as the client keys the sites by ID
+    // alone and may still know the sites of earlier sessions.
+    Q_CONSTINIT static std::atomic<quintptr> nextAllocationSiteId = 1;
+    const quintptr id = nextAllocationSiteId.fetch_add(2, std::memory_order_relaxed);
+    AllocationSiteId &siteId = m_allocationSiteIds[site];
+    siteId.id = id;
+    siteId.marker.setFunction(site.function);
+    m_allocationSiteLocations.insert(id, FunctionLocation(
+                                             site.function->name()->toQString(),
+                                             site.function->executableCompilationUnit()->fileName(),
+                                             site.line, 0));
+    return id;
 }
 
 bool operator<(const FunctionCall &call1, const FunctionCall &call2)
@@ -73,9 +103,10 @@ void Profiler::reportData()
         }
     }
 
-    emit dataReady(locations, properties, m_memory_data);
+    emit dataReady(locations, properties, m_memory_data, m_allocationSiteLocations);
     m_data.clear();
     m_memory_data.clear();
+    m_allocationSiteLocations.clear();
 }
 
 void Profiler::startProfiling(quint64 features)
@@ -86,15 +117,15 @@ void Profiler::startProfiling(quint64 features)
             MemoryAllocationProperties heap = {timestamp,
                                                (qint64)m_engine->memoryManager->getAllocatedMem() -
                                                (qint64)m_engine->memoryManager->getLargeItemsMem(),
-                                               HeapPage};
+                                               HeapPage, 0};
             m_memory_data.append(heap);
             MemoryAllocationProperties smallP = {timestamp,
                                                 (qint64)m_engine->memoryManager->getUsedMem(),
-                                                SmallItem};
+                                                SmallItem, 0};
             m_memory_data.append(smallP);
             MemoryAllocationProperties large = {timestamp,
                                                 (qint64)m_engine->memoryManager->getLargeItemsMem(),
-                                                LargeItem};
+                                                LargeItem, 0};
             m_memory_data.append(large);
         }
 
@@ -98,6 +98,7 @@ struct MemoryAllocationProperties {
     qint64 timestamp;
     qint64 size;
     MemoryType type;
+    quintptr site; // allocation site, 0 if unknown
 };
 
 class FunctionCall {
@@ -205,12 +206,37 @@ public:
         Function *m_function;
     };
 
+    // A line in a function that allocates items of a specific memory type
+    struct AllocationSite {
+        Function *function;
+        int line;
+        MemoryType type;
+
+        friend bool operator==(const AllocationSite &a, const AllocationSite &b)
+        {
+            return a.function == b.function && a.line == b.line && a.type == b.type;
+        }
+
+        friend size_t qHash(const AllocationSite &site, size_t seed = 0)
+        {
+            return qHashMulti(seed, site.function, site.line, int(site.type));
+        }
+    };
+
+    struct AllocationSiteId {
+        quintptr id = 0;
+        SentMarker marker;
+    };
+
     Profiler(QV4::ExecutionEngine *engine);
 
     bool trackAlloc(size_t size, MemoryType type)
     {
         if (size) {
-            MemoryAllocationProperties allocation = {m_timer.nsecsElapsed(), (qint64)size, type};
+            MemoryAllocationProperties allocation = {
+                m_timer.nsecsElapsed(), (qint64)size, type,
+                type == HeapPage ? 0 : allocationSite(type)
+            };
             m_memory_data.append(allocation);
             return true;
         } else {
@@ -221,7 +247,7 @@ public:
     bool trackDealloc(size_t size, MemoryType type)
     {
         if (size) {
-            MemoryAllocationProperties allocation = {m_timer.nsecsElapsed(), -(qint64)size, type};
+            MemoryAllocationProperties allocation = {m_timer.nsecsElapsed(), -(qint64)size, type, 0};
             m_memory_data.append(allocation);
             return true;
         } else {
@@ -239,14 +265,19 @@ public:
 Q_SIGNALS:
     void dataReady(const QV4::Profiling::FunctionLocationHash &,
                    const QVector<QV4::Profiling::FunctionCallProperties> &,
-                   const QVector<QV4::Profiling::MemoryAllocationProperties> &);
+                   const QVector<QV4::Profiling::MemoryAllocationProperties> &,
+                   const QV4::Profiling::FunctionLocationHash &);
 
 private:
+    quintptr allocationSite(MemoryType type);
+
     QV4::ExecutionEngine *m_engine;
     QElapsedTimer m_timer;
     QVector<FunctionCall> m_data;
     QVector<MemoryAllocationProperties> m_memory_data;
     QHash<quintptr, SentMarker> m_sentLocations;
+    QHash<AllocationSite, AllocationSiteId> m_allocationSiteIds;
+    FunctionLocationHash m_allocationSiteLocations; // not reported yet
 
     friend class FunctionCallProfiler;
 };
@@ -287,6 +318,7 @@ Q_DECLARE_TYPEINFO(QV4::Profiling::FunctionCallProperties, Q_RELOCATABLE_TYPE);
 Q_DECLARE_TYPEINFO(QV4::Profiling::FunctionCall, Q_RELOCATABLE_TYPE);
 Q_DECLARE_TYPEINFO(QV4::Profiling::FunctionLocation, Q_RELOCATABLE_TYPE);
 Q_DECLARE_TYPEINFO(QV4::Profiling::Profiler::SentMarker, Q_RELOCATABLE_TYPE);
+Q_DECLARE_TYPEINFO(QV4::Profiling::Profiler::AllocationSiteId, Q_RELOCATABLE_TYPE);
 
 QT_END_NAMESPACE
 Q_DECLARE_METATYPE(QV4::Profiling::FunctionLocationHash)
@@ -5,13 +5,16 @@
 #include "qv4engine_p.h"
 #include "qv4scopedvalue_p.h"
 #include <private/qv4mm_p.h>
-#include <runtime/VM.h>
+
+#include <algorithm>
 
 using namespace QV4;
 
 #if ENABLE(YARR_JIT)
 static constexpr qsizetype LongStringJitThreshold = 1024;
 static constexpr int LongStringJitBoost = 3;
+
+thread_local quint8 JSC::VM::isExecutingInRegExpJIT = false;
 #endif
 
 static JSC::RegExpFlags jscFlags(quint8 flags)
@@ -62,7 +65,7 @@ uint RegExp::match(const QString &string, int start, uint *matchOffsets)
     };
 
     auto removeJitCode = [](Heap::RegExp *regexp) {
-        delete regexp->jitCode;
+        // Keep sharedJitCode, so that the interpreter runs are counted for the pattern.
         regexp->jitCode = nullptr;
         regexp->jitFailed = true;
     };
@@ -82,14 +85,8 @@ uint RegExp::match(const QString &string, int start, uint *matchOffsets)
         if (priv->internalClass->engine->canJIT(priv)) {
             removeByteCode(priv);
 
-            JSC::Yarr::ErrorCode error = JSC::Yarr::ErrorCode::NoError;
-            JSC::Yarr::YarrPattern yarrPattern(
-                    WTF::String(*priv->pattern), jscFlags(priv->flags), error);
-            if (!yarrPattern.m_containsBackreferences) {
-                priv->jitCode = new JSC::Yarr::YarrCodeBlock;
-                JSC::VM *vm = static_cast<JSC::VM *>(priv->internalClass->engine);
-                JSC::Yarr::jitCompile(yarrPattern, JSC::Yarr::Char16, vm, *priv->jitCode);
-            }
+            priv->sharedJitCode = RegExpCodeCache::instance()->acquire(RegExpCacheKey(priv));
+            priv->jitCode = &priv->sharedJitCode->code;
 
             if (!priv->hasValidJITCode()) {
                 removeJitCode(priv);
@@ -108,7 +105,9 @@ uint RegExp::match(const QString &string, int start, uint *matchOffsets)
 #if ENABLE(YARR_JIT)
     if (priv->hasValidJITCode()) {
         static const uint offsetJITFail = std::numeric_limits<unsigned>::max() - 1;
+        static const uint offsetJITInterpret = std::numeric_limits<unsigned>::max() - 2;
         uint ret = JSC::Yarr::offsetNoMatch;
+        JSC::VM::isExecutingInRegExpJIT = true;
 #if ENABLE(YARR_JIT_ALL_PARENS_EXPRESSIONS)
         char buffer[8192];
         ret = uint(priv->jitCode->execute(s.characters16(), start, s.size(),
@@ -117,14 +116,22 @@ uint RegExp::match(const QString &string, int start, uint *matchOffsets)
         ret = uint(priv->jitCode->execute(s.characters16(), start, s.length(),
                                           (int*)matchOffsets).start);
 #endif
-        if (ret != offsetJITFail)
+        JSC::VM::isExecutingInRegExpJIT = false;
+        if (ret != offsetJITFail && ret != offsetJITInterpret)
             return ret;
 
-        removeJitCode(priv);
-        // JIT failed. We need byteCode to run the interpreter.
-        Q_ASSERT(!priv->byteCode);
-        regenerateByteCode(priv);
+        // Only this match needs the interpreter if the code can't handle this subject. Keep
+        // the code for further matches then.
+        if (ret == offsetJITFail)
+            removeJitCode(priv);
+
+        // We need byteCode to run the interpreter.
+        if (!priv->byteCode)
+            regenerateByteCode(priv);
     }
+
+    if (priv->sharedJitCode)
+        priv->sharedJitCode->interpreterRuns.fetchAndAddRelaxed(1);
 #endif // ENABLE(YARR_JIT)
 
     return JSC::Yarr::interpret(byteCode(), s.characters16(), string.size(), start, matchOffsets);
@@ -230,9 +237,150 @@ void Heap::RegExp::destroy()
         cache->remove(key);
     }
 #if ENABLE(YARR_JIT)
-    delete jitCode;
+    RegExpCodeCache::release(sharedJitCode);
 #endif
     delete byteCode;
     delete pattern;
     Base::destroy();
 }
+
+#if ENABLE(YARR_JIT)
+RegExpCodeCache::RegExpCodeCache()
+{
+    m_vm.regExpAllocator = &m_allocator;
+
+    bool ok = false;
+    m_capacity = qEnvironmentVariableIntValue("QV4_REGEXP_CACHE_SIZE", &ok);
+    if (!ok || m_capacity < 0)
+        m_capacity = 256;
+}
+
+RegExpCodeCache *RegExpCodeCache::instance()
+{
+    // Never destroyed. Engines deleted from static destructors may still release code.
+    static RegExpCodeCache *cache = new RegExpCodeCache;
+    return cache;
+}
+
+SharedRegExpCode *RegExpCodeCache::acquire(const RegExpCacheKey &key)
+{
+    QMutexLocker locker(&m_mutex);
+    if (SharedRegExpCode *code = m_entries.value(key)) {
+        ++m_statistics.hits;
+        code->lastUse = ++m_lastUse;
+        code->ref.ref();
+        return code;
+    }
+    ++m_statistics.misses;
+    locker.unlock();
+
+    // Compile without holding the lock, so that other patterns can be looked up meanwhile.
+    // Code that fails to compile is cached, too. Then nobody tries again.
+    SharedRegExpCode *code = new SharedRegExpCode;
+    JSC::Yarr::ErrorCode error = JSC::Yarr::ErrorCode::NoError;
+    JSC::Yarr::YarrPattern yarrPattern(WTF::String(key.pattern), jscFlags(key.flags), error);
+    Q_ASSERT(error == JSC::Yarr::ErrorCode::NoError);
+    JSC::Yarr::jitCompile(yarrPattern, JSC::Yarr::Char16, &m_vm, code->code);
+
+    locker.relock();
+    if (SharedRegExpCode *other = m_entries.value(key)) {
+        // Another thread was faster.
+        other->lastUse = ++m_lastUse;
+        other->ref.ref();
+        locker.unlock();
+        release(code);
+        return other;
+    }
+
+    code->lastUse = ++m_lastUse;
+    code->ref.ref(); // One reference for the cache, one for the caller.
+    m_entries.insert(key, code);
+    evict();
+    return code;
+}
+
+void RegExpCodeCache::release(SharedRegExpCode *code)
+{
+    if (code && !code->ref.deref())
+        delete code;
+}
+
+void RegExpCodeCache::evict()
+{
+    while (m_entries.size() > m_capacity) {
+        auto oldest = m_entries.begin();
+        for (auto it = m_entries.begin(), end = m_entries.end(); it != end; ++it) {
+            if (it.value()->lastUse < oldest.value()->lastUse)
+                oldest = it;
+        }
+        release(oldest.value());
+        m_entries.erase(oldest);
+        ++m_statistics.evictions;
+    }
+}
+
+RegExpCodeCache::Statistics RegExpCodeCache::statistics() const
+{
+    QMutexLocker locker(&m_mutex);
+    Statistics result = m_statistics;
+    result.entries = m_entries.size();
+    return result;
+}
+
+static const char *fallbackReason(JSC::Yarr::YarrCodeBlock &code)
+{
+    using JSC::Yarr::JITFailureReason;
+    const std::optional<JITFailureReason> reason = code.failureReason();
+    if (!reason)
+        return "aborted while matching";
+
+    switch (*reason) {
+    case JITFailureReason::DecodeSurrogatePair:
+        return "surrogate pairs";
+    case JITFailureReason::BackReference:
+        return "back reference";
+    case JITFailureReason::ForwardReference:
+        return "forward reference";
+    case JITFailureReason::VariableCountedParenthesisWithNonZeroMinimum:
+        return "variable counted parentheses with non-zero minimum";
+    case JITFailureReason::ParenthesizedSubpattern:
+        return "parenthesized subpattern";
+    case JITFailureReason::FixedCountParenthesizedSubpattern:
+        return "fixed count parenthesized subpattern";
+    case JITFailureReason::ExecutableMemoryAllocationFailure:
+        return "out of executable memory";
+    }
+    Q_UNREACHABLE_RETURN("unknown");
+}
+
+QList<RegExpCodeCache::InterpreterFallback> RegExpCodeCache::interpreterFallbacks() const
+{
+    QList<InterpreterFallback> result;
+    QMutexLocker locker(&m_mutex);
+    for (auto it = m_entries.cbegin(), end = m_entries.cend(); it != end; ++it) {
+        SharedRegExpCode *code = it.value();
+        if (const quint32 count = code->interpreterRuns.loadRelaxed())
+            result.append({ it.key().pattern, it.key().flags, count, fallbackReason(code->code) });
+    }
+    locker.unlock();
+
+    std::sort(result.begin(), result.end(),
+              [](const InterpreterFallback &a, const InterpreterFallback &b) {
+        return a.count > b.count;
+    });
+    return result;
+}
+
+qsizetype RegExpCodeCache::capacity() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_capacity;
+}
+
+void RegExpCodeCache::setCapacity(qsizetype capacity)
+{
+    QMutexLocker locker(&m_mutex);
+    m_capacity = qMax(capacity, qsizetype(0));
+    evict();
+}
+#endif // ENABLE(YARR_JIT)
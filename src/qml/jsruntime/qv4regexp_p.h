@@ -24,15 +24,21 @@
 #include <private/qv4compileddata_p.h>
 #include <private/qv4managed_p.h>
 
+#include <QtCore/qatomic.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qmutex.h>
 #include <QtCore/qstring.h>
 #include <QtCore/qvector.h>
 
+#include <runtime/VM.h>
+
 QT_BEGIN_NAMESPACE
 
 namespace QV4 {
 
 struct ExecutionEngine;
 struct RegExpCacheKey;
+struct SharedRegExpCode;
 
 namespace Heap {
 
@@ -44,6 +50,7 @@ struct RegExp : Base {
     JSC::Yarr::BytecodePattern *byteCode;
 #if ENABLE(YARR_JIT)
     JSC::Yarr::YarrCodeBlock *jitCode;
+    SharedRegExpCode *sharedJitCode; // owns jitCode, kept if the JIT fails
 #endif
     bool hasValidJITCode() const {
 #if ENABLE(YARR_JIT)
@@ -142,6 +149,68 @@ public:
     ~RegExpCache();
 };
 
+#if ENABLE(YARR_JIT)
+struct SharedRegExpCode
+{
+    JSC::Yarr::YarrCodeBlock code;
+    QAtomicInt ref = 1;
+    QAtomicInteger<quint32> interpreterRuns = 0; // Matches run by the interpreter instead
+    quint64 lastUse = 0;
+};
+
+/*
+    Process-wide cache of JIT-compiled regular expressions. The generated code doesn't refer to
+    the engine it was compiled for, so all engines, on all threads, share it. The cache holds the
+    most recently used patterns only, up to a fixed number. Evicted code stays alive as long as
+    a RegExp still uses it.
+*/
+class Q_QML_EXPORT RegExpCodeCache
+{
+    Q_DISABLE_COPY_MOVE(RegExpCodeCache)
+public:
+    struct Statistics
+    {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 evictions = 0;
+        qsizetype entries = 0;
+    };
+
+    struct InterpreterFallback
+    {
+        QString pattern;
+        quint8 flags;
+        quint32 count;
+        const char *reason;
+    };
+
+    static RegExpCodeCache *instance();
+
+    // Returns code for the pattern, compiling it on a miss. The caller owns a reference to it.
+    SharedRegExpCode *acquire(const RegExpCacheKey &key);
+    static void release(SharedRegExpCode *code);
+
+    Statistics statistics() const;
+    QList<InterpreterFallback> interpreterFallbacks() const;
+    qsizetype capacity() const;
+    void setCapacity(qsizetype capacity);
+
+private:
+    RegExpCodeCache();
+    ~RegExpCodeCache() = delete;
+
+    void evict();
+
+    mutable QMutex m_mutex;
+    QHash<RegExpCacheKey, SharedRegExpCode *> m_entries;
+    ExecutableAllocator m_allocator;
+    JSC::VM m_vm;
+    Statistics m_statistics;
+    quint64 m_lastUse = 0;
+    qsizetype m_capacity;
+};
+#endif
+
 
 
 }
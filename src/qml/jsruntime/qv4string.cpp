@@ -59,10 +59,17 @@ void Heap::String::init(const QString &t)
     subtype = String::StringType_Unknown;
 }
 
+void Heap::String::init(Latin1Text text)
+{
+    StringOrSymbol::init(std::move(text));
+    subtype = String::StringType_Unknown;
+}
+
 void Heap::ComplexString::init(String *l, String *r)
 {
     StringOrSymbol::init();
     subtype = String::StringType_AddedString;
+    accessCost = 0;
 
     left = l;
     right = r;
@@ -87,6 +94,7 @@ void Heap::ComplexString::init(Heap::String *ref, int from, int len)
     StringOrSymbol::init();
 
     subtype = String::StringType_SubString;
+    accessCost = 0;
 
     left = ref;
     this->from = from;
@@ -95,14 +103,97 @@ void Heap::ComplexString::init(Heap::String *ref, int from, int len)
 
 void Heap::StringOrSymbol::destroy()
 {
-    if (subtype < Heap::String::StringType_AddedString) {
-        internalClass->engine->memoryManager->changeUnmanagedHeapSizeUsage(
-                    qptrdiff(-text()->size) * qptrdiff(sizeof(QChar)));
-    }
-    text().~QStringPrivate();
+    internalClass->engine->memoryManager->changeUnmanagedHeapSizeUsage(-releaseText());
     Base::destroy();
 }
 
+/*!
+    \internal
+    Releases the text of the string, and returns the number of bytes it was holding
+    onto on the unmanaged heap. This doesn't touch the engine, and can be used when
+    sweeping the heap on a background thread.
+*/
+qptrdiff Heap::StringOrSymbol::releaseText()
+{
+    if (textIsLatin1) {
+        const qptrdiff unmanagedSize = latin1Text().size;
+        latin1Text().~Latin1Text();
+        textIsLatin1 = false;
+        return unmanagedSize;
+    }
+
+    const qptrdiff unmanagedSize = subtype < Heap::String::StringType_AddedString
+            ? qptrdiff(utf16Text()->size) * qptrdiff(sizeof(QChar))
+            : 0;
+    utf16Text().~QStringPrivate();
+    return unmanagedSize;
+}
+
+QStringPrivate Heap::StringOrSymbol::widenedText() const
+{
+    return internalClass->engine->identifierTable->widenedText(this);
+}
+
+bool Heap::StringOrSymbol::textEquals(QStringView other) const
+{
+    Q_ASSERT(subtype < StringType_AddedString);
+    if (textIsLatin1) {
+        const Latin1Text &latin1 = latin1Text();
+        return QLatin1StringView(latin1.data(), latin1.size) == other;
+    }
+    const QStringPrivate &utf16 = utf16Text();
+    return QStringView(utf16.data(), utf16.size) == other;
+}
+
+bool Heap::StringOrSymbol::textEquals(QLatin1StringView other) const
+{
+    Q_ASSERT(subtype < StringType_AddedString);
+    if (textIsLatin1) {
+        const Latin1Text &latin1 = latin1Text();
+        return QLatin1StringView(latin1.data(), latin1.size) == other;
+    }
+    const QStringPrivate &utf16 = utf16Text();
+    return QStringView(utf16.data(), utf16.size) == other;
+}
+
+bool Heap::StringOrSymbol::textEquals(const StringOrSymbol *other) const
+{
+    Q_ASSERT(other->subtype < StringType_AddedString);
+    if (other->textIsLatin1) {
+        const Latin1Text &latin1 = other->latin1Text();
+        return textEquals(QLatin1StringView(latin1.data(), latin1.size));
+    }
+    const QStringPrivate &utf16 = other->utf16Text();
+    return textEquals(QStringView(utf16.data(), utf16.size));
+}
+
+/*!
+    \internal
+    Returns a copy of the string with its text in the compact Latin-1 form, or \c nullptr if
+    that's not possible. The string itself is left alone, as its text may be in use. Text that is
+    shared with a QString elsewhere isn't copied either, as we would then hold two copies of it.
+*/
+Heap::String *Heap::String::compactCopy() const
+{
+    Q_ASSERT(subtype < StringType_AddedString);
+    if (textIsLatin1)
+        return nullptr;
+
+    const QStringPrivate &utf16 = utf16Text();
+    if (!utf16.size || utf16.isShared())
+        return nullptr;
+    const QStringView view(utf16.data(), utf16.size);
+    if (!QtPrivate::isLatin1(view))
+        return nullptr;
+
+    QByteArray latin1 = view.toLatin1();
+    Heap::String *copy = internalClass->engine->memoryManager->allocWithStringData<QV4::String>(
+            latin1.size(), std::move(latin1.data_ptr()));
+    copy->stringHash = stringHash;
+    copy->subtype = subtype;
+    return copy;
+}
+
 uint String::toUInt(bool *ok) const
 {
     *ok = true;
@@ -137,13 +228,15 @@ void Heap::String::simplifyString() const
     QString result(l, Qt::Uninitialized);
     QChar *ch = const_cast<QChar *>(result.constData());
     append(this, ch);
-    text() = result.data_ptr();
+    utf16Text() = result.data_ptr();
     const ComplexString *cs = static_cast<const ComplexString *>(this);
     identifier = PropertyKey::invalid();
     cs->left = cs->right = nullptr;
 
-    internalClass->engine->memoryManager->changeUnmanagedHeapSizeUsage(
-                qptrdiff(text().size) * qptrdiff(sizeof(QChar)));
+    MemoryManager *mm = internalClass->engine->memoryManager;
+    mm->changeUnmanagedHeapSizeUsage(qptrdiff(utf16Text().size) * qptrdiff(sizeof(QChar)));
+    ++mm->statistics.ropeFlattenings;
+    mm->statistics.flattenedCharacters += l;
     subtype = StringType_Unknown;
 }
 
@@ -165,47 +258,159 @@ bool Heap::String::startsWithUpper() const
         offset = cs->from;
     }
     Q_ASSERT(str->subtype < Heap::String::StringType_Complex);
-    return str->text().size > offset && QChar::isUpper(str->text().data()[offset]);
+    return str->textSize() > offset && str->textAt(offset).isUpper();
 }
 
-void Heap::String::append(const String *data, QChar *ch)
+/*
+    Calls visit() for the flat pieces making up the characters [from, from + len) of the given
+    string, in order, until it returns false. Parts of the string outside of the range are not
+    visited, and neither the string nor any of its parts is flattened. Returns the number of
+    nodes that were visited.
+*/
+template<typename Visitor>
+static int visitChunks(const Heap::String *string, int from, int len, Visitor &&visit)
 {
-    // in-order visitation with explicit stack
-    // where leaf nodes are "real" strings that get appended to ch
+    struct Range {
+        const Heap::String *string;
+        int from;
+        int len;
+    };
 
-    enum StatusTag : bool { NotVisited, Visited };
-    using Pointer = QTaggedPointer<const String, StatusTag>;
-
-    std::vector<Pointer> worklist;
+    std::vector<Range> worklist;
     worklist.reserve(32);
-    worklist.push_back(Pointer(data));
+    worklist.push_back({ string, from, len });
 
+    int visited = 0;
     while (!worklist.empty()) {
-        Pointer item = worklist.back();
-        if (item.tag() == Visited) {
-            Q_ASSERT(item->subtype == StringType_AddedString);
-            const ComplexString *cs = static_cast<const ComplexString *>(item.data());
-            worklist.pop_back();
-            worklist.push_back(Pointer(cs->right));
-            continue;
-        }
-
-        if (item->subtype == StringType_AddedString) {
-            // we need to keep the node in the worklist, as we still need to handle "right"
-            worklist.back().setTag(Visited);
-            const ComplexString *cs = static_cast<const ComplexString *>(item.data());
-            worklist.push_back(Pointer(cs->left));
-        } else if (item->subtype == StringType_SubString) {
-            worklist.pop_back();
-            const ComplexString *cs = static_cast<const ComplexString *>(item.data());
-            memcpy(ch, cs->left->toQString().constData() + cs->from, cs->len*sizeof(QChar));
-            ch += cs->len;
+        const Range item = worklist.back();
+        worklist.pop_back();
+        ++visited;
+        Q_ASSERT(item.from >= 0 && item.len > 0 && item.from + item.len <= item.string->length());
+
+        if (item.string->subtype == Heap::String::StringType_SubString) {
+            const auto *cs = static_cast<const Heap::ComplexString *>(item.string);
+            worklist.push_back({ cs->left, cs->from + item.from, item.len });
+        } else if (item.string->subtype == Heap::String::StringType_AddedString) {
+            const auto *cs = static_cast<const Heap::ComplexString *>(item.string);
+            const int leftLength = cs->left->length();
+            const int end = item.from + item.len;
+            // The left part needs to be visited first, so push it last.
+            if (end > leftLength) {
+                const int rightFrom = qMax(item.from - leftLength, 0);
+                worklist.push_back({ cs->right, rightFrom, end - leftLength - rightFrom });
+            }
+            if (item.from < leftLength)
+                worklist.push_back({ cs->left, item.from, qMin(end, leftLength) - item.from });
         } else {
-            worklist.pop_back();
-            memcpy(static_cast<void *>(ch), item->text().data(), item->text().size * sizeof(QChar));
-            ch += item->text().size;
+            // Compact text is widened into a temporary.
+            const QStringPrivate text = item.string->text();
+            if (!visit(QStringView(text.data() + item.from, item.len)))
+                break;
         }
     }
+    return visited;
+}
+
+void Heap::String::append(const String *data, QChar *ch)
+{
+    const int length = data->length();
+    if (!length)
+        return;
+    visitChunks(data, 0, length, [&ch](QStringView chunk) {
+        memcpy(static_cast<void *>(ch), chunk.data(), chunk.size() * sizeof(QChar));
+        ch += chunk.size();
+        return true;
+    });
+}
+
+/*
+    Decides whether a rope should still be read in place. Reading it in place saves the copy
+    and the allocation for flattening it, but it is slower than reading a flat string. Once the
+    work spent on it adds up to the cost of flattening it, it is flattened.
+*/
+bool Heap::String::keepAsRope() const
+{
+    Q_ASSERT(subtype >= StringType_Complex);
+    const ComplexString *cs = static_cast<const ComplexString *>(this);
+    if (cs->accessCost < cs->len)
+        return true;
+    simplifyString();
+    return false;
+}
+
+void Heap::String::chargeRopeAccess(int cost) const
+{
+    Q_ASSERT(subtype >= StringType_Complex);
+    const ComplexString *cs = static_cast<const ComplexString *>(this);
+    cs->accessCost = int(qMin(qint64(cs->accessCost) + cost, qint64(cs->len)));
+    ++internalClass->engine->memoryManager->statistics.ropeAccesses;
+}
+
+char16_t Heap::String::charCodeAt(int index) const
+{
+    Q_ASSERT(index >= 0 && index < length());
+    if (subtype >= StringType_Complex && keepAsRope()) {
+        char16_t result = 0;
+        const int visited = visitChunks(this, index, 1, [&result](QStringView chunk) {
+            result = chunk.front().unicode();
+            return false;
+        });
+        chargeRopeAccess(visited);
+        return result;
+    }
+    return textAt(index).unicode();
+}
+
+int Heap::String::indexOf(QStringView needle, int from) const
+{
+    const int length = this->length();
+    Q_ASSERT(from >= 0 && from <= length);
+    if (needle.isEmpty())
+        return from;
+    if (needle.size() > length - from)
+        return -1;
+    if (subtype < StringType_Complex || !keepAsRope()) {
+        const QString flat = toQString();
+        return int(QStringView(flat).indexOf(needle, from));
+    }
+
+    // Matches that span the border between two chunks are searched for in a window made of
+    // the last needle.size() - 1 characters before the border and the same number after it.
+    const int overlap = int(needle.size()) - 1;
+    QString window;
+    int position = from;
+    int found = -1;
+    int scanned = 0;
+    const int visited = visitChunks(this, from, length - from, [&](QStringView chunk) {
+        scanned += int(chunk.size());
+        if (!window.isEmpty()) {
+            const qsizetype previous = window.size();
+            window.append(chunk.first(qMin(qsizetype(overlap), chunk.size())));
+            const qsizetype index = QStringView(window).indexOf(needle);
+            if (index >= 0) {
+                found = position - int(previous) + int(index);
+                return false;
+            }
+            window.truncate(previous);
+        }
+        const qsizetype index = chunk.indexOf(needle);
+        if (index >= 0) {
+            found = position + int(index);
+            return false;
+        }
+        if (overlap) {
+            if (chunk.size() >= overlap) {
+                window = chunk.last(overlap).toString();
+            } else {
+                window.remove(0, qMax(qsizetype(0), window.size() + chunk.size() - overlap));
+                window.append(chunk);
+            }
+        }
+        position += int(chunk.size());
+        return true;
+    });
+    chargeRopeAccess(visited + scanned);
+    return found;
 }
 
 void Heap::StringOrSymbol::createHashValue() const
@@ -215,8 +420,13 @@ void Heap::StringOrSymbol::createHashValue() const
         static_cast<const Heap::String *>(this)->simplifyString();
     }
     Q_ASSERT(subtype < StringType_AddedString);
-    const QChar *ch = reinterpret_cast<const QChar *>(text().data());
-    const QChar *end = ch + text().size;
+    if (textIsLatin1) {
+        const char *ch = latin1Text().data();
+        stringHash = QV4::String::calculateHashValue(ch, ch + latin1Text().size, &subtype);
+        return;
+    }
+    const QChar *ch = reinterpret_cast<const QChar *>(utf16Text().data());
+    const QChar *end = ch + utf16Text().size;
     stringHash = QV4::String::calculateHashValue(ch, end, &subtype);
 }
 
@@ -18,6 +18,7 @@
 #include "qv4managed_p.h"
 #include <QtCore/private/qnumeric_p.h>
 #include "qv4enginebase_p.h"
+#include <QtCore/qbytearray.h>
 #include <private/qv4stringtoarrayindex_p.h>
 
 QT_BEGIN_NAMESPACE
@@ -41,30 +42,76 @@ struct Q_QML_EXPORT StringOrSymbol : Base
         StringType_Complex = StringType_AddedString
     };
 
+    using Latin1Text = QByteArray::DataPointer;
+    static_assert(sizeof(Latin1Text) == sizeof(QStringPrivate)
+                  && alignof(Latin1Text) == alignof(QStringPrivate));
+
     void init() {
         Base::init();
         new (&textStorage) QStringPrivate;
+        textIsLatin1 = false;
     }
 
     void init(QStringPrivate text)
     {
         Base::init();
         new (&textStorage) QStringPrivate(std::move(text));
+        textIsLatin1 = false;
+    }
+
+    void init(Latin1Text text)
+    {
+        Base::init();
+        new (&textStorage) Latin1Text(std::move(text));
+        textIsLatin1 = true;
     }
 
+    // Holds either a QStringPrivate or, if textIsLatin1 is set, a Latin1Text. Interned strings
+    // that only contain Latin-1 characters are stored in the latter, compact form. text()
+    // returns a widened copy of those, which the identifier table caches until the string dies.
+    // The strings themselves keep their compact form.
     mutable struct { alignas(QStringPrivate) unsigned char data[sizeof(QStringPrivate)]; } textStorage;
     mutable PropertyKey identifier;
     mutable uint subtype;
     mutable uint stringHash;
+    mutable bool textIsLatin1;
 
     static void markObjects(Heap::Base *that, MarkStack *markStack);
     void destroy();
+    qptrdiff releaseText();
 
-    QStringPrivate &text() const { return *reinterpret_cast<QStringPrivate *>(&textStorage); }
+    QStringPrivate text() const
+    {
+        if (Q_UNLIKELY(textIsLatin1))
+            return widenedText();
+        return utf16Text();
+    }
+    QStringPrivate &utf16Text() const
+    {
+        Q_ASSERT(!textIsLatin1);
+        return *reinterpret_cast<QStringPrivate *>(&textStorage);
+    }
+    Latin1Text &latin1Text() const
+    {
+        Q_ASSERT(textIsLatin1);
+        return *reinterpret_cast<Latin1Text *>(&textStorage);
+    }
+    qsizetype textSize() const { return textIsLatin1 ? latin1Text().size : utf16Text().size; }
+    QChar textAt(qsizetype index) const
+    {
+        return textIsLatin1 ? QChar(uchar(latin1Text().data()[index])) : utf16Text().data()[index];
+    }
+    std::size_t textBytes() const
+    {
+        return std::size_t(textSize()) * (textIsLatin1 ? sizeof(char) : sizeof(QChar));
+    }
+
+    bool textEquals(QStringView other) const;
+    bool textEquals(QLatin1StringView other) const;
+    bool textEquals(const StringOrSymbol *other) const;
 
     inline QString toQString() const {
-        QStringPrivate dd = text();
-        return QString(std::move(dd));
+        return QString(text());
     }
     void createHashValue() const;
     inline unsigned hashValue() const {
@@ -74,6 +121,9 @@ struct Q_QML_EXPORT StringOrSymbol : Base
 
         return stringHash;
     }
+
+private:
+    QStringPrivate widenedText() const;
 };
 
 struct Q_QML_EXPORT String : StringOrSymbol {
@@ -84,10 +134,12 @@ struct Q_QML_EXPORT String : StringOrSymbol {
     }
 
     void init(const QString &text);
+    void init(Latin1Text text);
     void simplifyString() const;
+    String *compactCopy() const;
     int length() const;
     std::size_t retainedTextSize() const {
-        return subtype >= StringType_Complex ? 0 : (std::size_t(text().size) * sizeof(QChar));
+        return subtype >= StringType_Complex ? 0 : textBytes();
     }
     inline QString toQString() const {
         if (subtype >= StringType_Complex)
@@ -105,12 +157,20 @@ struct Q_QML_EXPORT String : StringOrSymbol {
         if (subtype == Heap::String::StringType_ArrayIndex && other->subtype == Heap::String::StringType_ArrayIndex)
             return true;
 
-        return toQString() == other->toQString();
+        return textEquals(other);
     }
 
     bool startsWithUpper() const;
 
+    // Rope-aware accessors. These read the parts of an added string or substring in place,
+    // until the string has been accessed often enough that flattening it once would have
+    // been cheaper. Then they flatten it.
+    char16_t charCodeAt(int index) const;
+    int indexOf(QStringView needle, int from) const;
+
 private:
+    bool keepAsRope() const;
+    void chargeRopeAccess(int cost) const;
     static void append(const String *data, QChar *ch);
 };
 Q_STATIC_ASSERT(std::is_trivial_v<String>);
@@ -125,13 +185,15 @@ struct ComplexString : String {
         int from;
     };
     int len;
+    // Work spent on reading this string in place, in characters or rope nodes visited.
+    mutable int accessCost;
 };
 Q_STATIC_ASSERT(std::is_trivial_v<ComplexString>);
 
 inline
 int String::length() const {
     // TODO: ensure that our strings never actually grow larger than INT_MAX
-    return subtype < StringType_AddedString ? int(text().size) : static_cast<const ComplexString *>(this)->len;
+    return subtype < StringType_AddedString ? int(textSize()) : static_cast<const ComplexString *>(this)->len;
 }
 
 }
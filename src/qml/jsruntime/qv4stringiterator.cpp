@@ -34,8 +34,7 @@ ReturnedValue StringIteratorPrototype::method_next(const FunctionObject *b, cons
 
     quint32 index = thisObject->d()->nextIndex;
 
-    QString str = s->toQString();
-    quint32 len = str.size();
+    quint32 len = s->d()->length();
 
     if (index >= len) {
         thisObject->d()->iteratedString.set(scope.engine, nullptr);
@@ -43,17 +42,17 @@ ReturnedValue StringIteratorPrototype::method_next(const FunctionObject *b, cons
         return IteratorPrototype::createIterResultObject(scope.engine, undefined, true);
     }
 
-    QChar ch = str.at(index);
+    QChar chars[2] = { QChar(s->d()->charCodeAt(index)), QChar() };
     int num = 1;
-    if (ch.unicode() >= 0xd800 && ch.unicode() <= 0xdbff && index + 1 != len) {
-        ch = str.at(index + 1);
-        if (ch.unicode() >= 0xdc00 && ch.unicode() <= 0xdfff)
+    if (chars[0].isHighSurrogate() && index + 1 != len) {
+        chars[1] = QChar(s->d()->charCodeAt(index + 1));
+        if (chars[1].isLowSurrogate())
             num = 2;
     }
 
     thisObject->d()->nextIndex += num;
 
-    ScopedString resultString(scope, scope.engine->newString(s->toQString().mid(index, num)));
+    ScopedString resultString(scope, scope.engine->newString(QString(chars, num)));
     return IteratorPrototype::createIterResultObject(scope.engine, resultString, false);
 }
 
@@ -302,6 +302,16 @@ static Heap::String *thisAsString(ExecutionEngine *v4, const QV4::Value *thisObj
     return thisObject->toString(v4);
 }
 
+// Like thisAsString(), but throws a TypeError for undefined and null.
+static Heap::String *getThisHeapString(ExecutionEngine *v4, const QV4::Value *thisObject)
+{
+    if (thisObject->isUndefined() || thisObject->isNull()) {
+        v4->throwTypeError();
+        return v4->id_empty()->d();
+    }
+    return thisAsString(v4, thisObject);
+}
+
 static QString getThisString(ExecutionEngine *v4, const QV4::Value *thisObject)
 {
     if (String *s = thisObject->stringValue())
@@ -330,7 +340,8 @@ ReturnedValue StringPrototype::method_toString(const FunctionObject *b, const Va
 ReturnedValue StringPrototype::method_charAt(const FunctionObject *b, const Value *thisObject, const Value *argv, int argc)
 {
     ExecutionEngine *v4 = b->engine();
-    const QString str = getThisString(v4, thisObject);
+    Scope scope(v4);
+    ScopedString str(scope, getThisHeapString(v4, thisObject));
     if (v4->hasException)
         return QV4::Encode::undefined();
 
@@ -339,8 +350,8 @@ ReturnedValue StringPrototype::method_charAt(const FunctionObject *b, const Valu
         pos = argv[0].toInteger();
 
     QString result;
-    if (pos >= 0 && pos < str.size())
-        result += str.at(pos);
+    if (pos >= 0 && pos < str->d()->length())
+        result += QChar(str->d()->charCodeAt(int(pos)));
 
     return Encode(v4->newString(result));
 }
@@ -348,7 +359,8 @@ ReturnedValue StringPrototype::method_charAt(const FunctionObject *b, const Valu
 ReturnedValue StringPrototype::method_charCodeAt(const FunctionObject *b, const Value *thisObject, const Value *argv, int argc)
 {
     ExecutionEngine *v4 = b->engine();
-    const QString str = getThisString(v4, thisObject);
+    Scope scope(v4);
+    ScopedString str(scope, getThisHeapString(v4, thisObject));
     if (v4->hasException)
         return QV4::Encode::undefined();
 
@@ -357,8 +369,8 @@ ReturnedValue StringPrototype::method_charCodeAt(const FunctionObject *b, const
         pos = argv[0].toInteger();
 
 
-    if (pos >= 0 && pos < str.size())
-        RETURN_RESULT(Encode(str.at(pos).unicode()));
+    if (pos >= 0 && pos < str->d()->length())
+        RETURN_RESULT(Encode(str->d()->charCodeAt(int(pos))));
 
     return Encode(qt_qnan());
 }
@@ -366,7 +378,8 @@ ReturnedValue StringPrototype::method_charCodeAt(const FunctionObject *b, const
 ReturnedValue StringPrototype::method_codePointAt(const FunctionObject *f, const Value *thisObject, const Value *argv, int argc)
 {
     ExecutionEngine *v4 = f->engine();
-    QString value = getThisString(v4, thisObject);
+    Scope scope(v4);
+    ScopedString value(scope, getThisHeapString(v4, thisObject));
     if (v4->hasException)
         return QV4::Encode::undefined();
 
@@ -374,12 +387,13 @@ ReturnedValue StringPrototype::method_codePointAt(const FunctionObject *f, const
     if (v4->hasException)
         return QV4::Encode::undefined();
 
-    if (index < 0 || index >= value.size())
+    const int length = value->d()->length();
+    if (index < 0 || index >= length)
         return Encode::undefined();
 
-    uint first = value.at(index).unicode();
-    if (QChar::isHighSurrogate(first) && index + 1 < value.size()) {
-        uint second = value.at(index + 1).unicode();
+    uint first = value->d()->charCodeAt(int(index));
+    if (QChar::isHighSurrogate(first) && index + 1 < length) {
+        uint second = value->d()->charCodeAt(int(index) + 1);
         if (QChar::isLowSurrogate(second))
             return Encode(QChar::surrogateToUcs4(first, second));
     }
@@ -434,7 +448,8 @@ ReturnedValue StringPrototype::method_endsWith(const FunctionObject *b, const Va
 ReturnedValue StringPrototype::method_indexOf(const FunctionObject *b, const Value *thisObject, const Value *argv, int argc)
 {
     ExecutionEngine *v4 = b->engine();
-    const QString value = getThisString(v4, thisObject);
+    Scope scope(v4);
+    ScopedString value(scope, getThisHeapString(v4, thisObject));
     if (v4->hasException)
         return QV4::Encode::undefined();
 
@@ -447,8 +462,9 @@ ReturnedValue StringPrototype::method_indexOf(const FunctionObject *b, const Val
         pos = argv[1].toInteger();
 
     int index = -1;
-    if (!value.isEmpty())
-        index = value.indexOf(searchString, qMin(qMax(pos, 0.0), double(value.size())));
+    const int length = value->d()->length();
+    if (length)
+        index = value->d()->indexOf(searchString, int(qMin(qMax(pos, 0.0), double(length))));
 
     return Encode(index);
 }
@@ -456,7 +472,8 @@ ReturnedValue StringPrototype::method_indexOf(const FunctionObject *b, const Val
 ReturnedValue StringPrototype::method_includes(const FunctionObject *b, const Value *thisObject, const Value *argv, int argc)
 {
     ExecutionEngine *v4 = b->engine();
-    const QString value = getThisString(v4, thisObject);
+    Scope scope(v4);
+    ScopedString value(scope, getThisHeapString(v4, thisObject));
     if (v4->hasException)
         return QV4::Encode::undefined();
 
@@ -467,18 +484,12 @@ ReturnedValue StringPrototype::method_includes(const FunctionObject *b, const Va
         return Encode::undefined();
 
     double pos = 0;
-    if (argc > 1) {
-        const Value &posArg = argv[1];
-        pos = posArg.toInteger();
-        if (!posArg.isInteger() && posArg.isNumber() && qIsInf(posArg.toNumber()))
-            pos = value.size();
-    }
-
-    if (pos == 0)
-        RETURN_RESULT(Encode(value.contains(searchString)));
+    if (argc > 1)
+        pos = argv[1].toInteger();
 
-    QStringView stringToSearch = QStringView{value}.mid(pos);
-    return Encode(stringToSearch.contains(searchString));
+    const int length = value->d()->length();
+    const int from = int(qMin(qMax(pos, 0.0), double(length)));
+    return Encode(value->d()->indexOf(searchString, from) != -1);
 }
 
 ReturnedValue StringPrototype::method_lastIndexOf(const FunctionObject *b, const Value *thisObject, const Value *argv, int argc)
@@ -30,6 +30,9 @@
 #if QT_CONFIG(qml_jit)
 #include <private/qv4baselinejit_p.h>
 #endif
+#if QT_CONFIG(qml_jit) && QT_CONFIG(thread)
+#include <private/qv4backgroundcompiler_p.h>
+#endif
 
 #include <qtqml_tracepoints_p.h>
 
@@ -347,6 +350,20 @@ static inline const QV4::Value &constant(Function *function, int index)
     return function->compilationUnit->constants[index].asValue<QV4::Value>();
 }
 
+// Returns the array data if base[index] is an element of packed simple array data.
+static inline Heap::SimpleArrayData *packedArrayData(const QV4::Value &base, const QV4::Value &index)
+{
+    if (!index.isPositiveInt())
+        return nullptr;
+    Heap::Base *b = base.heapObject();
+    if (!b || !b->internalClass->vtable->isObject)
+        return nullptr;
+    Heap::ArrayData *a = static_cast<Heap::Object *>(b)->arrayData;
+    if (!a || !a->isPacked() || uint(index.int_32()) >= a->values.size)
+        return nullptr;
+    return static_cast<Heap::SimpleArrayData *>(a);
+}
+
 static bool compareEqualInt(QV4::Value &accumulator, QV4::Value lhs, int rhs)
 {
   redo:
@@ -377,6 +394,17 @@ static bool compareEqualInt(QV4::Value &accumulator, QV4::Value lhs, int rhs)
 #define STORE_IP() frame->instructionPointer = int(code - function->codeData);
 #define STORE_ACC() accumulator = acc;
 #define ACC Value::fromReturnedValue(acc)
+
+#if QT_CONFIG(qml_jit)
+#define CHECK_BACK_EDGE \
+    if (offset < 0 && Q_UNLIKELY(engine->canJITOnBackEdge(function))) { \
+        STORE_ACC(); \
+        if (enterJitFromLoop(frame, engine, code)) \
+            return function->jittedCode(frame, engine); \
+    }
+#else
+#define CHECK_BACK_EDGE
+#endif
 #define VALUE_TO_INT(i, val) \
     int i; \
     do { \
@@ -447,6 +475,49 @@ void VME::exec(MetaTypesStackFrame *frame, ExecutionEngine *engine)
     });
 }
 
+#if QT_CONFIG(qml_jit)
+// Compiles the function right away or, with QV4_JIT_BACKGROUND, queues it for the background
+// compiler. Code compiled in the background is installed here, on the thread running the engine,
+// so jittedCode never changes under a running interpreter.
+static void jitFunction(ExecutionEngine *engine, Function *function)
+{
+#if QT_CONFIG(thread)
+    if (JIT::BackgroundCompiler *compiler = engine->backgroundCompiler) {
+        if (compiler->hasFinishedJobs())
+            compiler->installFinishedJobs();
+        if (function->codeRef == nullptr && !function->jitQueued) {
+            function->jitQueued = true;
+            compiler->enqueue(function);
+        }
+        return;
+    }
+#else
+    Q_UNUSED(engine);
+#endif
+    QV4::JIT::BaselineJIT(function).generate();
+}
+
+// Hands a frame that is looping in the interpreter over to the JIT. Apart from the accumulator,
+// which it reloads on entry, the JIT keeps all its state in the frame, and it can enter its code
+// at any jump target given in the instruction pointer. Exception handlers and pending unwinds are
+// recorded as interpreter code pointers, though. We stay in the interpreter while there are any.
+static bool enterJitFromLoop(JSTypesStackFrame *frame, ExecutionEngine *engine, const char *code)
+{
+    Function *function = frame->v4Function;
+    function->interpreterBackEdgeCount = 0;
+    if (engine->debugger() || frame->unwindHandler || frame->unwindLabel || frame->unwindLevel)
+        return false;
+
+    if (function->codeRef == nullptr)
+        jitFunction(engine, function);
+    if (function->jittedCode == nullptr)
+        return false;
+
+    frame->instructionPointer = int(code - function->codeData);
+    return true;
+}
+#endif // QT_CONFIG(qml_jit)
+
 ReturnedValue VME::exec(JSTypesStackFrame *frame, ExecutionEngine *engine)
 {
     qt_v4ResolvePendingBreakpointsHook();
@@ -467,7 +538,7 @@ ReturnedValue VME::exec(JSTypesStackFrame *frame, ExecutionEngine *engine)
         // time we execute the function, but just interpret instead.
         if (function->codeRef == nullptr) {
             if (engine->canJIT(function))
-                QV4::JIT::BaselineJIT(function).generate();
+                jitFunction(engine, function);
             else
                 ++function->interpreterCallCount;
         }
@@ -625,17 +696,26 @@ QV4::ReturnedValue VME::interpret(JSTypesStackFrame *frame, ExecutionEngine *eng
     MOTH_END_INSTR(StoreNameSloppy)
 
     MOTH_BEGIN_INSTR(LoadElement)
-        STORE_IP();
-        STORE_ACC();
-        acc = Runtime::LoadElement::call(engine, STACK_VALUE(base), accumulator);
-        CHECK_EXCEPTION;
+        if (Heap::SimpleArrayData *a = packedArrayData(STACK_VALUE(base), ACC)) {
+            acc = a->data(uint(ACC.int_32())).asReturnedValue();
+        } else {
+            STORE_IP();
+            STORE_ACC();
+            acc = Runtime::LoadElement::call(engine, STACK_VALUE(base), accumulator);
+            CHECK_EXCEPTION;
+        }
     MOTH_END_INSTR(LoadElement)
 
     MOTH_BEGIN_INSTR(StoreElement)
-        STORE_IP();
-        STORE_ACC();
-        Runtime::StoreElement::call(engine, STACK_VALUE(base), STACK_VALUE(index), accumulator);
-        CHECK_EXCEPTION;
+        Heap::SimpleArrayData *a = packedArrayData(STACK_VALUE(base), STACK_VALUE(index));
+        if (a && a->canStorePacked(ACC)) {
+            a->storePacked(uint(STACK_VALUE(index).int_32()), ACC);
+        } else {
+            STORE_IP();
+            STORE_ACC();
+            Runtime::StoreElement::call(engine, STACK_VALUE(base), STACK_VALUE(index), accumulator);
+            CHECK_EXCEPTION;
+        }
     MOTH_END_INSTR(StoreElement)
 
     MOTH_BEGIN_INSTR(LoadProperty)
@@ -1047,6 +1127,7 @@ QV4::ReturnedValue VME::interpret(JSTypesStackFrame *frame, ExecutionEngine *eng
 
     MOTH_BEGIN_INSTR(Jump)
         code += offset;
+        CHECK_BACK_EDGE;
     MOTH_END_INSTR(Jump)
 
     MOTH_BEGIN_INSTR(JumpTrue)
@@ -1055,8 +1136,10 @@ QV4::ReturnedValue VME::interpret(JSTypesStackFrame *frame, ExecutionEngine *eng
             takeJump = ACC.int_32();
         else
             takeJump = ACC.toBoolean();
-        if (takeJump)
+        if (takeJump) {
             code += offset;
+            CHECK_BACK_EDGE;
+        }
     MOTH_END_INSTR(JumpTrue)
 
     MOTH_BEGIN_INSTR(JumpFalse)
@@ -1065,8 +1148,10 @@ QV4::ReturnedValue VME::interpret(JSTypesStackFrame *frame, ExecutionEngine *eng
             takeJump = !ACC.int_32();
         else
             takeJump = !ACC.toBoolean();
-        if (takeJump)
+        if (takeJump) {
             code += offset;
+            CHECK_BACK_EDGE;
+        }
     MOTH_END_INSTR(JumpFalse)
 
     MOTH_BEGIN_INSTR(JumpNoException)
@@ -144,7 +144,12 @@ void Base::mark(QV4::MarkStack *markStack)
     Q_ASSERT(!Chunk::testBit(c->extendsBitmap, index));
     quintptr *bitmap = c->blackBitmap + Chunk::bitmapIndex(index);
     quintptr bit = Chunk::bitForIndex(index);
-    if (!(*bitmap & bit)) {
+    if (Q_UNLIKELY(markStack->isParallel())) {
+        // other threads may be marking items in the same bitmap entry
+        if (Chunk::testBitAtomic(bitmap, bit) || !Chunk::testAndSetBitAtomic(bitmap, bit))
+            return;
+        markStack->push(this);
+    } else if (!(*bitmap & bit)) {
         *bitmap |= bit;
         markStack->push(this);
     }
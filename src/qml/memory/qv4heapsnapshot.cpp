@@ -0,0 +1,370 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qv4heapsnapshot_p.h"
+#include "qv4mm_p.h"
+#include "qv4engine_p.h"
+#include "qv4string_p.h"
+#include "qv4function_p.h"
+#include "qv4functionobject_p.h"
+#include "qv4qobjectwrapper_p.h"
+#include "qv4persistent_p.h"
+
+#include <QtCore/qiodevice.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+QT_BEGIN_NAMESPACE
+
+using namespace QV4;
+
+namespace {
+
+// The node and edge types of the .heapsnapshot format, in the order of the meta data below
+enum NodeType {
+    HiddenNode,
+    ArrayNode,
+    StringNode,
+    ObjectNode,
+    CodeNode,
+    ClosureNode,
+    RegExpNode,
+    NumberNode,
+    NativeNode,
+    SyntheticNode,
+    ConcatenatedStringNode,
+    SlicedStringNode,
+    SymbolNode,
+    BigIntNode
+};
+
+enum EdgeType {
+    ContextEdge,
+    ElementEdge,
+    PropertyEdge,
+    InternalEdge,
+    HiddenEdge,
+    ShortcutEdge,
+    WeakEdge
+};
+
+enum {
+    NodeFieldCount = 6,
+    EdgeBufferSize = 4096,
+    MaxNameLength = 1024
+};
+
+// The synthetic nodes we put on top of the heap, the gc roots are the children of RootNode
+enum SyntheticNodeIndex : uint {
+    RootNode,
+    EngineRootsNode,
+    JSStackNode,
+    PersistentValuesNode,
+    QObjectOwnershipNode,
+    FirstHeapNode
+};
+
+bool inherits(const VTable *vtable, const VTable *base)
+{
+    for (; vtable; vtable = vtable->parent) {
+        if (vtable == base)
+            return true;
+    }
+    return false;
+}
+
+size_t slotCount(Chunk *c, size_t index)
+{
+    size_t slots = 1;
+    while (index + slots < Chunk::NumSlots && Chunk::testBit(c->extendsBitmap, index + slots))
+        ++slots;
+    return slots;
+}
+
+void writeJsonString(QByteArray &out, const QString &string)
+{
+    out += '"';
+    for (const QChar c : string) {
+        const char16_t u = c.unicode();
+        switch (u) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (u < 0x20 || u >= 0x7f) {
+                // also escapes lone surrogates, which are not valid UTF-8
+                char buffer[7];
+                std::snprintf(buffer, sizeof(buffer), "\\u%04x", unsigned(u));
+                out += buffer;
+            } else {
+                out += char(u);
+            }
+        }
+    }
+    out += '"';
+}
+
+} // namespace
+
+HeapSnapshotBuilder::HeapSnapshotBuilder(MemoryManager *mm)
+    : mm(mm)
+{
+    stringIndex(QString());
+}
+
+bool HeapSnapshotBuilder::write(QIODevice *device)
+{
+    const std::vector<quintptr> blackBits = mm->takeBlackBits();
+
+    addNode(nullptr, SyntheticNode, QStringLiteral("(GC roots)"), 0);
+    addNode(nullptr, SyntheticNode, QStringLiteral("(Engine roots)"), 0);
+    addNode(nullptr, SyntheticNode, QStringLiteral("(JS stack)"), 0);
+    addNode(nullptr, SyntheticNode, QStringLiteral("(Persistent values)"), 0);
+    addNode(nullptr, SyntheticNode, QStringLiteral("(QObject ownership)"), 0);
+    collectHeapNodes();
+    collectEdges();
+
+    mm->restoreBlackBits(blackBits);
+    return writeJson(device);
+}
+
+uint HeapSnapshotBuilder::addNode(Heap::Base *item, int type, const QString &name, size_t selfSize)
+{
+    const uint index = uint(nodes.size());
+    nodes.push_back({ item, type, stringIndex(name), selfSize, 0 });
+    if (item)
+        nodeIndices.insert(item, index);
+    return index;
+}
+
+void HeapSnapshotBuilder::addHeapNode(Heap::Base *item, size_t selfSize)
+{
+    const VTable *vtable = item->internalClass->vtable;
+    int type = HiddenNode;
+    QString name = QString::fromLatin1(vtable->className);
+
+    if (vtable->isString) {
+        const Heap::String *string = static_cast<Heap::String *>(item);
+        selfSize += string->retainedTextSize();
+        // Don't flatten ropes here, that would allocate
+        if (string->subtype >= Heap::String::StringType_Complex) {
+            type = ConcatenatedStringNode;
+        } else {
+            type = StringNode;
+            name = string->StringOrSymbol::toQString().left(MaxNameLength);
+        }
+    } else if (vtable->isStringOrSymbol) {
+        type = SymbolNode;
+        name = static_cast<Heap::StringOrSymbol *>(item)->toQString().left(MaxNameLength);
+    } else if (inherits(vtable, QObjectWrapper::staticVTable())) {
+        type = NativeNode;
+        if (QObject *object = static_cast<Heap::QObjectWrapper *>(item)->object()) {
+            name = QString::fromLatin1(object->metaObject()->className());
+            if (!object->objectName().isEmpty())
+                name += QLatin1Char(' ') + object->objectName();
+        } else {
+            name += QStringLiteral(" (deleted)");
+        }
+    } else if (inherits(vtable, JavaScriptFunctionObject::staticVTable())) {
+        type = ClosureNode;
+        if (Function *function = static_cast<Heap::JavaScriptFunctionObject *>(item)->function) {
+            name = function->name()->toQString();
+            if (name.isEmpty())
+                name = QStringLiteral("(anonymous)");
+            name += QStringLiteral(" %1:%2").arg(function->sourceFile())
+                    .arg(function->compiledFunction->location.line());
+        }
+    } else if (vtable->isObject) {
+        switch (vtable->type) {
+        case Managed::Type_ArrayObject:
+            type = ArrayNode;
+            break;
+        case Managed::Type_RegExpObject:
+            type = RegExpNode;
+            break;
+        default:
+            type = vtable->call ? ClosureNode : ObjectNode;
+            break;
+        }
+    }
+
+    addNode(item, type, name, selfSize);
+}
+
+void HeapSnapshotBuilder::collectHeapNodes()
+{
+    const auto collect = [this](Chunk *c) {
+        for (uint i = 0; i < Chunk::EntriesInBitmap; ++i) {
+            quintptr objects = c->objectBitmap[i];
+            while (objects) {
+                const size_t index = i * Chunk::Bits + qCountTrailingZeroBits(objects);
+                objects &= objects - 1;
+                addHeapNode(*(c->realBase() + index), slotCount(c, index) * Chunk::SlotSize);
+            }
+        }
+    };
+    for (Chunk *c : mm->blockAllocator.chunks)
+        collect(c);
+    for (Chunk *c : mm->dataAllocator.chunks)
+        collect(c);
+    for (Chunk *c : mm->icAllocator.chunks)
+        collect(c);
+    for (const auto &huge : mm->hugeItemAllocator.chunks)
+        addHeapNode(*huge.chunk->first(), huge.size);
+}
+
+void HeapSnapshotBuilder::collectEdges()
+{
+    std::vector<Heap::Base *> buffer(EdgeBufferSize);
+    MarkStack markStack(mm->engine, buffer.data(), buffer.size(), this);
+
+    for (uint category = EngineRootsNode; category < FirstHeapNode; ++category)
+        edges.push_back({ ElementEdge, nodes[RootNode].edgeCount++, category * NodeFieldCount });
+
+    currentNode = EngineRootsNode;
+    mm->engine->markObjects(&markStack);
+    finishNode(&markStack);
+
+    currentNode = JSStackNode;
+    mm->collectFromJSStack(&markStack);
+    finishNode(&markStack);
+
+    currentNode = PersistentValuesNode;
+    if (mm->m_persistentValues) {
+        for (PersistentValueStorage::Iterator it = mm->m_persistentValues->begin(); it.p; ++it) {
+            if (Managed *m = (*it).as<Managed>())
+                m->mark(&markStack);
+        }
+    }
+    finishNode(&markStack);
+
+    currentNode = QObjectOwnershipNode;
+    for (PersistentValueStorage::Iterator it = mm->m_weakValues->begin(); it.p; ++it) {
+        QObjectWrapper *wrapper = (*it).as<QObjectWrapper>();
+        if (!wrapper)
+            continue;
+        if (QObject *object = wrapper->object(); object && MemoryManager::keepsWrapperAlive(object))
+            wrapper->mark(&markStack);
+    }
+    finishNode(&markStack);
+
+    for (currentNode = FirstHeapNode; currentNode < nodes.size(); ++currentNode) {
+        Heap::Base *item = nodes[currentNode].item;
+        item->internalClass->vtable->markObjects(item, &markStack);
+        finishNode(&markStack);
+    }
+}
+
+void HeapSnapshotBuilder::takeEdges(Heap::Base **begin, Heap::Base **end)
+{
+    Node &node = nodes[currentNode];
+    for (Heap::Base **it = begin; it < end; ++it) {
+        Heap::Base *child = *it;
+        markedChildren.push_back(child);
+        const auto found = nodeIndices.constFind(child);
+        if (found == nodeIndices.constEnd())
+            continue;
+        const uint toNode = *found * NodeFieldCount;
+        if (child->internalClass->vtable->type == Managed::Type_InternalClass) {
+            edges.push_back({ InternalEdge, uint(stringIndex(QStringLiteral("internalClass"))),
+                              toNode });
+        } else {
+            edges.push_back({ ElementEdge, node.edgeCount, toNode });
+        }
+        ++node.edgeCount;
+    }
+}
+
+void HeapSnapshotBuilder::finishNode(MarkStack *markStack)
+{
+    markStack->drain();
+    // The black bits only filter duplicate references from the node we just finished
+    for (Heap::Base *child : markedChildren) {
+        const HeapItem *h = reinterpret_cast<const HeapItem *>(child);
+        Chunk *c = h->chunk();
+        Chunk::clearBit(c->blackBitmap, h - c->realBase());
+    }
+    markedChildren.clear();
+}
+
+int HeapSnapshotBuilder::stringIndex(const QString &string)
+{
+    const auto found = stringIndices.constFind(string);
+    if (found != stringIndices.constEnd())
+        return *found;
+    const int index = int(strings.size());
+    strings.push_back(string);
+    stringIndices.insert(string, index);
+    return index;
+}
+
+bool HeapSnapshotBuilder::writeJson(QIODevice *device) const
+{
+    QByteArray out;
+    const auto flush = [&]() {
+        if (device->write(out) != out.size())
+            return false;
+        out.clear();
+        return true;
+    };
+    const auto flushIfFull = [&]() {
+        return out.size() < 64 * 1024 || flush();
+    };
+
+    out += "{\"snapshot\":{\"meta\":{"
+           "\"node_fields\":[\"type\",\"name\",\"id\",\"self_size\",\"edge_count\",\"trace_node_id\"],"
+           "\"node_types\":[[\"hidden\",\"array\",\"string\",\"object\",\"code\",\"closure\","
+           "\"regexp\",\"number\",\"native\",\"synthetic\",\"concatenated string\","
+           "\"sliced string\",\"symbol\",\"bigint\"],"
+           "\"string\",\"number\",\"number\",\"number\",\"number\",\"number\"],"
+           "\"edge_fields\":[\"type\",\"name_or_index\",\"to_node\"],"
+           "\"edge_types\":[[\"context\",\"element\",\"property\",\"internal\",\"hidden\","
+           "\"shortcut\",\"weak\"],\"string_or_number\",\"node\"],"
+           "\"trace_function_info_fields\":[],\"trace_node_fields\":[],"
+           "\"sample_fields\":[],\"location_fields\":[]},";
+    out += "\"node_count\":" + QByteArray::number(qulonglong(nodes.size()));
+    out += ",\"edge_count\":" + QByteArray::number(qulonglong(edges.size()));
+    out += ",\"trace_function_count\":0},\n\"nodes\":[";
+
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        const Node &node = nodes[i];
+        if (i)
+            out += ",\n";
+        // ids are stable within one snapshot only, odd ones are what the DevTools expect for heap objects
+        out += QByteArray::number(node.type) + ',' + QByteArray::number(node.name) + ','
+                + QByteArray::number(qulonglong(i * 2 + 1)) + ','
+                + QByteArray::number(qulonglong(node.selfSize)) + ','
+                + QByteArray::number(node.edgeCount) + ",0";
+        if (!flushIfFull())
+            return false;
+    }
+
+    out += "],\n\"edges\":[";
+    for (size_t i = 0; i < edges.size(); ++i) {
+        const Edge &edge = edges[i];
+        if (i)
+            out += ",\n";
+        out += QByteArray::number(edge.type) + ',' + QByteArray::number(edge.nameOrIndex) + ','
+                + QByteArray::number(edge.toNode);
+        if (!flushIfFull())
+            return false;
+    }
+
+    out += "],\n\"trace_function_infos\":[],\"trace_tree\":[],\"samples\":[],\"locations\":[],"
+           "\n\"strings\":[";
+    for (size_t i = 0; i < strings.size(); ++i) {
+        if (i)
+            out += ",\n";
+        writeJsonString(out, strings[i]);
+        if (!flushIfFull())
+            return false;
+    }
+    out += "]}\n";
+    return flush();
+}
+
+QT_END_NAMESPACE
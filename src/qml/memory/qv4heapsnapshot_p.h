@@ -0,0 +1,86 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+#ifndef QV4HEAPSNAPSHOT_P_H
+#define QV4HEAPSNAPSHOT_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <private/qv4global_p.h>
+#include <private/qv4mmdefs_p.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qstring.h>
+
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+class QIODevice;
+
+namespace QV4 {
+
+class MemoryManager;
+
+/*
+ * Writes the object graph of the managed heap in the .heapsnapshot format of the Chrome
+ * DevTools, which computes retained sizes, dominators and retaining paths from it.
+ *
+ * The references of each object are collected by running its markObjects() on a MarkStack that
+ * hands everything pushed onto it to takeEdges(). Black bits
+ * are used as a "seen from this object" filter and restored afterwards, so the snapshot does
+ * not disturb a generational heap. It must only run while no gc cycle is in progress.
+ */
+struct HeapSnapshotBuilder : EdgeCollector
+{
+    HeapSnapshotBuilder(MemoryManager *mm);
+
+    bool write(QIODevice *device);
+
+    void takeEdges(Heap::Base **begin, Heap::Base **end) override;
+
+private:
+    struct Node {
+        Heap::Base *item;
+        int type;
+        int name;
+        size_t selfSize;
+        uint edgeCount;
+    };
+    struct Edge {
+        int type;
+        uint nameOrIndex;
+        uint toNode;
+    };
+
+    uint addNode(Heap::Base *item, int type, const QString &name, size_t selfSize);
+    void addHeapNode(Heap::Base *item, size_t selfSize);
+    void collectHeapNodes();
+    void collectEdges();
+    void finishNode(MarkStack *markStack);
+
+    int stringIndex(const QString &string);
+    bool writeJson(QIODevice *device) const;
+
+    MemoryManager *mm;
+    std::vector<Node> nodes;
+    std::vector<Edge> edges;
+    std::vector<QString> strings;
+    QHash<QString, int> stringIndices;
+    QHash<Heap::Base *, uint> nodeIndices;
+    std::vector<Heap::Base *> markedChildren;
+    uint currentNode = 0;
+};
+
+} // namespace QV4
+
+QT_END_NAMESPACE
+
+#endif // QV4HEAPSNAPSHOT_P_H
@@ -6,6 +6,7 @@
 #include "qv4mm_p.h"
 #include "qv4qobjectwrapper_p.h"
 #include "qv4identifiertable_p.h"
+#include "qv4lookup_p.h"
 #include <QtCore/qalgorithms.h>
 #include <QtCore/private/qnumeric_p.h>
 #include <QtCore/qloggingcategory.h>
@@ -16,6 +17,7 @@
 
 #include <QElapsedTimer>
 #include <QMap>
+#include <QSet>
 #include <QScopedValueRollback>
 
 #include <cstdlib>
@@ -23,9 +25,22 @@
 #include "qv4profiling_p.h"
 #include "qv4mapobject_p.h"
 #include "qv4setobject_p.h"
+#include "qv4arraydata_p.h"
+#include "qv4memberdata_p.h"
+#include "qv4string_p.h"
+#include "qv4regexp_p.h"
+#include "qv4heapsnapshot_p.h"
+#include "qv4functionobject_p.h"
 
 #include <chrono>
 
+#if QT_CONFIG(thread)
+#include <QtCore/qmutex.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qthreadpool.h>
+#include <QtCore/qwaitcondition.h>
+#endif
+
 //#define MM_STATS
 
 #if !defined(MM_STATS) && !defined(QT_NO_DEBUG)
@@ -69,7 +84,11 @@ namespace QV4 {
 
 enum {
     MinSlotsGCLimit = QV4::Chunk::AvailableSlots*16,
-    GCOverallocation = 200 /* Max overallocation by the GC in % */
+    GCOverallocation = 200, /* Max overallocation by the GC in % */
+    DefaultNurserySize = 4 * 1024 * 1024, /* Young allocations in bytes before a minor collection */
+    MaxMinorCollections = 8, /* Minor collections in a row before a major one is forced */
+    OldGenerationGrowth = 200, /* Growth of the old generation in % that forces a major collection */
+    ParallelMarkThreshold = 4096 /* Mark stack entries needed to wake up the parallel markers */
 };
 
 struct MemorySegment {
@@ -102,6 +121,14 @@ struct MemorySegment {
         qSwap(availableBytes, other.availableBytes);
         qSwap(nChunks, other.nChunks);
     }
+    MemorySegment &operator=(MemorySegment &&other) {
+        qSwap(pageReservation, other.pageReservation);
+        qSwap(base, other.base);
+        qSwap(allocatedMap, other.allocatedMap);
+        qSwap(availableBytes, other.availableBytes);
+        qSwap(nChunks, other.nChunks);
+        return *this;
+    }
 
     ~MemorySegment() {
         if (base)
@@ -207,6 +234,7 @@ struct ChunkAllocator {
 
     Chunk *allocate(size_t size = 0);
     void free(Chunk *chunk, size_t size = 0);
+    void releaseEmptySegments();
 
     std::vector<MemorySegment> memorySegments;
 };
@@ -241,6 +269,15 @@ void ChunkAllocator::free(Chunk *chunk, size_t size)
     Q_ASSERT(false);
 }
 
+void ChunkAllocator::releaseEmptySegments()
+{
+    // The chunks of a segment are decommitted when they are freed, dropping the segment
+    // also gives its address space back.
+    memorySegments.erase(std::remove_if(memorySegments.begin(), memorySegments.end(),
+                                        [](const MemorySegment &m) { return !m.allocatedMap; }),
+                         memorySegments.end());
+}
+
 #ifdef DUMP_SWEEP
 QString binary(quintptr n) {
     QString s = QString::number(n, 2);
@@ -265,21 +302,25 @@ static void increaseFreedCountForClass(const char *className)
     (*freedObjectStatsGlobal())[className]++;
 }
 
-//bool Chunk::sweep(ClassDestroyStatsCallback classCountPtr)
-bool Chunk::sweep(ExecutionEngine *engine)
+/*
+    Frees all white objects of the chunk. freeItem is called for every object to be
+    freed, and freedSlots with the number of slots freed per bitmap entry.
+*/
+template<typename FreeItem, typename FreedSlots>
+static bool sweepChunk(Chunk *c, FreeItem &&freeItem, FreedSlots &&freedSlots)
 {
     bool hasUsedSlots = false;
-    SDUMP() << "sweeping chunk" << this;
-    HeapItem *o = realBase();
+    SDUMP() << "sweeping chunk" << c;
+    HeapItem *o = c->realBase();
     bool lastSlotFree = false;
     for (uint i = 0; i < Chunk::EntriesInBitmap; ++i) {
-        quintptr toFree = objectBitmap[i] ^ blackBitmap[i];
-        Q_ASSERT((toFree & objectBitmap[i]) == toFree); // check all black objects are marked as being used
-        quintptr e = extendsBitmap[i];
+        quintptr toFree = c->objectBitmap[i] ^ c->blackBitmap[i];
+        Q_ASSERT((toFree & c->objectBitmap[i]) == toFree); // check all black objects are marked as being used
+        quintptr e = c->extendsBitmap[i];
         SDUMP() << "   index=" << i;
         SDUMP() << "        toFree      =" << binary(toFree);
-        SDUMP() << "        black       =" << binary(blackBitmap[i]);
-        SDUMP() << "        object      =" << binary(objectBitmap[i]);
+        SDUMP() << "        black       =" << binary(c->blackBitmap[i]);
+        SDUMP() << "        object      =" << binary(c->objectBitmap[i]);
         SDUMP() << "        extends     =" << binary(e);
         if (lastSlotFree)
             e &= (e + 1); // clear all lowest extent bits
@@ -300,34 +341,132 @@ bool Chunk::sweep(ExecutionEngine *engine)
             e &= result;
 
             HeapItem *itemToFree = o + index;
-            Heap::Base *b = *itemToFree;
-            const VTable *v = b->internalClass->vtable;
-//            if (Q_UNLIKELY(classCountPtr))
-//                classCountPtr(v->className);
-            if (v->destroy) {
-                v->destroy(b);
-                b->_checkIsDestroyed();
-            }
+            freeItem(itemToFree);
 #ifdef V4_USE_HEAPTRACK
             heaptrack_report_free(itemToFree);
 #endif
         }
-        Q_V4_PROFILE_DEALLOC(engine, qPopulationCount((objectBitmap[i] | extendsBitmap[i])
-                                                      - (blackBitmap[i] | e)) * Chunk::SlotSize,
-                             Profiling::SmallItem);
-        objectBitmap[i] = blackBitmap[i];
-        hasUsedSlots |= (blackBitmap[i] != 0);
-        extendsBitmap[i] = e;
-        lastSlotFree = !((objectBitmap[i]|extendsBitmap[i]) >> (sizeof(quintptr)*8 - 1));
+        freedSlots(qPopulationCount((c->objectBitmap[i] | c->extendsBitmap[i])
+                                    - (c->blackBitmap[i] | e)));
+        c->objectBitmap[i] = c->blackBitmap[i];
+        hasUsedSlots |= (c->blackBitmap[i] != 0);
+        c->extendsBitmap[i] = e;
+        lastSlotFree = !((c->objectBitmap[i]|c->extendsBitmap[i]) >> (sizeof(quintptr)*8 - 1));
         SDUMP() << "        new extends =" << binary(e);
         SDUMP() << "        lastSlotFree" << lastSlotFree;
-        Q_ASSERT((objectBitmap[i] & extendsBitmap[i]) == 0);
+        Q_ASSERT((c->objectBitmap[i] & c->extendsBitmap[i]) == 0);
         o += Chunk::Bits;
     }
-    //    DEBUG << "swept chunk" << this << "freed" << slotsFreed << "slots.";
+    //    DEBUG << "swept chunk" << c << "freed" << slotsFreed << "slots.";
     return hasUsedSlots;
 }
 
+//bool Chunk::sweep(ClassDestroyStatsCallback classCountPtr)
+bool Chunk::sweep(ExecutionEngine *engine)
+{
+    return sweepChunk(this, [](HeapItem *itemToFree) {
+        Heap::Base *b = *itemToFree;
+        const VTable *v = b->internalClass->vtable;
+//        if (Q_UNLIKELY(classCountPtr))
+//            classCountPtr(v->className);
+        if (v->destroy) {
+            v->destroy(b);
+            b->_checkIsDestroyed();
+        }
+    }, [engine](quintptr freedSlots) {
+        Q_UNUSED(freedSlots);
+        Q_V4_PROFILE_DEALLOC(engine, freedSlots * Chunk::SlotSize, Profiling::SmallItem);
+    });
+}
+
+#if QT_CONFIG(thread)
+/*
+    Sweeps chunks of the BlockAllocator on a thread of its own, while the gc thread
+    returns to the mutator. Destroy functions are only run on the sweeper thread if
+    they neither touch the engine nor any other heap object. The others are
+    deferred, and run by the gc thread once the background sweep is finished.
+*/
+struct BackgroundSweeper
+{
+    BackgroundSweeper()
+    {
+        threadPool.setMaxThreadCount(1);
+    }
+
+    void start(std::vector<Chunk *> &&chunksToSweep)
+    {
+        Q_ASSERT(!pending);
+        chunks = std::move(chunksToSweep);
+        pending = true;
+        finished.store(false, std::memory_order_relaxed);
+        threadPool.start([this]() { run(); });
+    }
+
+    bool isFinished() const
+    {
+        return finished.load(std::memory_order_acquire);
+    }
+
+    void wait()
+    {
+        threadPool.waitForDone();
+    }
+
+    void run()
+    {
+        auto firstEmptyChunk = std::partition(chunks.begin(), chunks.end(), [this](Chunk *c) {
+            return sweepChunk(c, [this](HeapItem *itemToFree) {
+                destroy(*itemToFree);
+            }, [this](quintptr slots) {
+                freedSlots += slots;
+            });
+        });
+        nonEmptyChunks = firstEmptyChunk - chunks.begin();
+        finished.store(true, std::memory_order_release);
+    }
+
+    void destroy(Heap::Base *b)
+    {
+        // the internal classes of dead objects are only swept once we are done
+        const VTable::Destroy destroyFunction = b->internalClass->vtable->destroy;
+        if (!destroyFunction)
+            return;
+        if (destroyFunction == String::staticVTable()->destroy) {
+            // the unmanaged heap size is accounted for on the gc thread
+            unmanagedSizeFreed += static_cast<Heap::StringOrSymbol *>(b)->releaseText();
+            b->destroy();
+        } else if (destroyFunction == SparseArrayData::staticVTable()->destroy) {
+            destroyFunction(b);
+        } else {
+            deferred.push_back(b);
+            return;
+        }
+        b->_checkIsDestroyed();
+    }
+
+    void reset()
+    {
+        chunks.clear();
+        deferred.clear();
+        nonEmptyChunks = 0;
+        freedSlots = 0;
+        unmanagedSizeFreed = 0;
+        pending = false;
+    }
+
+    QThreadPool threadPool;
+    std::vector<Chunk *> chunks;
+    std::vector<Heap::Base *> deferred;
+    size_t nonEmptyChunks = 0;
+    quintptr freedSlots = 0;
+    qptrdiff unmanagedSizeFreed = 0;
+    std::atomic<bool> finished{false};
+    bool pending = false;
+};
+#else
+struct BackgroundSweeper {};
+#endif
+
 void Chunk::freeAll(ExecutionEngine *engine)
 {
     //    DEBUG << "sweeping chunk" << this << (*freeList);
@@ -544,6 +683,7 @@ HeapItem *BlockAllocator::allocate(size_t size, bool forceAllocation) {
 
 done:
     m->setAllocatedSlots(slotsRequired);
+    allocatedSlotsSinceLastSweep += slotsRequired;
     Q_V4_PROFILE_ALLOC(engine, slotsRequired * Chunk::SlotSize, Profiling::SmallItem);
 #ifdef V4_USE_HEAPTRACK
     heaptrack_report_alloc(m, slotsRequired * Chunk::SlotSize);
@@ -552,7 +692,7 @@ done:
     return m;
 }
 
-void BlockAllocator::sweep()
+void BlockAllocator::sweep(BackgroundSweeper *backgroundSweeper)
 {
     nextFree = nullptr;
     nFree = 0;
@@ -560,6 +700,20 @@ void BlockAllocator::sweep()
 
 //    qDebug() << "BlockAlloc: sweep";
     usedSlotsAfterLastSweep = 0;
+    allocatedSlotsSinceLastSweep = 0;
+
+#if QT_CONFIG(thread)
+    if (backgroundSweeper && chunks.size() > ForegroundSweptChunks) {
+        // Only sweep a few chunks right away, so that the mutator has memory to allocate
+        // from. The others are taken out of the allocator until the sweeper is done.
+        backgroundSweeper->start(std::vector<Chunk *>(chunks.begin() + ForegroundSweptChunks,
+                                                      chunks.end()));
+        backgroundSweptChunks = chunks.size() - ForegroundSweptChunks;
+        chunks.resize(ForegroundSweptChunks);
+    }
+#else
+    Q_UNUSED(backgroundSweeper);
+#endif
 
     auto firstEmptyChunk = std::partition(chunks.begin(), chunks.end(), [this](Chunk *c) {
         return c->sweep(engine);
@@ -580,6 +734,42 @@ void BlockAllocator::sweep()
     chunks.erase(firstEmptyChunk, chunks.end());
 }
 
+void BlockAllocator::finishBackgroundSweep(BackgroundSweeper *backgroundSweeper)
+{
+#if QT_CONFIG(thread)
+    if (!backgroundSweeper->pending)
+        return;
+
+    backgroundSweeper->wait();
+
+    for (Heap::Base *b : backgroundSweeper->deferred) {
+        const VTable *v = b->internalClass->vtable;
+        v->destroy(b);
+        b->_checkIsDestroyed();
+    }
+    Q_V4_PROFILE_DEALLOC(engine, backgroundSweeper->freedSlots * Chunk::SlotSize,
+                         Profiling::SmallItem);
+    engine->memoryManager->changeUnmanagedHeapSizeUsage(-backgroundSweeper->unmanagedSizeFreed);
+
+    const auto firstEmptyChunk = backgroundSweeper->chunks.begin()
+            + backgroundSweeper->nonEmptyChunks;
+    std::for_each(backgroundSweeper->chunks.begin(), firstEmptyChunk, [this](Chunk *c) {
+        c->sortIntoBins(freeBins, NumBins);
+        usedSlotsAfterLastSweep += c->nUsedSlots();
+        chunks.push_back(c);
+    });
+    std::for_each(firstEmptyChunk, backgroundSweeper->chunks.end(), [this](Chunk *c) {
+        Q_V4_PROFILE_DEALLOC(engine, Chunk::DataSize, Profiling::HeapPage);
+        chunkAllocator->free(c);
+    });
+
+    backgroundSweeper->reset();
+    backgroundSweptChunks = 0;
+#else
+    Q_UNUSED(backgroundSweeper);
+#endif
+}
+
 void BlockAllocator::freeAll()
 {
     for (auto c : chunks)
@@ -596,6 +786,15 @@ void BlockAllocator::resetBlackBits()
         c->resetBlackBits();
 }
 
+void BlockAllocator::rebuildFreeLists()
+{
+    nextFree = nullptr;
+    nFree = 0;
+    memset(freeBins, 0, sizeof(freeBins));
+    for (auto c : chunks)
+        c->sortIntoBins(freeBins, NumBins);
+}
+
 HeapItem *HugeItemAllocator::allocate(size_t size) {
     MemorySegment *m = nullptr;
     Chunk *c = nullptr;
@@ -645,9 +844,10 @@ static void freeHugeChunk(ChunkAllocator *chunkAllocator, const HugeItemAllocato
 
 void HugeItemAllocator::sweep(ClassDestroyStatsCallback classCountPtr)
 {
+    // black bits are cleared in resetBlackBits(), unless they need to stick around
+    // for the generational mode
     auto isBlack = [this, classCountPtr] (const HugeChunk &c) {
         bool b = c.chunk->first()->isBlack();
-        Chunk::clearBit(c.chunk->blackBitmap, c.chunk->first() - c.chunk->realBase());
         if (!b) {
             Q_V4_PROFILE_DEALLOC(engine, c.size, Profiling::LargeItem);
             freeHugeChunk(chunkAllocator, c, classCountPtr);
@@ -677,9 +877,23 @@ namespace {
 using ExtraData = GCStateInfo::ExtraData;
 GCState markStart(GCStateMachine *that, ExtraData &)
 {
-    //Initialize the mark stack
-    that->mm->m_markStack = std::make_unique<MarkStack>(that->mm->engine);
-    that->mm->engine->isGCOngoing = true;
+    auto mm = that->mm;
+    mm->minorCollection = mm->generationalGC && !mm->shouldRunMajorCollection();
+    if (mm->generationalGC && !mm->minorCollection) {
+        mm->majorCollectionRequested = false;
+        // The black bits of the old generation survived the last sweep. A major
+        // collection has to start from scratch, which also drops the remembered set.
+        mm->blockAllocator.resetBlackBits();
+        mm->dataAllocator.resetBlackBits();
+        mm->hugeItemAllocator.resetBlackBits();
+        mm->icAllocator.resetBlackBits();
+        mm->m_markStack.reset();
+    }
+
+    //Initialize the mark stack, unless it holds the remembered set of a minor collection
+    if (!mm->m_markStack)
+        mm->m_markStack = std::make_unique<MarkStack>(mm->engine);
+    mm->engine->isGCOngoing = true;
     return GCState::MarkGlobalObject;
 }
 
@@ -753,17 +967,7 @@ GCState markWeakValues(GCStateMachine *that, ExtraData &stateData)
         QObject *qobject = qobjectWrapper->object();
         if (!qobject)
             continue;
-        bool keepAlive = QQmlData::keepAliveDuringGarbageCollection(qobject);
-
-        if (!keepAlive) {
-            if (QObject *parent = qobject->parent()) {
-                while (parent->parent())
-                    parent = parent->parent();
-                keepAlive = QQmlData::keepAliveDuringGarbageCollection(parent);
-            }
-        }
-
-        if (keepAlive)
+        if (MemoryManager::keepsWrapperAlive(qobject))
             qobjectWrapper->mark(that->mm->markStack());
     }
     return GCState::MarkWeakValues;
@@ -771,6 +975,12 @@ GCState markWeakValues(GCStateMachine *that, ExtraData &stateData)
 
 GCState markDrain(GCStateMachine *that, ExtraData &)
 {
+    if (ParallelMarkPool *pool = that->mm->parallelMarkPool.get()) {
+        auto drainState = that->mm->m_markStack->drainInParallel(that->deadline, pool);
+        return drainState == MarkStack::DrainState::Complete
+                ? GCState::MarkReady
+                : GCState::MarkDrain;
+    }
     if (that->deadline.isForever()) {
         that->mm->markStack()->drain();
         return GCState::MarkReady;
@@ -870,26 +1080,80 @@ GCState handleQObjectWrappers(GCStateMachine *that, ExtraData &)
     return GCState::DoSweep;
 }
 
-GCState doSweep(GCStateMachine *that, ExtraData &)
+GCState finishSweep(GCStateMachine *that, ExtraData &);
+
+GCState doSweep(GCStateMachine *that, ExtraData &stateData)
 {
     auto mm = that->mm;
 
+    // the black bits outlive this cycle in generational mode, so all black objects
+    // need to have been traced
+    if (mm->generationalGC)
+        mm->m_markStack->drain();
+
     mm->engine->identifierTable->sweep();
-    mm->blockAllocator.sweep();
+    if (MegamorphicLookupCache *cache = mm->engine->megamorphicLookupCache)
+        cache->clear();
+    mm->blockAllocator.sweep(mm->backgroundSweeper.get());
+    mm->dataAllocator.sweep();
     mm->hugeItemAllocator.sweep(that->mm->gcCollectorStats ? increaseFreedCountForClass : nullptr);
-    mm->icAllocator.sweep();
 
-    // reset all black bits
-    mm->blockAllocator.resetBlackBits();
-    mm->hugeItemAllocator.resetBlackBits();
-    mm->icAllocator.resetBlackBits();
+    // the internal classes of dead objects are needed until all chunks have been swept
+    mm->internalClassSweepPending = true;
 
-    mm->usedSlotsAfterLastFullSweep = mm->blockAllocator.usedSlotsAfterLastSweep + mm->icAllocator.usedSlotsAfterLastSweep;
+#if QT_CONFIG(thread)
+    if (mm->backgroundSweeper && mm->backgroundSweeper->pending)
+        return GCState::FinishSweep;
+#endif
+    // nothing to wait for, finish in the same increment
+    return finishSweep(that, stateData);
+}
+
+GCState finishSweep(GCStateMachine *that, ExtraData &)
+{
+    auto mm = that->mm;
+
+#if QT_CONFIG(thread)
+    if (BackgroundSweeper *sweeper = mm->backgroundSweeper.get()) {
+        // let the mutator continue while the sweeper is busy, unless we need to finish now
+        if (sweeper->pending && !sweeper->isFinished() && !that->deadline.isForever())
+            return GCState::FinishSweep;
+        mm->blockAllocator.finishBackgroundSweep(sweeper);
+    }
+#endif
+
+    mm->icAllocator.sweep();
+    mm->internalClassSweepPending = false;
+
+    mm->usedSlotsAfterLastFullSweep = mm->blockAllocator.usedSlotsAfterLastSweep
+            + mm->dataAllocator.usedSlotsAfterLastSweep + mm->icAllocator.usedSlotsAfterLastSweep;
     mm->gcBlocked = MemoryManager::Unblocked;
-    mm->m_markStack.reset();
-    mm->engine->isGCOngoing = false;
+
+    if (mm->generationalGC) {
+        // survivors keep their black bits and form the old generation; the write
+        // barrier stays active and pushes young objects stored into old ones onto
+        // the mark stack, which is the remembered set of the next minor collection
+        if (mm->minorCollection) {
+            ++mm->minorCollectionsSinceMajor;
+            ++mm->statistics.minorCollections;
+        } else {
+            mm->minorCollectionsSinceMajor = 0;
+            mm->usedSlotsAfterLastMajorSweep = mm->usedSlotsAfterLastFullSweep;
+            ++mm->statistics.majorCollections;
+        }
+    } else {
+        // reset all black bits
+        mm->blockAllocator.resetBlackBits();
+        mm->dataAllocator.resetBlackBits();
+        mm->hugeItemAllocator.resetBlackBits();
+        mm->icAllocator.resetBlackBits();
+
+        mm->m_markStack.reset();
+        mm->engine->isGCOngoing = false;
+    }
 
     mm->updateUnmanagedHeapSizeGCLimit();
+    mm->requestCompactionIfFragmented();
 
     return GCState::Invalid;
 }
@@ -902,6 +1166,7 @@ MemoryManager::MemoryManager(ExecutionEngine *engine)
     , chunkAllocator(new ChunkAllocator)
     , blockAllocator(chunkAllocator, engine)
     , icAllocator(chunkAllocator, engine)
+    , dataAllocator(chunkAllocator, engine)
     , hugeItemAllocator(chunkAllocator, engine)
     , m_persistentValues(new PersistentValueStorage(engine))
     , m_weakValues(new PersistentValueStorage(engine))
@@ -909,9 +1174,22 @@ MemoryManager::MemoryManager(ExecutionEngine *engine)
     , aggressiveGC(!qEnvironmentVariableIsEmpty("QV4_MM_AGGRESSIVE_GC"))
     , gcStats(lcGcStats().isDebugEnabled())
     , gcCollectorStats(lcGcAllocatorStats().isDebugEnabled())
+    , generationalGC(!qEnvironmentVariableIsEmpty("QV4_GC_GENERATIONAL"))
+    , compactingGC(!qEnvironmentVariableIsEmpty("QV4_GC_COMPACT"))
 {
 #ifdef V4_USE_VALGRIND
     VALGRIND_CREATE_MEMPOOL(this, 0, true);
+#endif
+    bool ok = false;
+    const int nurseryKb = qEnvironmentVariableIntValue("QV4_GC_NURSERY_SIZE", &ok);
+    const size_t nurseryBytes = (ok && nurseryKb > 0) ? size_t(nurseryKb) * 1024 : DefaultNurserySize;
+    nurserySlots = nurseryBytes >> Chunk::SlotSizeShift;
+#if QT_CONFIG(thread)
+    const int markThreads = qEnvironmentVariableIntValue("QV4_GC_MARK_THREADS");
+    if (markThreads > 1)
+        parallelMarkPool = std::make_unique<ParallelMarkPool>(markThreads);
+    if (!qEnvironmentVariableIsEmpty("QV4_GC_BACKGROUND_SWEEP"))
+        backgroundSweeper = std::make_unique<BackgroundSweeper>();
 #endif
     memset(statistics.allocations, 0, sizeof(statistics.allocations));
     if (gcStats)
@@ -980,6 +1258,10 @@ MemoryManager::MemoryManager(ExecutionEngine *engine)
         doSweep,
         false,
     };
+    gcStateMachine->stateInfoMap[GCState::FinishSweep] = {
+        finishSweep,
+        true,
+    };
 }
 
 Heap::Base *MemoryManager::allocString(std::size_t unmanagedSize)
@@ -1011,6 +1293,25 @@ Heap::Base *MemoryManager::allocData(std::size_t size)
     return *m;
 }
 
+Heap::Base *MemoryManager::allocRelocatableData(std::size_t size)
+{
+    if (!compactingGC)
+        return allocData(size);
+
+#ifdef MM_STATS
+    lastAllocRequestedSlots = size >> Chunk::SlotSizeShift;
+    ++allocationCount;
+#endif
+
+    Q_ASSERT(size >= Chunk::SlotSize);
+    Q_ASSERT(size % Chunk::SlotSize == 0);
+
+    // keep items that compact() can move in chunks of their own
+    HeapItem *m = allocate(&dataAllocator, size);
+    memset(m, 0, size);
+    return *m;
+}
+
 Heap::Object *MemoryManager::allocObjectWithMemberData(const QV4::VTable *vtable, uint nMembers)
 {
     uint size = (vtable->nInlineProperties + vtable->inlinePropertyOffset)*sizeof(Value);
@@ -1028,6 +1329,9 @@ Heap::Object *MemoryManager::allocObjectWithMemberData(const QV4::VTable *vtable
         if (totalSize > Chunk::DataSize) {
             o = static_cast<Heap::Object *>(allocData(size));
             m = hugeItemAllocator.allocate(memberSize)->as<Heap::MemberData>();
+        } else if (compactingGC) {
+            o = static_cast<Heap::Object *>(allocData(size));
+            m = static_cast<Heap::MemberData *>(allocRelocatableData(memberSize));
         } else {
             HeapItem *mh = reinterpret_cast<HeapItem *>(allocData(totalSize));
             Heap::Base *b = *mh;
@@ -1053,6 +1357,169 @@ Heap::Object *MemoryManager::allocObjectWithMemberData(const QV4::VTable *vtable
 
 static uint markStackSize = 0;
 
+#if QT_CONFIG(thread)
+/*
+    Parallel marking distributes the content of the mark stack over a pool of
+    threads. Each of them drains a MarkStack of its own, and hands out packets of
+    work when other threads run idle. Only heap objects whose markObjects function
+    does nothing but marking other heap objects are handled in parallel. All others
+    are deferred and handled by the gc thread once the workers are done.
+*/
+struct ParallelMarkPool
+{
+    enum { WorkerStackSize = 64 * 1024 };
+
+    ParallelMarkPool(int nThreads)
+        : nThreads(nThreads)
+        , stackBuffers(size_t(nThreads) * WorkerStackSize)
+    {
+        threadPool.setMaxThreadCount(nThreads - 1);
+    }
+
+    QThreadPool threadPool;
+    int nThreads;
+    std::vector<Heap::Base *> stackBuffers;
+};
+
+struct ParallelMarkState
+{
+    enum { PacketSize = 256 };
+    using Packet = std::vector<Heap::Base *>;
+
+    ParallelMarkState(int nWorkers, QDeadlineTimer deadline)
+        : nWorkers(nWorkers), deadline(deadline)
+    {}
+
+    void sharePacket(Packet &&packet)
+    {
+        QMutexLocker locker(&mutex);
+        packets.push_back(std::move(packet));
+        workAvailable.wakeOne();
+    }
+
+    // Returns false once all workers have run out of work, or the deadline expired
+    bool takePacket(Packet *packet)
+    {
+        QMutexLocker locker(&mutex);
+        ++idleWorkers;
+        while (!finished) {
+            // On timeout, the packets that are left are handed back to the gc thread
+            if (timedOut.load(std::memory_order_relaxed)
+                    || (packets.empty() && idleWorkers.load(std::memory_order_relaxed) == nWorkers)) {
+                finished = true;
+                workAvailable.wakeAll();
+                break;
+            }
+            if (!packets.empty()) {
+                --idleWorkers;
+                *packet = std::move(packets.back());
+                packets.pop_back();
+                return true;
+            }
+            workAvailable.wait(&mutex);
+        }
+        return false;
+    }
+
+    QMutex mutex;
+    QWaitCondition workAvailable;
+    std::vector<Packet> packets;
+    std::atomic<int> idleWorkers{0};
+    std::atomic<bool> timedOut{false};
+    const int nWorkers;
+    bool finished = false;
+    const QDeadlineTimer deadline;
+};
+
+struct ParallelMarkWorker
+{
+    ParallelMarkWorker(ExecutionEngine *engine, Heap::Base **stackBuffer, ParallelMarkState *state)
+        : stack(engine, stackBuffer, ParallelMarkPool::WorkerStackSize, this), state(state)
+    {}
+
+    static bool canMarkInParallel(Heap::Base *h)
+    {
+        const VTable::MarkObjects markObjects = h->internalClass->vtable->markObjects;
+        return markObjects == Heap::Object::markObjects
+                || markObjects == Heap::ArrayData::markObjects
+                || markObjects == Heap::MemberData::markObjects
+                || markObjects == Heap::String::markObjects
+                || markObjects == Heap::StringOrSymbol::markObjects
+                || markObjects == Heap::InternalClass::markObjects;
+    }
+
+    void run()
+    {
+        ParallelMarkState::Packet packet;
+        while (state->takePacket(&packet)) {
+            ++takenPackets;
+            // the objects in the packet are black already
+            for (Heap::Base *h : packet)
+                stack.push(h);
+            packet.clear();
+            drain(&stack);
+        }
+        // whatever is left was not handled because of the deadline
+        spill(&stack);
+    }
+
+    // also called through MarkStack::drain() when the soft limit is reached
+    void drain(MarkStack *ms)
+    {
+        int iterations = 0;
+        while (!ms->isEmpty()) {
+            if (iterations == 0 && state->timedOut.load(std::memory_order_relaxed)) {
+                spill(ms);
+                return;
+            }
+            if (++iterations == markLoopIterationCount) {
+                iterations = 0;
+                if (state->deadline.hasExpired()) {
+                    state->timedOut.store(true, std::memory_order_relaxed);
+                    spill(ms);
+                    return;
+                }
+                shareWorkIfNeeded(ms);
+            }
+            Heap::Base *h = ms->pop();
+            Q_ASSERT(h && h->internalClass);
+            if (canMarkInParallel(h))
+                h->internalClass->vtable->markObjects(h, ms);
+            else
+                deferred.push_back(h);
+        }
+    }
+
+    // Once the deadline has expired, markObjects() of the entries being handled can still push
+    // more. Empty the stack so that it doesn't overrun. The gc thread picks the entries up.
+    void spill(MarkStack *ms)
+    {
+        while (!ms->isEmpty())
+            leftOvers.push_back(ms->pop());
+    }
+
+    void shareWorkIfNeeded(MarkStack *ms)
+    {
+        constexpr qptrdiff packetSize = ParallelMarkState::PacketSize;
+        if (!state->idleWorkers.load(std::memory_order_relaxed) || ms->size() < 2 * packetSize)
+            return;
+        // hand out the oldest entries, they tend to lead to the largest subgraphs
+        ParallelMarkState::Packet packet(ms->m_base, ms->m_base + packetSize);
+        std::memmove(ms->m_base, ms->m_base + packetSize, (ms->size() - packetSize) * sizeof(Heap::Base *));
+        ms->m_top -= packetSize;
+        state->sharePacket(std::move(packet));
+    }
+
+    MarkStack stack;
+    ParallelMarkState *state;
+    std::vector<Heap::Base *> deferred;
+    std::vector<Heap::Base *> leftOvers;
+    uint takenPackets = 0;
+};
+#else
+struct ParallelMarkPool {};
+#endif
+
 MarkStack::MarkStack(ExecutionEngine *engine)
     : m_engine(engine)
 {
@@ -1063,8 +1530,39 @@ MarkStack::MarkStack(ExecutionEngine *engine)
     m_softLimit = m_base + size * 3 / 4;
 }
 
+MarkStack::MarkStack(ExecutionEngine *engine, Heap::Base **base, size_t size, ParallelMarkWorker *worker)
+    : m_top(base)
+    , m_base(base)
+    , m_softLimit(base + size * 3 / 4)
+    , m_hardLimit(base + size)
+    , m_engine(engine)
+    , m_parallelWorker(worker)
+{
+}
+
+MarkStack::MarkStack(ExecutionEngine *engine, Heap::Base **base, size_t size, EdgeCollector *collector)
+    : m_top(base)
+    , m_base(base)
+    , m_softLimit(base + size * 3 / 4)
+    , m_hardLimit(base + size)
+    , m_engine(engine)
+    , m_edgeCollector(collector)
+{
+}
+
 void MarkStack::drain()
 {
+#if QT_CONFIG(thread)
+    if (m_parallelWorker) {
+        m_parallelWorker->drain(this);
+        return;
+    }
+#endif
+    if (m_edgeCollector) {
+        m_edgeCollector->takeEdges(m_base, m_top);
+        m_top = m_base;
+        return;
+    }
     // we're not calling drain(QDeadlineTimer::Forever) as that has higher overhead
     while (m_top > m_base) {
         Heap::Base *h = pop();
@@ -1091,6 +1589,77 @@ MarkStack::DrainState MarkStack::drain(QDeadlineTimer deadline)
     return DrainState::Ongoing;
 }
 
+/*!
+    \internal
+    Drains the mark stack with the help of the threads in \a pool. Small amounts
+    of work are handled on the calling thread only.
+ */
+MarkStack::DrainState MarkStack::drainInParallel(QDeadlineTimer deadline, ParallelMarkPool *pool)
+{
+#if QT_CONFIG(thread)
+    Q_ASSERT(!isParallel());
+    while (true) {
+        // not worth waking up the other threads
+        int iterations = 0;
+        while (!isEmpty() && size() < ParallelMarkThreshold) {
+            Heap::Base *h = pop();
+            ++markStackSize;
+            Q_ASSERT(h && h->internalClass);
+            h->internalClass->vtable->markObjects(h, this);
+            if (++iterations == markLoopIterationCount * 10) {
+                iterations = 0;
+                if (deadline.hasExpired())
+                    return DrainState::Ongoing;
+            }
+        }
+        if (isEmpty())
+            return DrainState::Complete;
+        if (deadline.hasExpired())
+            return DrainState::Ongoing;
+
+        ParallelMarkState state(pool->nThreads, deadline);
+        while (!isEmpty()) {
+            const qptrdiff n = std::min<qptrdiff>(size(), ParallelMarkState::PacketSize);
+            state.packets.emplace_back(m_top - n, m_top);
+            m_top -= n;
+        }
+
+        std::vector<std::unique_ptr<ParallelMarkWorker>> workers;
+        workers.reserve(pool->nThreads);
+        for (int i = 0; i < pool->nThreads; ++i) {
+            Heap::Base **buffer = pool->stackBuffers.data() + size_t(i) * ParallelMarkPool::WorkerStackSize;
+            workers.push_back(std::make_unique<ParallelMarkWorker>(m_engine, buffer, &state));
+        }
+        for (int i = 1; i < pool->nThreads; ++i) {
+            ParallelMarkWorker *worker = workers[i].get();
+            pool->threadPool.start([worker]() { worker->run(); });
+        }
+        // the gc thread takes part, too
+        workers.front()->run();
+        pool->threadPool.waitForDone();
+        ++m_engine->memoryManager->statistics.parallelMarkRounds;
+
+        // All entries are black already. Packets are only left on timeout.
+        for (const ParallelMarkState::Packet &packet : state.packets) {
+            for (Heap::Base *h : packet)
+                push(h);
+        }
+        for (const auto &worker : workers) {
+            m_engine->memoryManager->statistics.parallelMarkPackets += worker->takenPackets;
+            for (Heap::Base *h : worker->leftOvers)
+                push(h);
+            for (Heap::Base *h : worker->deferred)
+                h->internalClass->vtable->markObjects(h, this);
+        }
+        if (state.timedOut.load(std::memory_order_relaxed))
+            return isEmpty() ? DrainState::Complete : DrainState::Ongoing;
+    }
+#else
+    Q_UNUSED(pool);
+    return drain(deadline);
+#endif
+}
+
 void MarkStack::setSoftLimit(size_t size)
 {
     m_softLimit = m_base + size;
@@ -1109,6 +1678,8 @@ void MemoryManager::onEventLoop()
     }
     if (gcStateMachine->inProgress()) {
         gcStateMachine->step();
+    } else if (compactionRequested) {
+        compact();
     }
 }
 
@@ -1139,17 +1710,22 @@ void MemoryManager::sweep(bool lastSweep, ClassDestroyStatsCallback classCountPt
 
     if (!lastSweep) {
         engine->identifierTable->sweep();
+        if (MegamorphicLookupCache *cache = engine->megamorphicLookupCache)
+            cache->clear();
         blockAllocator.sweep(/*classCountPtr*/);
+        dataAllocator.sweep();
         hugeItemAllocator.sweep(classCountPtr);
         icAllocator.sweep(/*classCountPtr*/);
     }
 
     // reset all black bits
     blockAllocator.resetBlackBits();
+    dataAllocator.resetBlackBits();
     hugeItemAllocator.resetBlackBits();
     icAllocator.resetBlackBits();
 
-    usedSlotsAfterLastFullSweep = blockAllocator.usedSlotsAfterLastSweep + icAllocator.usedSlotsAfterLastSweep;
+    usedSlotsAfterLastFullSweep = blockAllocator.usedSlotsAfterLastSweep
+            + dataAllocator.usedSlotsAfterLastSweep + icAllocator.usedSlotsAfterLastSweep;
     updateUnmanagedHeapSizeGCLimit();
     gcBlocked = MemoryManager::Unblocked;
 }
@@ -1197,12 +1773,32 @@ void MemoryManager::cleanupDeletedQObjectWrappersInSweep()
 
 bool MemoryManager::shouldRunGC() const
 {
-    size_t total = blockAllocator.totalSlots() + icAllocator.totalSlots();
+    if (generationalGC
+            && blockAllocator.allocatedSlotsSinceLastSweep + dataAllocator.allocatedSlotsSinceLastSweep
+                       + icAllocator.allocatedSlotsSinceLastSweep >= nurserySlots) {
+        return true;
+    }
+    size_t total = blockAllocator.totalSlots() + dataAllocator.totalSlots() + icAllocator.totalSlots();
     if (total > MinSlotsGCLimit && usedSlotsAfterLastFullSweep * GCOverallocation < total * 100)
         return true;
     return false;
 }
 
+/*!
+    \internal
+    Decides whether the gc cycle about to start in generational mode needs to
+    collect the whole heap, or whether a minor collection of the young objects
+    allocated since the last sweep is enough.
+ */
+bool MemoryManager::shouldRunMajorCollection() const
+{
+    if (majorCollectionRequested || minorCollectionsSinceMajor >= MaxMinorCollections)
+        return true;
+    // the old generation only shrinks in major collections
+    return usedSlotsAfterLastFullSweep * 100
+            > std::max(usedSlotsAfterLastMajorSweep, size_t(MinSlotsGCLimit)) * OldGenerationGrowth;
+}
+
 static size_t dumpBins(BlockAllocator *b, const char *title)
 {
     const QLoggingCategory &stats = lcGcAllocatorStats();
@@ -1232,6 +1828,17 @@ static size_t dumpBins(BlockAllocator *b, const char *title)
     return totalSlotMem*Chunk::SlotSize;
 }
 
+static void dumpInternalClassStats(const QLoggingCategory &stats, ExecutionEngine *engine)
+{
+    const InternalClassStatistics ics = internalClassStatistics(engine);
+    qDebug(stats) << "Internal classes:" << ics.classes << "(" << ics.dictionaryClasses
+                  << "in dictionary mode ) using" << ics.totalBytes() << "bytes,"
+                  << (ics.classes ? ics.totalBytes() / ics.classes : 0) << "per class";
+    qDebug(stats) << "    classes:" << ics.classBytes << "transitions:" << ics.transitionBytes
+                  << "property tables:" << ics.propertyTableBytes
+                  << "name maps:" << ics.nameMapBytes << "attributes:" << ics.attributeBytes;
+}
+
 /*!
     \internal
     Precondition: Incremental garbage collection must be currently active
@@ -1249,7 +1856,7 @@ bool MemoryManager::tryForceGCCompletion()
         return false;
     }
 
-    const bool incrementalGCIsAlreadyRunning = m_markStack != nullptr;
+    const bool incrementalGCIsAlreadyRunning = gcStateMachine->inProgress();
     Q_ASSERT(incrementalGCIsAlreadyRunning);
 
     qCDebug(lcGcForcedRuns) << "Forcing the GC to complete a run.";
@@ -1264,10 +1871,334 @@ bool MemoryManager::tryForceGCCompletion()
 
 void MemoryManager::runFullGC()
 {
+    if (generationalGC)
+        majorCollectionRequested = true;
     runGC();
-    const bool incrementalGCStillRunning = m_markStack != nullptr;
+    const bool incrementalGCStillRunning = gcStateMachine->inProgress();
     if (incrementalGCStillRunning)
         tryForceGCCompletion();
+
+    // we might have finished a minor collection that was already ongoing
+    if (generationalGC && majorCollectionRequested && gcBlocked == Unblocked) {
+        runGC();
+        if (gcStateMachine->inProgress())
+            tryForceGCCompletion();
+    }
+}
+
+bool MemoryManager::writeHeapSnapshot(QIODevice *device)
+{
+    // Only live objects should show up in the snapshot, and nothing may be swept while we walk
+    // the heap.
+    runFullGC();
+    if (gcStateMachine->inProgress())
+        return false;
+
+    HeapSnapshotBuilder builder(this);
+    return builder.write(device);
+}
+
+/* A QObjectWrapper held in m_weakValues is kept alive as long as its object, or the root of
+   its parent chain, needs to stay reachable from JavaScript.
+*/
+bool MemoryManager::keepsWrapperAlive(QObject *object)
+{
+    if (QQmlData::keepAliveDuringGarbageCollection(object))
+        return true;
+
+    if (QObject *parent = object->parent()) {
+        while (parent->parent())
+            parent = parent->parent();
+        return QQmlData::keepAliveDuringGarbageCollection(parent);
+    }
+    return false;
+}
+
+std::vector<quintptr> MemoryManager::takeBlackBits()
+{
+    std::vector<quintptr> blackBits;
+    const auto take = [&blackBits](Chunk *c) {
+        blackBits.insert(blackBits.end(), c->blackBitmap, c->blackBitmap + Chunk::EntriesInBitmap);
+        memset(c->blackBitmap, 0, sizeof(c->blackBitmap));
+    };
+    for (Chunk *c : blockAllocator.chunks)
+        take(c);
+    for (Chunk *c : dataAllocator.chunks)
+        take(c);
+    for (Chunk *c : icAllocator.chunks)
+        take(c);
+    for (const auto &huge : hugeItemAllocator.chunks)
+        take(huge.chunk);
+    return blackBits;
+}
+
+void MemoryManager::restoreBlackBits(const std::vector<quintptr> &blackBits)
+{
+    auto saved = blackBits.cbegin();
+    const auto restore = [&saved](Chunk *c) {
+        std::copy(saved, saved + Chunk::EntriesInBitmap, c->blackBitmap);
+        saved += Chunk::EntriesInBitmap;
+    };
+    for (Chunk *c : blockAllocator.chunks)
+        restore(c);
+    for (Chunk *c : dataAllocator.chunks)
+        restore(c);
+    for (Chunk *c : icAllocator.chunks)
+        restore(c);
+    for (const auto &huge : hugeItemAllocator.chunks)
+        restore(huge.chunk);
+    Q_ASSERT(saved == blackBits.cend());
+}
+
+namespace {
+
+template<typename Callback>
+void forEachItem(Chunk *c, Callback &&callback)
+{
+    for (uint i = 0; i < Chunk::EntriesInBitmap; ++i) {
+        quintptr objects = c->objectBitmap[i];
+        while (objects) {
+            const size_t index = i * Chunk::Bits + qCountTrailingZeroBits(objects);
+            objects &= objects - 1;
+            callback(*(c->realBase() + index), index);
+        }
+    }
+}
+
+size_t itemSlots(Chunk *c, size_t index)
+{
+    size_t slots = 1;
+    while (index + slots < Chunk::NumSlots && Chunk::testBit(c->extendsBitmap, index + slots))
+        ++slots;
+    return slots;
+}
+
+// Items that are only referenced through the fields passed to forEachOwnedReference() can be
+// moved to another chunk.
+bool isRelocatable(Heap::Base *b)
+{
+    const VTable *vtable = b->internalClass->vtable;
+    return vtable->isArrayData || vtable == MemberData::staticVTable();
+}
+
+// ArrayData keeps its attributes behind its values, in the same item
+void relocateInteriorPointers(Heap::Base *from, Heap::Base *to)
+{
+    if (!to->internalClass->vtable->isArrayData)
+        return;
+    Heap::ArrayData *d = static_cast<Heap::ArrayData *>(to);
+    if (d->attrs) {
+        const qptrdiff offset = reinterpret_cast<char *>(d->attrs) - reinterpret_cast<char *>(from);
+        d->attrs = reinterpret_cast<PropertyAttributes *>(reinterpret_cast<char *>(to) + offset);
+    }
+}
+
+template<typename Callback>
+void forEachOwnedReference(Heap::Base *b, Callback &&callback)
+{
+    if (!b->internalClass->vtable->isObject)
+        return;
+    Heap::Object *o = static_cast<Heap::Object *>(b);
+    callback(o->memberData);
+    callback(o->arrayData);
+    if (Value::fromHeapObject(b).as<BoundFunction>())
+        callback(static_cast<Heap::BoundFunction *>(b)->boundArgs);
+}
+
+// Counts all references to the items in the chunks we'd like to evacuate
+struct ReferenceCensus final : EdgeCollector
+{
+    void takeEdges(Heap::Base **begin, Heap::Base **end) override
+    {
+        for (Heap::Base **it = begin; it < end; ++it) {
+            Heap::Base *b = *it;
+            HeapItem *h = reinterpret_cast<HeapItem *>(b);
+            Chunk *c = h->chunk();
+            // clear the black bit right away so that the next reference is seen, too
+            Chunk::clearBit(c->blackBitmap, h - c->realBase());
+            if (!candidates.contains(c))
+                continue;
+            if (fromRoots)
+                pinned.insert(b);
+            else
+                ++references[b];
+        }
+    }
+
+    QSet<Chunk *> candidates;
+    QSet<Heap::Base *> pinned;
+    QHash<Heap::Base *, uint> references;
+    bool fromRoots = true;
+};
+
+} // namespace
+
+std::vector<Chunk *> MemoryManager::sparselyUsedChunks() const
+{
+    std::vector<Chunk *> sparse;
+    for (Chunk *c : dataAllocator.chunks) {
+        if (c->nUsedSlots() <= Chunk::AvailableSlots / CompactionOccupancyDivisor)
+            sparse.push_back(c);
+    }
+    return sparse;
+}
+
+void MemoryManager::requestCompactionIfFragmented()
+{
+    if (!compactingGC || compactionRequested || !engine->publicEngine)
+        return;
+    if (sparselyUsedChunks().size() < MinCompactedChunks)
+        return;
+
+    // Items can only be moved when no C++ code holds pointers to them, so wait for the event loop
+    compactionRequested = true;
+    QMetaObject::invokeMethod(engine->publicEngine, [this]{
+        onEventLoop();
+    }, Qt::QueuedConnection);
+}
+
+/* Moves the MemberData and ArrayData items out of chunks of the dataAllocator that are mostly
+   empty, and frees those chunks. This only works as long as nothing on the C++ stack points to
+   them: It must not run while any JavaScript is executing or a gc cycle is in progress.
+   Unlike strings, those items have a single owner. To be sure, all references to the items in
+   question are counted with the markObjects() functions, and items that are referenced from
+   anything but their owners pin their chunk. So do the items owned by prototypes, as lookups
+   point into those directly.
+*/
+bool MemoryManager::compact()
+{
+    compactionRequested = false;
+    if (!compactingGC || gcBlocked != Unblocked || gcStateMachine->inProgress()
+            || engine->currentStackFrame) {
+        return false;
+    }
+
+    std::vector<Chunk *> candidates = sparselyUsedChunks();
+    candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [](Chunk *c) {
+        bool relocatable = true;
+        forEachItem(c, [&](Heap::Base *b, size_t) { relocatable = relocatable && isRelocatable(b); });
+        return !relocatable;
+    }), candidates.end());
+    if (candidates.size() < MinCompactedChunks)
+        return false;
+
+    ReferenceCensus census;
+    for (Chunk *c : candidates)
+        census.candidates.insert(c);
+
+    const std::vector<quintptr> blackBits = takeBlackBits();
+    {
+        // A stack with room for two items is drained on every push
+        Heap::Base *buffer[2];
+        MarkStack markStack(engine, buffer, 2, &census);
+
+        engine->markObjects(&markStack);
+        collectFromJSStack(&markStack);
+        for (PersistentValueStorage *storage : { m_persistentValues, m_weakValues }) {
+            for (PersistentValueStorage::Iterator it = storage->begin(); it.p; ++it) {
+                if (Managed *m = (*it).as<Managed>())
+                    m->mark(&markStack);
+            }
+        }
+        if (m_markStack) {
+            for (Heap::Base *b : *m_markStack)
+                b->mark(&markStack);
+        }
+
+        census.fromRoots = false;
+        const auto markItem = [&markStack](Heap::Base *b, size_t) {
+            b->internalClass->vtable->markObjects(b, &markStack);
+        };
+        for (Chunk *c : blockAllocator.chunks)
+            forEachItem(c, markItem);
+        for (Chunk *c : dataAllocator.chunks)
+            forEachItem(c, markItem);
+        for (Chunk *c : icAllocator.chunks)
+            forEachItem(c, markItem);
+        for (const auto &huge : hugeItemAllocator.chunks)
+            markItem(*huge.chunk->first(), 0);
+    }
+    restoreBlackBits(blackBits);
+
+    // Proto lookups cache raw pointers into the property data of prototypes and, for global
+    // lookups, of the global object. Those are keyed by the protoId, which moving the data
+    // doesn't change, so the items of these objects pin their chunk.
+    const Heap::Base *globalObject = engine->globalObject ? engine->globalObject->d() : nullptr;
+    QHash<Heap::Base *, uint> ownedReferences;
+    const auto countOwnedReferences = [&](Heap::Base *b, size_t) {
+        const bool pinsOwnedData = b->internalClass->isUsedAsProto() || b == globalObject;
+        forEachOwnedReference(b, [&](const auto &pointer) {
+            if (Heap::Base *target = pointer.heapObject()) {
+                ++ownedReferences[target];
+                if (pinsOwnedData)
+                    census.pinned.insert(target);
+            }
+        });
+    };
+    for (Chunk *c : blockAllocator.chunks)
+        forEachItem(c, countOwnedReferences);
+    for (const auto &huge : hugeItemAllocator.chunks)
+        countOwnedReferences(*huge.chunk->first(), 0);
+
+    std::vector<Chunk *> evacuated;
+    for (Chunk *c : candidates) {
+        bool movable = true;
+        forEachItem(c, [&](Heap::Base *b, size_t) {
+            movable = movable && !census.pinned.contains(b)
+                    && census.references.value(b) == ownedReferences.value(b);
+        });
+        if (movable)
+            evacuated.push_back(c);
+    }
+    if (evacuated.size() < MinCompactedChunks)
+        return false;
+
+    // Take the chunks out of the allocator, so that we don't move items into them
+    auto &chunks = dataAllocator.chunks;
+    chunks.erase(std::remove_if(chunks.begin(), chunks.end(), [&](Chunk *c) {
+        return std::find(evacuated.begin(), evacuated.end(), c) != evacuated.end();
+    }), chunks.end());
+    dataAllocator.rebuildFreeLists();
+
+    QHash<Heap::Base *, Heap::Base *> forwarded;
+    size_t movedSlots = 0;
+    for (Chunk *c : evacuated) {
+        forEachItem(c, [&](Heap::Base *b, size_t index) {
+            const size_t slots = itemSlots(c, index);
+            Heap::Base *moved = *dataAllocator.allocate(slots * Chunk::SlotSize, true);
+            memcpy(static_cast<void *>(moved), static_cast<const void *>(b), slots * Chunk::SlotSize);
+            relocateInteriorPointers(b, moved);
+            // keep the generation of the item
+            if (Chunk::testBit(c->blackBitmap, index))
+                moved->setMarkBit();
+            forwarded.insert(b, moved);
+            movedSlots += slots;
+            Q_V4_PROFILE_DEALLOC(engine, slots * Chunk::SlotSize, Profiling::SmallItem);
+#ifdef V4_USE_HEAPTRACK
+            heaptrack_report_free(b);
+#endif
+        });
+    }
+    dataAllocator.allocatedSlotsSinceLastSweep -= movedSlots;
+
+    const auto updateOwnedReferences = [&](Heap::Base *b, size_t) {
+        forEachOwnedReference(b, [&](auto &pointer) {
+            if (Heap::Base *moved = forwarded.value(pointer.heapObject()))
+                pointer.set(engine, static_cast<decltype(pointer.get())>(moved));
+        });
+    };
+    for (Chunk *c : blockAllocator.chunks)
+        forEachItem(c, updateOwnedReferences);
+    for (const auto &huge : hugeItemAllocator.chunks)
+        updateOwnedReferences(*huge.chunk->first(), 0);
+
+    for (Chunk *c : evacuated) {
+        Q_V4_PROFILE_DEALLOC(engine, Chunk::DataSize, Profiling::HeapPage);
+        chunkAllocator->free(c);
+    }
+    chunkAllocator->releaseEmptySegments();
+    statistics.evacuatedChunks += uint(evacuated.size());
+    return true;
 }
 
 void MemoryManager::runGC()
@@ -1311,6 +2242,8 @@ void MemoryManager::runGC()
         gcStateMachine->step();
         qint64 markTime = t.nsecsElapsed()/1000;
         t.restart();
+        if (generationalGC)
+            qDebug(stats) << (minorCollection ? "Minor" : "Major") << "collection";
         const size_t usedAfter = getUsedMem();
         const size_t largeItemsAfter = getLargeItemsMem();
 
@@ -1324,6 +2257,7 @@ void MemoryManager::runGC()
                 + dumpBins(&icAllocator, "InternalClasss");
         qDebug(stats) << "Marked object in" << markTime << "us.";
         qDebug(stats) << "   " << markStackSize << "objects marked";
+        dumpInternalClassStats(stats, engine);
 
         // sort our object types by number of freed instances
         MMStatsHash freedObjectStats;
@@ -1365,12 +2299,13 @@ void MemoryManager::runGC()
 
 size_t MemoryManager::getUsedMem() const
 {
-    return blockAllocator.usedMem() + icAllocator.usedMem();
+    return blockAllocator.usedMem() + dataAllocator.usedMem() + icAllocator.usedMem();
 }
 
 size_t MemoryManager::getAllocatedMem() const
 {
-    return blockAllocator.allocatedMem() + icAllocator.allocatedMem() + hugeItemAllocator.usedMem();
+    return blockAllocator.allocatedMem() + dataAllocator.allocatedMem() + icAllocator.allocatedMem()
+            + hugeItemAllocator.usedMem();
 }
 
 size_t MemoryManager::getLargeItemsMem() const
@@ -1396,6 +2331,8 @@ void MemoryManager::updateUnmanagedHeapSizeGCLimit()
         // and use freeAll instead
         Q_ASSERT(blockAllocator.allocatedMem()
                  == blockAllocator.usedMem() + dumpBins(&blockAllocator, nullptr));
+        Q_ASSERT(dataAllocator.allocatedMem()
+                 == dataAllocator.usedMem() + dumpBins(&dataAllocator, nullptr));
         Q_ASSERT(icAllocator.allocatedMem()
                  == icAllocator.usedMem() + dumpBins(&icAllocator, nullptr));
     }
@@ -1421,11 +2358,18 @@ MemoryManager::~MemoryManager()
     // do one last non-incremental sweep to clean up C++ objects
     // first, abort any on-going incremental gc operation
     setGCTimeLimit(-1);
+    if (backgroundSweeper)
+        blockAllocator.finishBackgroundSweep(backgroundSweeper.get());
+    if (internalClassSweepPending) {
+        icAllocator.sweep();
+        internalClassSweepPending = false;
+    }
     if (engine->isGCOngoing) {
         engine->isGCOngoing = false;
         m_markStack.reset();
         gcStateMachine->state = GCState::Invalid;
         blockAllocator.resetBlackBits();
+        dataAllocator.resetBlackBits();
         hugeItemAllocator.resetBlackBits();
         icAllocator.resetBlackBits();
     }
@@ -1433,6 +2377,7 @@ MemoryManager::~MemoryManager()
     sweep(/*lastSweep*/true);
 
     blockAllocator.freeAll();
+    dataAllocator.freeAll();
     hugeItemAllocator.freeAll();
     icAllocator.freeAll();
 
@@ -1454,6 +2399,34 @@ void MemoryManager::dumpStats() const
     qDebug(stats) << "Total memory allocated:" << statistics.maxReservedMem;
     qDebug(stats) << "Max memory used before a GC run:" << statistics.maxAllocatedMem;
     qDebug(stats) << "Max memory used after a GC run:" << statistics.maxUsedMem;
+    if (generationalGC) {
+        qDebug(stats) << "Minor collections:" << statistics.minorCollections;
+        qDebug(stats) << "Major collections:" << statistics.majorCollections;
+    }
+    if (parallelMarkPool) {
+        qDebug(stats) << "Parallel mark rounds:" << statistics.parallelMarkRounds
+                      << "with" << statistics.parallelMarkPackets << "packets";
+    }
+    if (compactingGC)
+        qDebug(stats) << "Evacuated chunks:" << statistics.evacuatedChunks;
+    qDebug(stats) << "Flattened strings:" << statistics.ropeFlattenings
+                  << "with" << statistics.flattenedCharacters << "characters";
+    qDebug(stats) << "Strings read in place:" << statistics.ropeAccesses;
+    dumpInternalClassStats(stats, engine);
+#if ENABLE(YARR_JIT)
+    const RegExpCodeCache::Statistics regExpStats = RegExpCodeCache::instance()->statistics();
+    qDebug(stats) << "Shared regular expression code:" << regExpStats.entries << "entries,"
+                  << regExpStats.hits << "hits," << regExpStats.misses << "misses,"
+                  << regExpStats.evictions << "evictions";
+    const auto fallbacks = RegExpCodeCache::instance()->interpreterFallbacks();
+    if (!fallbacks.isEmpty()) {
+        qDebug(stats) << "Regular expressions matched by the interpreter instead of the JIT:";
+        for (const RegExpCodeCache::InterpreterFallback &fallback : fallbacks) {
+            qDebug(stats) << "    " << fallback.pattern << "flags" << int(fallback.flags) << ":"
+                          << fallback.count << "times," << fallback.reason;
+        }
+    }
+#endif
     qDebug(stats) << "Requests for different item sizes:";
     for (int i = 1; i < BlockAllocator::NumBins - 1; ++i)
         qDebug(stats) << "     <" << (i << Chunk::SlotSizeShift) << " bytes: " << statistics.allocations[i];
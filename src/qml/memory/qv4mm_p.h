@@ -26,6 +26,8 @@
 
 QT_BEGIN_NAMESPACE
 
+class QIODevice;
+
 namespace QV4 {
 
 struct GCData { virtual ~GCData(){};};
@@ -54,6 +56,7 @@ public:
         FreeWeakSets,
         HandleQObjectWrappers,
         DoSweep,
+        FinishSweep,
         Invalid,
         Count,
     };
@@ -109,6 +112,8 @@ using GCStateInfo = GCStateMachine::GCStateInfo;
 
 struct ChunkAllocator;
 struct MemorySegment;
+struct ParallelMarkPool;
+struct BackgroundSweeper;
 
 struct BlockAllocator {
     BlockAllocator(ChunkAllocator *chunkAllocator, ExecutionEngine *engine)
@@ -117,7 +122,10 @@ struct BlockAllocator {
         memset(freeBins, 0, sizeof(freeBins));
     }
 
-    enum { NumBins = 8 };
+    enum {
+        NumBins = 8,
+        ForegroundSweptChunks = 8 // chunks swept by the gc thread itself in a background sweep
+    };
 
     static inline size_t binForSlots(size_t nSlots) {
         return nSlots >= NumBins ? NumBins - 1 : nSlots;
@@ -130,7 +138,7 @@ struct BlockAllocator {
     }
 
     size_t allocatedMem() const {
-        return chunks.size()*Chunk::DataSize;
+        return (chunks.size() + backgroundSweptChunks)*Chunk::DataSize;
     }
     size_t usedMem() const {
         uint used = 0;
@@ -139,18 +147,22 @@ struct BlockAllocator {
         return used;
     }
 
-    void sweep();
+    void sweep(BackgroundSweeper *backgroundSweeper = nullptr);
+    void finishBackgroundSweep(BackgroundSweeper *backgroundSweeper);
     void freeAll();
     void resetBlackBits();
+    void rebuildFreeLists();
 
     // bump allocations
     HeapItem *nextFree = nullptr;
     size_t nFree = 0;
     size_t usedSlotsAfterLastSweep = 0;
+    size_t allocatedSlotsSinceLastSweep = 0;
     HeapItem *freeBins[NumBins];
     ChunkAllocator *chunkAllocator;
     ExecutionEngine *engine;
     std::vector<Chunk *> chunks;
+    size_t backgroundSweptChunks = 0; // still owned by us while the background sweeper has them
     uint *allocationStats = nullptr;
 };
 
@@ -212,7 +224,11 @@ public:
     {
         Q_STATIC_ASSERT(std::is_trivial_v<typename ManagedType::Data>);
         size = align(size);
-        typename ManagedType::Data *d = static_cast<typename ManagedType::Data *>(allocData(size));
+        typename ManagedType::Data *d;
+        if constexpr (std::is_base_of_v<ArrayData, ManagedType> || std::is_same_v<ManagedType, MemberData>)
+            d = static_cast<typename ManagedType::Data *>(allocRelocatableData(size));
+        else
+            d = static_cast<typename ManagedType::Data *>(allocData(size));
         d->internalClass.set(engine, ic);
         Q_ASSERT(d->internalClass && d->internalClass->vtable);
         Q_ASSERT(ic->vtable == ManagedType::staticVTable());
@@ -328,7 +344,26 @@ public:
     bool tryForceGCCompletion();
     void runFullGC();
 
+    bool isGenerational() const { return generationalGC; }
+    /* In generational mode, black bits survive the sweep phase: everything that is
+       black outside of a gc cycle belongs to the old generation, and the write barrier
+       stays active to remember young objects which get stored into old ones.
+    */
+    bool isRecordingRememberedSet() const
+    {
+        return generationalGC && !gcStateMachine->inProgress();
+    }
+
     void dumpStats() const;
+    bool writeHeapSnapshot(QIODevice *device);
+    static bool keepsWrapperAlive(QObject *object);
+
+    // moves items out of sparsely used chunks of the dataAllocator, and gives those back to the OS
+    bool compact();
+    void requestCompactionIfFragmented();
+
+    std::vector<quintptr> takeBlackBits();
+    void restoreBlackBits(const std::vector<quintptr> &blackBits);
 
     size_t getUsedMem() const;
     size_t getAllocatedMem() const;
@@ -345,6 +380,9 @@ public:
     typename ManagedType::Data *allocIC()
     {
         Heap::Base *b = *allocate(&icAllocator, align(sizeof(typename ManagedType::Data)));
+        // internal classes are swept last, allocate them black until then
+        if (Q_UNLIKELY(internalClassSweepPending))
+            b->setMarkBit();
         return static_cast<typename ManagedType::Data *>(b);
     }
 
@@ -361,31 +399,38 @@ protected:
     /// expects size to be aligned
     Heap::Base *allocString(std::size_t unmanagedSize);
     Heap::Base *allocData(std::size_t size);
+    Heap::Base *allocRelocatableData(std::size_t size);
     Heap::Object *allocObjectWithMemberData(const QV4::VTable *vtable, uint nMembers);
 
 private:
     enum {
-        MinUnmanagedHeapSizeGCLimit = 128 * 1024
+        MinUnmanagedHeapSizeGCLimit = 128 * 1024,
+        // chunks using at most 1/CompactionOccupancyDivisor of their slots get evacuated
+        CompactionOccupancyDivisor = 4,
+        MinCompactedChunks = 2
     };
 
+    std::vector<Chunk *> sparselyUsedChunks() const;
+
 public:
     void collectFromJSStack(MarkStack *markStack) const;
     void sweep(bool lastSweep = false, ClassDestroyStatsCallback classCountPtr = nullptr);
     void cleanupDeletedQObjectWrappersInSweep();
     bool isAboveUnmanagedHeapLimit()
     {
-        const bool incrementalGCIsAlreadyRunning = m_markStack != nullptr;
+        const bool incrementalGCIsAlreadyRunning = gcStateMachine->inProgress();
         const bool aboveUnmanagedHeapLimit = incrementalGCIsAlreadyRunning
                 ? unmanagedHeapSize > 3 * unmanagedHeapSizeGCLimit / 2
                 : unmanagedHeapSize > unmanagedHeapSizeGCLimit;
         return aboveUnmanagedHeapLimit;
     }
+    bool shouldRunMajorCollection() const;
 private:
     bool shouldRunGC() const;
 
     HeapItem *allocate(BlockAllocator *allocator, std::size_t size)
     {
-        const bool incrementalGCIsAlreadyRunning = m_markStack != nullptr;
+        const bool incrementalGCIsAlreadyRunning = gcStateMachine->inProgress();
 
         bool didGCRun = false;
         if (aggressiveGC) {
@@ -416,6 +461,7 @@ public:
     ChunkAllocator *chunkAllocator;
     BlockAllocator blockAllocator;
     BlockAllocator icAllocator;
+    BlockAllocator dataAllocator; // MemberData and ArrayData, only used if compactingGC is set
     HugeItemAllocator hugeItemAllocator;
     PersistentValueStorage *m_persistentValues;
     PersistentValueStorage *m_weakValues;
@@ -425,16 +471,27 @@ public:
 
     std::unique_ptr<GCStateMachine> gcStateMachine{nullptr};
     std::unique_ptr<MarkStack> m_markStack{nullptr};
+    std::unique_ptr<ParallelMarkPool> parallelMarkPool{nullptr};
+    std::unique_ptr<BackgroundSweeper> backgroundSweeper{nullptr};
 
     std::size_t unmanagedHeapSize = 0; // the amount of bytes of heap that is not managed by the memory manager, but which is held onto by managed items.
     std::size_t unmanagedHeapSizeGCLimit;
     std::size_t usedSlotsAfterLastFullSweep = 0;
+    std::size_t usedSlotsAfterLastMajorSweep = 0;
+    std::size_t nurserySlots = 0; // young slots allocated before a minor collection is due
+    uint minorCollectionsSinceMajor = 0;
 
     enum Blockness : quint8 {Unblocked, NormalBlocked, InCriticalSection };
     Blockness gcBlocked = Unblocked;
     bool aggressiveGC = false;
     bool gcStats = false;
     bool gcCollectorStats = false;
+    bool generationalGC = false;
+    bool minorCollection = false; // the current (or last) gc cycle only collects young objects
+    bool majorCollectionRequested = false;
+    bool internalClassSweepPending = false; // between the DoSweep and FinishSweep states
+    bool compactingGC = false;
+    bool compactionRequested = false;
 
     int allocationCount = 0;
     size_t lastAllocRequestedSlots = 0;
@@ -443,6 +500,14 @@ public:
         size_t maxReservedMem = 0;
         size_t maxAllocatedMem = 0;
         size_t maxUsedMem = 0;
+        uint minorCollections = 0;
+        uint majorCollections = 0;
+        uint parallelMarkRounds = 0;
+        quint64 parallelMarkPackets = 0; // packets of work taken by the parallel markers
+        uint evacuatedChunks = 0;
+        quint64 ropeFlattenings = 0;
+        quint64 flattenedCharacters = 0;
+        quint64 ropeAccesses = 0; // rope-aware accesses that didn't flatten the string
         uint allocations[BlockAllocator::NumBins];
     } statistics;
 };
@@ -478,7 +543,7 @@ struct GCCriticalSection {
            if necessary*/
         if (!m_engine->memoryManager->isAboveUnmanagedHeapLimit())
             return;
-        if (!m_engine->isGCOngoing) {
+        if (!m_engine->memoryManager->gcStateMachine->inProgress()) {
             m_engine->memoryManager->runGC();
         } else {
             [[maybe_unused]] bool gcFinished = m_engine->memoryManager->tryForceGCCompletion();
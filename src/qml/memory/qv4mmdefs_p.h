@@ -19,6 +19,8 @@
 #include <QtCore/qalgorithms.h>
 #include <QtCore/qmath.h>
 
+#include <atomic>
+
 QT_BEGIN_NAMESPACE
 
 class QDeadlineTimer;
@@ -26,6 +28,8 @@ class QDeadlineTimer;
 namespace QV4 {
 
 struct MarkStack;
+struct ParallelMarkWorker;
+struct ParallelMarkPool;
 
 typedef void(*ClassDestroyStatsCallback)(const char *);
 
@@ -100,6 +104,17 @@ struct Chunk {
         quintptr bit = bitForIndex(index);
         *bitmap &= ~bit;
     }
+    // Returns true if the bit was not set before. Used when several threads mark in parallel.
+    static bool testAndSetBitAtomic(quintptr *bitmapEntry, quintptr bit) {
+        static_assert(sizeof(std::atomic<quintptr>) == sizeof(quintptr));
+        auto *entry = reinterpret_cast<std::atomic<quintptr> *>(bitmapEntry);
+        return !(entry->fetch_or(bit, std::memory_order_relaxed) & bit);
+    }
+    // Reads a bitmap entry that other threads may be setting bits in with testAndSetBitAtomic().
+    static bool testBitAtomic(const quintptr *bitmapEntry, quintptr bit) {
+        auto *entry = reinterpret_cast<const std::atomic<quintptr> *>(bitmapEntry);
+        return entry->load(std::memory_order_relaxed) & bit;
+    }
     static bool testBit(quintptr *bitmap, size_t index) {
 //        Q_ASSERT(index >= HeaderSize/SlotSize && index < ChunkSize/SlotSize);
         bitmap += bitmapIndex(index);
@@ -229,8 +244,22 @@ Q_STATIC_ASSERT(sizeof(HeapItem) == Chunk::SlotSize);
 Q_STATIC_ASSERT(QT_POINTER_SIZE*8 == Chunk::Bits);
 Q_STATIC_ASSERT((1 << Chunk::BitShift) == Chunk::Bits);
 
+/*
+ * Receives the items pushed onto a MarkStack that was created for it, instead of having them
+ * marked transitively. Used to walk the references of single items, see HeapSnapshotBuilder and
+ * MemoryManager::compact().
+ */
+struct EdgeCollector {
+    virtual ~EdgeCollector() = default;
+    virtual void takeEdges(Heap::Base **begin, Heap::Base **end) = 0;
+};
+
 struct Q_QML_EXPORT MarkStack {
     MarkStack(ExecutionEngine *engine);
+    // a mark stack of one of the threads taking part in parallel marking
+    MarkStack(ExecutionEngine *engine, Heap::Base **base, size_t size, ParallelMarkWorker *worker);
+    // a mark stack that records the references of an object instead of marking transitively
+    MarkStack(ExecutionEngine *engine, Heap::Base **base, size_t size, EdgeCollector *collector);
     ~MarkStack() { /* we drain manually */ }
 
     void push(Heap::Base *m) {
@@ -253,6 +282,10 @@ struct Q_QML_EXPORT MarkStack {
     }
 
     bool isEmpty() const { return m_top == m_base; }
+    qptrdiff size() const { return m_top - m_base; }
+
+    // if set, black bits need to be set atomically as other threads are marking, too
+    bool isParallel() const { return m_parallelWorker != nullptr; }
 
     qptrdiff remainingBeforeSoftLimit() const
     {
@@ -261,11 +294,17 @@ struct Q_QML_EXPORT MarkStack {
 
     ExecutionEngine *engine() const { return m_engine; }
 
+    // between generational gc cycles, the entries form the remembered set
+    Heap::Base *const *begin() const { return m_base; }
+    Heap::Base *const *end() const { return m_top; }
+
     void drain();
     enum class DrainState { Ongoing, Complete };
     DrainState drain(QDeadlineTimer deadline);
+    DrainState drainInParallel(QDeadlineTimer deadline, ParallelMarkPool *pool);
     void setSoftLimit(size_t size);
 private:
+    friend struct ParallelMarkWorker;
     Heap::Base *pop() { return *(--m_top); }
 
     Heap::Base **m_top = nullptr;
@@ -274,6 +313,8 @@ private:
     Heap::Base **m_hardLimit = nullptr;
 
     ExecutionEngine *m_engine = nullptr;
+    ParallelMarkWorker *m_parallelWorker = nullptr;
+    EdgeCollector *m_edgeCollector = nullptr;
 
     quintptr m_drainRecursion = 0;
 };
@@ -11,13 +11,22 @@ namespace {
             return;
         base->mark(markStack);
     }
+
+    /* Outside of a gc cycle, the generational mode only needs to remember stores
+       into old (black) objects. Young objects get traced anyway if they are still
+       reachable during the next minor collection. */
+    bool isStoreIntoYoungObject(QV4::EngineBase *engine, QV4::Heap::Base *base)
+    {
+        return base && engine->memoryManager->isRecordingRememberedSet() && !base->isMarked();
+    }
 }
 namespace QV4 {
 
 void WriteBarrier::write_slowpath(EngineBase *engine, Heap::Base *base, ReturnedValue *slot, ReturnedValue value)
 {
-    Q_UNUSED(base);
     Q_UNUSED(slot);
+    if (isStoreIntoYoungObject(engine, base))
+        return;
     MarkStack * markStack = engine->memoryManager->markStack();
     if constexpr (isInsertionBarrier)
         markHeapBase(markStack, Value::fromReturnedValue(value).heapObject());
@@ -25,8 +34,9 @@ void WriteBarrier::write_slowpath(EngineBase *engine, Heap::Base *base, Returned
 
 void WriteBarrier::write_slowpath(EngineBase *engine, Heap::Base *base, Heap::Base **slot, Heap::Base *value)
 {
-    Q_UNUSED(base);
     Q_UNUSED(slot);
+    if (isStoreIntoYoungObject(engine, base))
+        return;
     MarkStack * markStack = engine->memoryManager->markStack();
     if constexpr (isInsertionBarrier)
         markHeapBase(markStack, value);
@@ -119,10 +119,11 @@ public:
     inline bool equals(const QV4::String *string) const {
         if (length != string->d()->length() || hash != string->hashValue())
                 return false;
+        // Compare without converting the string, which may be stored as Latin-1.
         if (isQString()) {
-            return QStringView(utf16Data(), length) == string->toQString();
+            return string->d()->textEquals(QStringView(utf16Data(), length));
         } else {
-            return QLatin1String(cStrData(), length) == string->toQString();
+            return string->d()->textEquals(QLatin1StringView(cStrData(), length));
         }
     }
 
@@ -26,8 +26,12 @@
 
 #include <QVariant>
 #include <QtCore/qdebug.h>
+#include <QtCore/qvarlengtharray.h>
 #include <QVector>
 
+#include <functional>
+#include <queue>
+
 QT_BEGIN_NAMESPACE
 
 Q_TRACE_POINT(qtqml, QQmlBinding_entry, const QQmlEngine *engine, const QString &function, const QString &fileName, int line, int column)
@@ -141,12 +145,7 @@ void QQmlBinding::update(QQmlPropertyData::WriteFlags flags)
 
     // Check for a binding update loop
     if (Q_UNLIKELY(updatingFlag())) {
-        const QQmlPropertyData *d = nullptr;
-        QQmlPropertyData vtd;
-        getPropertyData(&d, &vtd);
-        Q_ASSERT(d);
-        QQmlProperty p = QQmlPropertyPrivate::restore(targetObject(), *d, &vtd, nullptr);
-        printBindingLoopError(p);
+        reportBindingLoop();
         return;
     }
     setUpdatingFlag(true);
@@ -168,6 +167,16 @@ void QQmlBinding::update(QQmlPropertyData::WriteFlags flags)
         setUpdatingFlag(false);
 }
 
+void QQmlBinding::reportBindingLoop()
+{
+    const QQmlPropertyData *d = nullptr;
+    QQmlPropertyData vtd;
+    getPropertyData(&d, &vtd);
+    Q_ASSERT(d);
+    QQmlProperty p = QQmlPropertyPrivate::restore(targetObject(), *d, &vtd, nullptr);
+    printBindingLoopError(p);
+}
+
 void QQmlBinding::printBindingLoopError(const QQmlProperty &prop)
 {
     qmlWarning(prop.object()) << QString(QLatin1String("Binding loop detected for property \"%1\":\n%2"))
@@ -614,6 +623,14 @@ QVariant QQmlBinding::evaluate()
 
 void QQmlBinding::expressionChanged()
 {
+    if (QQmlEngine *qmlEngine = engine()) {
+        QQmlEnginePrivate *ep = QQmlEnginePrivate::get(qmlEngine);
+        if (ep->deferBindingUpdates) {
+            ep->queueBindingUpdate(this);
+            return;
+        }
+    }
+
     update();
 }
 
@@ -678,6 +695,88 @@ bool QQmlBinding::hasDependencies() const
     return !activeGuards.isEmpty() || qpropertyChangeTriggers;
 }
 
+void QQmlBinding::sortByDependencies(std::vector<QQmlAbstractBinding::Ptr> *bindings)
+{
+    const qsizetype count = qsizetype(bindings->size());
+    if (count < 2)
+        return;
+
+    const auto bindingAt = [bindings](qsizetype i) {
+        return static_cast<QQmlBinding *>((*bindings)[i].data());
+    };
+
+    // The notify signal of the target property of each binding
+    QHash<std::pair<QObject *, int>, qsizetype> writers;
+    for (qsizetype i = 0; i < count; ++i) {
+        QQmlBinding *binding = bindingAt(i);
+        QObject *target = binding->targetObject();
+        if (!binding->enabledFlag() || !target || QQmlData::wasDeleted(target))
+            continue;
+        const QQmlPropertyData *core = nullptr;
+        binding->getPropertyData(&core, nullptr);
+        if (core->notifyIndex() != -1)
+            writers.insert({ target, core->notifyIndex() }, i);
+    }
+
+    if (writers.isEmpty())
+        return;
+
+    std::vector<QVarLengthArray<qsizetype, 4>> dependents(count);
+    std::vector<int> dependencyCounts(count, 0);
+    bool hasDependencies = false;
+    for (qsizetype i = 0; i < count; ++i) {
+        const auto &guards = bindingAt(i)->activeGuards;
+        for (QQmlJavaScriptExpressionGuard *guard = guards.first(); guard; guard = guards.next(guard)) {
+            if (guard->signalIndex() == -1) // guard's sender is a QQmlNotifier, not a QObject*.
+                continue;
+            const auto writer = writers.constFind({ guard->senderAsObject(), guard->signalIndex() });
+            if (writer == writers.constEnd() || *writer == i)
+                continue;
+            dependents[*writer].append(i);
+            ++dependencyCounts[i];
+            hasDependencies = true;
+        }
+    }
+
+    if (!hasDependencies)
+        return;
+
+    // Kahn's algorithm. Among the bindings that are ready, keep the given order.
+    std::priority_queue<qsizetype, std::vector<qsizetype>, std::greater<qsizetype>> ready;
+    for (qsizetype i = 0; i < count; ++i) {
+        if (dependencyCounts[i] == 0)
+            ready.push(i);
+    }
+
+    std::vector<QQmlAbstractBinding::Ptr> sorted;
+    sorted.reserve(count);
+    std::vector<bool> done(count, false);
+    qsizetype firstPending = 0;
+    while (qsizetype(sorted.size()) < count) {
+        qsizetype next;
+        if (!ready.empty()) {
+            next = ready.top();
+            ready.pop();
+            if (done[next])
+                continue;
+        } else {
+            // A cycle. Break it at the first binding left over.
+            while (done[firstPending])
+                ++firstPending;
+            next = firstPending;
+        }
+
+        done[next] = true;
+        sorted.push_back((*bindings)[next]);
+        for (qsizetype dependent : std::as_const(dependents[next])) {
+            if (--dependencyCounts[dependent] == 0)
+                ready.push(dependent);
+        }
+    }
+
+    bindings->swap(sorted);
+}
+
 void QQmlBinding::doUpdate(const DeleteWatcher &watcher, QQmlPropertyData::WriteFlags flags, QV4::Scope &scope)
 {
     auto ep = QQmlEnginePrivate::get(scope.engine);
@@ -26,6 +26,8 @@
 #include <private/qv4functionobject_p.h>
 #include <private/qqmltranslation_p.h>
 
+#include <vector>
+
 QT_BEGIN_NAMESPACE
 
 class QQmlContext;
@@ -74,6 +76,7 @@ public:
     void update(QQmlPropertyData::WriteFlags flags = QQmlPropertyData::DontRemoveBinding);
 
     void printBindingLoopError(const QQmlProperty &prop) override;
+    void reportBindingLoop();
 
     typedef int Identifier;
     enum {
@@ -106,6 +109,10 @@ public:
     // This method is used internally to check whether a binding is constant and can be removed
     virtual bool hasDependencies() const;
 
+    // Sorts the given bindings so that bindings are updated after the bindings they depend on.
+    // Cycles, and dependencies that can't be traced back to a property, keep the given order.
+    static void sortByDependencies(std::vector<QQmlAbstractBinding::Ptr> *bindings);
+
 protected:
     virtual void doUpdate(const DeleteWatcher &watcher,
                   QQmlPropertyData::WriteFlags flags, QV4::Scope &scope);
@@ -63,6 +63,7 @@ QQmlDataBlob::QQmlDataBlob(const QUrl &url, Type type, QQmlTypeLoader *manager)
     , m_redirectCount(0)
     , m_inCallback(false)
     , m_isDone(false)
+    , m_isCompilingSource(false)
 {
 }
 
@@ -317,6 +318,32 @@ void QQmlDataBlob::setError(const QString &description)
     setError(e);
 }
 
+/*!
+Calls compileSource() followed by sourceCompiled(). If the type loader has a compile pool,
+compileSource() runs on one of its threads, and sourceCompiled() is called on the load thread
+once it has finished. The blob stays in the Loading state until then.
+
+This method may only be called from within dataReceived().
+*/
+void QQmlDataBlob::scheduleSourceCompilation()
+{
+    assertTypeLoaderThread();
+    Q_ASSERT(status() == Loading);
+    Q_ASSERT(!m_isCompilingSource);
+
+    // The URL strings are cached on first use. Make sure a compile thread only reads them.
+    urlString();
+    finalUrlString();
+
+    m_isCompilingSource = true;
+    if (m_typeLoader->thread()->startCompileJob(this))
+        return;
+
+    m_isCompilingSource = false;
+    compileSource();
+    sourceCompiled();
+}
+
 /*!
 Wait for \a blob to become complete or to error.  If \a blob is already
 complete or in error, or this blob is already complete, this has no effect.
@@ -469,6 +496,28 @@ void QQmlDataBlob::allDependenciesDone()
     setStatus(QQmlDataBlob::ResolvingDependencies);
 }
 
+/*!
+Called after compileSource() has finished. Errors encountered by compileSource() should be
+reported here, as setError() may only be called on the load thread.
+
+The default implementation does nothing.
+*/
+void QQmlDataBlob::sourceCompiled()
+{
+    assertTypeLoaderThread();
+}
+
+/*!
+Invoked by scheduleSourceCompilation(), either on the load thread or on a thread of the type
+loader's compile pool. Implementors should only touch the state that is specific to the
+compilation here, and must not call setError() or addDependency().
+
+The default implementation does nothing.
+*/
+void QQmlDataBlob::compileSource()
+{
+}
+
 /*!
 Called when the download progress of this blob changes.  \a progress goes
 from 0 to 1.
@@ -128,6 +128,7 @@ protected:
     void setError(const QQmlJS::DiagnosticMessage &error);
     void setError(const QString &description);
     void addDependency(const QQmlDataBlob::Ptr &);
+    void scheduleSourceCompilation();
 
     // Callbacks made in load thread
     virtual void dataReceived(const SourceCodeData &) = 0;
@@ -139,6 +140,10 @@ protected:
     virtual void dependencyError(const QQmlDataBlob::Ptr &);
     virtual void dependencyComplete(const QQmlDataBlob::Ptr &);
     virtual void allDependenciesDone();
+    virtual void sourceCompiled();
+
+    // Callbacks made in load thread or a compile thread
+    virtual void compileSource();
 
     // Callbacks made in main thread
     virtual void downloadProgressChanged(qreal);
@@ -266,9 +271,10 @@ private:
     // List of QQmlDataBlob's that I am waiting for to complete.
     QVector<QQmlRefPointer<QQmlDataBlob>> m_waitingFor;
 
-    int m_redirectCount:30;
+    int m_redirectCount:29;
     bool m_inCallback:1;
     bool m_isDone:1;
+    bool m_isCompilingSource:1;
 };
 
 QT_END_NAMESPACE
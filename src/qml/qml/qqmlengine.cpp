@@ -5,6 +5,7 @@
 #include "qqmlengine.h"
 
 #include <private/qqmlabstractbinding_p.h>
+#include <private/qqmlbinding_p.h>
 #include <private/qqmlboundsignal_p.h>
 #include <private/qqmlcontext_p.h>
 #include <private/qqmlnotifier_p.h>
@@ -36,6 +37,8 @@
 #include <QtCore/qstorageinfo.h>
 #include <QtCore/qthread.h>
 
+#include <algorithm>
+
 #if QT_CONFIG(qml_network)
 #include <QtQml/qqmlnetworkaccessmanagerfactory.h>
 #include <QtNetwork/qnetworkaccessmanager.h>
@@ -481,6 +484,8 @@ void QQmlEnginePrivate::init()
     q->handle()->setQmlEngine(q);
 
     rootContext = new QQmlContext(q,true);
+
+    deferBindingUpdates = !qEnvironmentVariableIsEmpty("QML_DEFERRED_BINDING_UPDATES");
 }
 
 /*!
@@ -537,6 +542,10 @@ QQmlEngine::~QQmlEngine()
     handle()->inShutdown = true;
     QJSEnginePrivate::removeFromDebugServer(this);
 
+    // Anything that changes from here on is updated right away.
+    d->deferBindingUpdates = false;
+    d->clearBindingUpdates();
+
     // Emit onDestruction signals for the root context before
     // we destroy the contexts, engine, Singleton Types etc. that
     // may be required to handle the destruction signal.
@@ -1133,6 +1142,12 @@ void QQmlEngine::setContextForObject(QObject *object, QQmlContext *context)
     contextData->addOwnedObject(data);
 }
 
+static QEvent::Type bindingUpdatesEventType()
+{
+    static const int type = QEvent::registerEventType();
+    return QEvent::Type(type);
+}
+
 /*!
    \reimp
 */
@@ -1140,6 +1155,11 @@ bool QQmlEngine::event(QEvent *e)
 {
     if (e->type() == QEvent::LanguageChange) {
         retranslate();
+    } else if (e->type() == bindingUpdatesEventType()) {
+        Q_D(QQmlEngine);
+        d->bindingUpdatesEventPosted = false;
+        d->flushBindingUpdates();
+        return true;
     }
 
     return QJSEngine::event(e);
@@ -1575,6 +1595,112 @@ QList<QQmlError> QQmlEnginePrivate::qmlErrorFromDiagnostics(
     return errors;
 }
 
+namespace {
+    // The engines of the current thread that have binding updates queued.
+    thread_local std::vector<QQmlEnginePrivate *> enginesWithBindingUpdates;
+
+    // Updating the queued bindings must settle after a few rounds, unless there is a loop.
+    constexpr int MaxBindingUpdateRounds = 1000;
+}
+
+void QQmlEnginePrivate::queueBindingUpdate(QQmlBinding *binding)
+{
+    if (pendingBindingUpdates.contains(binding)) {
+        ++bindingUpdateStatistics.coalesced;
+        return;
+    }
+
+    // The binding can outlive its target in the queue. Guard the target, so that we can tell.
+    QObject *target = binding->targetObject();
+    if (QQmlData::wasDeleted(target))
+        return;
+    pendingBindingUpdates.insert(binding, target);
+    queuedBindingUpdates.emplace_back(binding);
+    ++bindingUpdateStatistics.queued;
+
+    // A running flush picks the binding up in its next round.
+    if (flushingBindingUpdates)
+        return;
+
+    if (std::find(enginesWithBindingUpdates.cbegin(), enginesWithBindingUpdates.cend(), this)
+            == enginesWithBindingUpdates.cend()) {
+        enginesWithBindingUpdates.push_back(this);
+    }
+
+    if (!bindingUpdatesEventPosted) {
+        bindingUpdatesEventPosted = true;
+        // High priority, so that we run before any update requests that are already posted.
+        QCoreApplication::postEvent(q_func(), new QEvent(bindingUpdatesEventType()),
+                                    Qt::HighEventPriority);
+    }
+}
+
+void QQmlEnginePrivate::flushBindingUpdates()
+{
+    if (flushingBindingUpdates || queuedBindingUpdates.empty())
+        return;
+
+    flushingBindingUpdates = true;
+    for (int round = 0; !queuedBindingUpdates.empty(); ++round) {
+        std::vector<QQmlAbstractBinding::Ptr> bindings;
+        bindings.swap(queuedBindingUpdates);
+
+        // Drop the bindings whose target was deleted after they were queued.
+        bindings.erase(std::remove_if(bindings.begin(), bindings.end(),
+                                      [this](const QQmlAbstractBinding::Ptr &binding) {
+            const QPointer<QObject> target = pendingBindingUpdates.value(binding.data());
+            if (!QQmlData::wasDeleted(target.data()))
+                return false;
+            pendingBindingUpdates.remove(binding.data());
+            return true;
+        }), bindings.end());
+
+        if (round == MaxBindingUpdateRounds) {
+            for (const QQmlAbstractBinding::Ptr &binding : bindings)
+                static_cast<QQmlBinding *>(binding.data())->reportBindingLoop();
+            pendingBindingUpdates.clear();
+            break;
+        }
+
+        QQmlBinding::sortByDependencies(&bindings);
+        for (const QQmlAbstractBinding::Ptr &binding : bindings) {
+            // Notifications from here on queue the binding again, for the next round.
+            const QPointer<QObject> target = pendingBindingUpdates.take(binding.data());
+            // An update earlier in this round may have deleted the target.
+            if (QQmlData::wasDeleted(target.data()))
+                continue;
+            static_cast<QQmlBinding *>(binding.data())->update();
+            ++bindingUpdateStatistics.evaluated;
+        }
+    }
+    flushingBindingUpdates = false;
+
+    enginesWithBindingUpdates.erase(
+            std::remove(enginesWithBindingUpdates.begin(), enginesWithBindingUpdates.end(), this),
+            enginesWithBindingUpdates.end());
+}
+
+void QQmlEnginePrivate::clearBindingUpdates()
+{
+    queuedBindingUpdates.clear();
+    pendingBindingUpdates.clear();
+    enginesWithBindingUpdates.erase(
+            std::remove(enginesWithBindingUpdates.begin(), enginesWithBindingUpdates.end(), this),
+            enginesWithBindingUpdates.end());
+}
+
+void QQmlEnginePrivate::flushAllBindingUpdates()
+{
+    // Flushing one engine changes the list, and may even delete another engine.
+    const std::vector<QQmlEnginePrivate *> engines = enginesWithBindingUpdates;
+    for (QQmlEnginePrivate *engine : engines) {
+        if (std::find(enginesWithBindingUpdates.cbegin(), enginesWithBindingUpdates.cend(), engine)
+                != enginesWithBindingUpdates.cend()) {
+            engine->flushBindingUpdates();
+        }
+    }
+}
+
 void QQmlEnginePrivate::cleanupScarceResources()
 {
     // iterate through the list and release them all.
@@ -22,6 +22,7 @@
 #include <private/qjsengine_p.h>
 #include <private/qjsvalue_p.h>
 #include <private/qpodvector_p.h>
+#include <private/qqmlabstractbinding_p.h>
 #include <private/qqmldirparser_p.h>
 #include <private/qqmlimport_p.h>
 #include <private/qqmlmetatype_p.h>
@@ -46,10 +47,12 @@
 #include <QtCore/qthread.h>
 
 #include <atomic>
+#include <vector>
 
 QT_BEGIN_NAMESPACE
 
 class QNetworkAccessManager;
+class QQmlBinding;
 class QQmlDelayedError;
 class QQmlIncubator;
 class QQmlMetaObject;
@@ -154,6 +157,25 @@ public:
 
     QString offlineStoragePath;
 
+    // With QML_DEFERRED_BINDING_UPDATES set, bindings whose dependencies change are queued
+    // instead of being updated right away. The queue is flushed when the engine gets back to
+    // the event loop, or before a window polishes its items, whichever comes first. Each binding
+    // is then updated once, after the bindings it depends on.
+    struct BindingUpdateStatistics
+    {
+        quint64 queued = 0;     // Updates that were queued
+        quint64 coalesced = 0;  // Notifications for bindings that were queued already
+        quint64 evaluated = 0;  // Updates run by flushBindingUpdates()
+    };
+
+    bool deferBindingUpdates = false;
+    BindingUpdateStatistics bindingUpdateStatistics;
+    void queueBindingUpdate(QQmlBinding *binding);
+    void flushBindingUpdates();
+    void clearBindingUpdates();
+    // Flushes the queued binding updates of all engines living in the current thread.
+    static void flushAllBindingUpdates();
+
     // Unfortunate workaround to avoid a circular dependency between
     // qqmlengine_p.h and qqmlincubator_p.h
     struct Incubator {
@@ -285,6 +307,12 @@ private:
     SingletonInstances singletonInstances;
     QHash<int, QQmlGadgetPtrWrapper *> cachedValueTypeInstances;
 
+    std::vector<QQmlAbstractBinding::Ptr> queuedBindingUpdates;
+    // Queued, but not updated yet, with their targets
+    QHash<QQmlAbstractBinding *, QPointer<QObject>> pendingBindingUpdates;
+    bool bindingUpdatesEventPosted = false;
+    bool flushingBindingUpdates = false;
+
     static bool s_designerMode;
 
     void cleanupScarceResources();
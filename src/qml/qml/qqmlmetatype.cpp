@@ -24,11 +24,17 @@ QT_BEGIN_NAMESPACE
 struct LockedData : private QQmlMetaTypeData
 {
     friend class QQmlMetaTypeDataPtr;
+    friend class QQmlMetaTypeSnapshotPtr;
 };
 
 Q_GLOBAL_STATIC(LockedData, metaTypeData)
 Q_GLOBAL_STATIC(QRecursiveMutex, metaTypeDataLock)
 
+namespace {
+    // How often the current thread holds metaTypeDataLock.
+    Q_CONSTINIT thread_local int metaTypeDataLockDepth = 0;
+}
+
 struct ModuleUri : public QString
 {
     ModuleUri(const QString &string) : QString(string) {}
@@ -39,8 +45,11 @@ class QQmlMetaTypeDataPtr
 {
     Q_DISABLE_COPY_MOVE(QQmlMetaTypeDataPtr)
 public:
-    QQmlMetaTypeDataPtr() : locker(metaTypeDataLock()), data(metaTypeData()) {}
-    ~QQmlMetaTypeDataPtr() = default;
+    QQmlMetaTypeDataPtr() : locker(metaTypeDataLock()), data(metaTypeData())
+    {
+        ++metaTypeDataLockDepth;
+    }
+    ~QQmlMetaTypeDataPtr() { --metaTypeDataLockDepth; }
 
     QQmlMetaTypeData &operator*() { return *data; }
     QQmlMetaTypeData *operator->() { return data; }
@@ -57,6 +66,87 @@ private:
     LockedData *data = nullptr;
 };
 
+/*
+    Gives access to the published snapshot of the lookup tables without taking metaTypeDataLock.
+    If there is none, because the tables have changed since the last one was taken, a new one is
+    published under the lock. As long as a QQmlMetaTypeSnapshotPtr is alive,
+    QQmlMetaTypeData::invalidateLookupSnapshots() waits for it, so that nothing the snapshot points
+    to can be deleted. Therefore, keep it short-lived and don't call into QQmlMetaType while
+    holding it.
+
+    If the snapshot isn't valid, fall back to QQmlMetaTypeDataPtr. This happens if the thread
+    already holds the lock, as it may be in the middle of changing the tables, or if the data has
+    been destroyed.
+*/
+class QQmlMetaTypeSnapshotPtr
+{
+    Q_DISABLE_COPY_MOVE(QQmlMetaTypeSnapshotPtr)
+public:
+    QQmlMetaTypeSnapshotPtr();
+    ~QQmlMetaTypeSnapshotPtr()
+    {
+        if (snapshot)
+            data->releaseLookupSnapshot();
+    }
+
+    const QQmlMetaTypeSnapshot &operator*() const { return *snapshot; }
+    const QQmlMetaTypeSnapshot *operator->() const { return snapshot; }
+    bool isValid() const { return snapshot != nullptr; }
+
+private:
+    LockedData *data = nullptr;
+    const QQmlMetaTypeSnapshot *snapshot = nullptr;
+};
+
+QQmlMetaTypeSnapshotPtr::QQmlMetaTypeSnapshotPtr()
+{
+    if (metaTypeDataLockDepth > 0)
+        return;
+
+    LockedData *lockedData = metaTypeData();
+    if (!lockedData)
+        return;
+
+    ++lockedData->lookupSnapshotReaders;
+    const QQmlMetaTypeSnapshot *published = lockedData->lookupSnapshot.load();
+    if (!published) {
+        lockedData->releaseLookupSnapshot();
+
+        const QQmlMetaTypeDataPtr locked;
+        if (!locked.isValid())
+            return;
+
+        // Only the lock holder can publish or drop a snapshot. We might not be the first one
+        // to get here since it was dropped.
+        published = lockedData->lookupSnapshot.load();
+        if (!published) {
+            auto *fresh = new QQmlMetaTypeSnapshot {
+                    locked->idToType, locked->nameToType, locked->metaObjectToType };
+            lockedData->lookupSnapshot = fresh;
+            published = fresh;
+        }
+
+        // Nobody can drop the snapshot before we are registered as reader, as long as we hold
+        // the lock.
+        ++lockedData->lookupSnapshotReaders;
+    }
+
+    data = lockedData;
+    snapshot = published;
+}
+
+// Runs the lookup on the published snapshot if possible, or under the lock otherwise.
+// It may only use idToType, nameToType and metaObjectToType.
+template<typename Lookup>
+static auto lookUpTables(Lookup &&lookup)
+{
+    if (const QQmlMetaTypeSnapshotPtr snapshot; snapshot.isValid())
+        return lookup(*snapshot);
+
+    const QQmlMetaTypeDataPtr data;
+    return lookup(*data);
+}
+
 static QQmlTypePrivate *createQQmlType(QQmlMetaTypeData *data,
                                        const QQmlPrivate::RegisterInterface &type)
 {
@@ -302,6 +392,7 @@ void QQmlMetaType::clearTypeRegistrations()
 {
     //Only cleans global static, assumed no running engine
     QQmlMetaTypeDataPtr data;
+    data->invalidateLookupSnapshots();
 
     data->uriToModule.clear();
     data->types.clear();
@@ -325,6 +416,7 @@ void QQmlMetaType::registerTypeAlias(int typeIndex, const QString &name)
     QQmlMetaTypeDataPtr data;
     const QQmlType type = data->types.value(typeIndex);
     const QQmlTypePrivate *priv = type.priv();
+    data->invalidateLookupSnapshots();
     data->nameToType.insert(name, priv);
 }
 
@@ -356,6 +448,7 @@ QQmlType QQmlMetaType::registerInterface(const QQmlPrivate::RegisterInterface &t
     Q_ASSERT(priv);
 
 
+    data->invalidateLookupSnapshots();
     data->idToType.insert(priv->typeId.id(), priv);
     data->idToType.insert(priv->listId.id(), priv);
 
@@ -446,6 +539,8 @@ static void addTypeToData(QQmlTypePrivate *type, QQmlMetaTypeData *data)
 {
     Q_ASSERT(type);
 
+    data->invalidateLookupSnapshots();
+
     if (!type->elementName.isEmpty())
         data->nameToType.insert(type->elementName, type);
 
@@ -1264,18 +1359,18 @@ QQmlType QQmlMetaType::qmlType(const QString &qualifiedName, QTypeRevision versi
 QQmlType QQmlMetaType::qmlType(const QHashedStringRef &name, const QHashedStringRef &module,
                                QTypeRevision version)
 {
-    const QQmlMetaTypeDataPtr data;
-
     const QHashedString key(QString::fromRawData(name.constData(), name.length()), name.hash());
-    QQmlMetaTypeData::Names::ConstIterator it = data->nameToType.constFind(key);
-    while (it != data->nameToType.cend() && it.key() == name) {
-        QQmlType t(*it);
-        if (module.isEmpty() || t.availableInVersion(module, version))
-            return t;
-        ++it;
-    }
+    return lookUpTables([&](const auto &tables) {
+        auto it = tables.nameToType.constFind(key);
+        while (it != tables.nameToType.cend() && it.key() == name) {
+            QQmlType t(*it);
+            if (module.isEmpty() || t.availableInVersion(module, version))
+                return t;
+            ++it;
+        }
 
-    return QQmlType();
+        return QQmlType();
+    });
 }
 
 /*!
@@ -1284,8 +1379,9 @@ QQmlType QQmlMetaType::qmlType(const QHashedStringRef &name, const QHashedString
 */
 QQmlType QQmlMetaType::qmlType(const QMetaObject *metaObject)
 {
-    const QQmlMetaTypeDataPtr data;
-    return QQmlType(data->metaObjectToType.value(metaObject));
+    return lookUpTables([metaObject](const auto &tables) {
+        return QQmlType(tables.metaObjectToType.value(metaObject));
+    });
 }
 
 /*!
@@ -1296,16 +1392,16 @@ QQmlType QQmlMetaType::qmlType(const QMetaObject *metaObject)
 QQmlType QQmlMetaType::qmlType(const QMetaObject *metaObject, const QHashedStringRef &module,
                                QTypeRevision version)
 {
-    const QQmlMetaTypeDataPtr data;
-
-    const auto range = data->metaObjectToType.equal_range(metaObject);
-    for (auto it = range.first; it != range.second; ++it) {
-        QQmlType t(*it);
-        if (module.isEmpty() || t.availableInVersion(module, version))
-            return t;
-    }
+    return lookUpTables([&](const auto &tables) {
+        const auto range = tables.metaObjectToType.equal_range(metaObject);
+        for (auto it = range.first; it != range.second; ++it) {
+            QQmlType t(*it);
+            if (module.isEmpty() || t.availableInVersion(module, version))
+                return t;
+        }
 
-    return QQmlType();
+        return QQmlType();
+    });
 }
 
 /*!
@@ -1327,16 +1423,18 @@ QQmlType QQmlMetaType::qmlTypeById(int qmlTypeId)
 */
 QQmlType QQmlMetaType::qmlType(QMetaType metaType)
 {
-    const QQmlMetaTypeDataPtr data;
-    QQmlTypePrivate *type = data->idToType.value(metaType.id());
-    return (type && type->typeId == metaType) ? QQmlType(type) : QQmlType();
+    return lookUpTables([metaType](const auto &tables) {
+        QQmlTypePrivate *type = tables.idToType.value(metaType.id());
+        return (type && type->typeId == metaType) ? QQmlType(type) : QQmlType();
+    });
 }
 
 QQmlType QQmlMetaType::qmlListType(QMetaType metaType)
 {
-    const QQmlMetaTypeDataPtr data;
-    QQmlTypePrivate *type = data->idToType.value(metaType.id());
-    return (type && type->listId == metaType) ? QQmlType(type) : QQmlType();
+    return lookUpTables([metaType](const auto &tables) {
+        QQmlTypePrivate *type = tables.idToType.value(metaType.id());
+        return (type && type->listId == metaType) ? QQmlType(type) : QQmlType();
+    });
 }
 
 /*!
@@ -1386,6 +1484,9 @@ QQmlPropertyCache::ConstPtr QQmlMetaType::propertyCache(QObject *obj, QTypeRevis
 QQmlPropertyCache::ConstPtr QQmlMetaType::propertyCache(
         const QMetaObject *metaObject, QTypeRevision version)
 {
+    // Property caches are not part of the lookup snapshots. They are created one by one while
+    // types are instantiated, and republishing the snapshot for each of them would be expensive.
+    // Hot callers find the cache in QQmlData instead.
     QQmlMetaTypeDataPtr data; // not const: the cache is created on demand
     return data->propertyCache(metaObject, version);
 }
@@ -1510,6 +1611,7 @@ void QQmlMetaType::unregisterType(int typeIndex)
     QQmlMetaTypeDataPtr data;
     const QQmlType type = data->types.value(typeIndex);
     if (const QQmlTypePrivate *d = type.priv()) {
+        data->invalidateLookupSnapshots();
         if (d->regType == QQmlType::CompositeType || d->regType == QQmlType::CompositeSingletonType)
             removeFromInlineComponents(data->inlineComponentTypes, d);
         removeQQmlTypePrivate(data->idToType, d);
@@ -1530,6 +1632,7 @@ void QQmlMetaType::registerMetaObjectForType(const QMetaObject *metaobject, QQml
     Q_ASSERT(type);
 
     QQmlMetaTypeDataPtr data;
+    data->invalidateLookupSnapshots();
     data->metaObjectToType.insert(metaobject, type);
 }
 
@@ -1576,6 +1679,8 @@ void QQmlMetaType::freeUnusedTypesAndCaches()
     if (!data.isValid())
         return;
 
+    data->invalidateLookupSnapshots();
+
     bool droppedAtLeastOneComposite;
     do {
         droppedAtLeastOneComposite = false;
@@ -27,6 +27,35 @@ QQmlMetaTypeData::~QQmlMetaTypeData()
     types.clear();
     undeletableTypes.clear();
     qDeleteAll(metaTypeToValueType);
+    delete lookupSnapshot.load();
+}
+
+void QQmlMetaTypeData::invalidateLookupSnapshots()
+{
+    QQmlMetaTypeSnapshot *snapshot = lookupSnapshot.exchange(nullptr);
+    if (!snapshot)
+        return;
+
+    // Readers that started before the exchange may still be using the old snapshot. Any reader
+    // that starts now finds none and waits for the lock to publish a new one.
+    {
+        QMutexLocker locker(&lookupSnapshotMutex);
+        lookupSnapshotWriterWaiting = true;
+        while (lookupSnapshotReaders.load() != 0)
+            lookupSnapshotReleased.wait(&lookupSnapshotMutex);
+        lookupSnapshotWriterWaiting = false;
+    }
+
+    delete snapshot;
+}
+
+void QQmlMetaTypeData::releaseLookupSnapshot()
+{
+    if (--lookupSnapshotReaders != 0 || !lookupSnapshotWriterWaiting.load())
+        return;
+
+    QMutexLocker locker(&lookupSnapshotMutex);
+    lookupSnapshotReleased.wakeAll();
 }
 
 // This expects a "fresh" QQmlTypePrivate and adopts its reference.
@@ -20,12 +20,17 @@
 #include <private/qhashedstring_p.h>
 #include <private/qqmlvaluetype_p.h>
 
+#include <QtCore/qmutex.h>
 #include <QtCore/qset.h>
 #include <QtCore/qvector.h>
+#include <QtCore/qwaitcondition.h>
+
+#include <atomic>
 
 QT_BEGIN_NAMESPACE
 
 class QQmlTypePrivate;
+struct QQmlMetaTypeSnapshot;
 struct QQmlMetaTypeData
 {
     QQmlMetaTypeData();
@@ -100,6 +105,18 @@ struct QQmlMetaTypeData
 
     QHash<const QMetaObject *, QQmlPropertyCache::ConstPtr> propertyCaches;
 
+    // Lookups in idToType, nameToType and metaObjectToType can use a shared, immutable copy of
+    // these tables instead of taking the lock. This has to be called, with the lock held, before
+    // the tables change and before anything they point to is deleted. It drops the copy, so that
+    // the changes don't detach the tables, and waits until no reader uses it anymore.
+    void invalidateLookupSnapshots();
+    void releaseLookupSnapshot();
+    std::atomic<QQmlMetaTypeSnapshot *> lookupSnapshot { nullptr };
+    std::atomic<int> lookupSnapshotReaders { 0 };
+    std::atomic<bool> lookupSnapshotWriterWaiting { false };
+    QMutex lookupSnapshotMutex;
+    QWaitCondition lookupSnapshotReleased;
+
     QQmlPropertyCache::ConstPtr propertyCacheForVersion(int index, QTypeRevision version) const;
     void setPropertyCacheForVersion(
             int index, QTypeRevision version, const QQmlPropertyCache::ConstPtr &cache);
@@ -126,6 +143,18 @@ private:
     QStringList *m_typeRegistrationFailures = nullptr;
 };
 
+/*
+    The lookup tables of QQmlMetaTypeData as they were when the snapshot was taken. The hashes are
+    implicitly shared with the ones in QQmlMetaTypeData, so taking a snapshot is cheap. It's never
+    changed after it has been published.
+*/
+struct QQmlMetaTypeSnapshot
+{
+    QQmlMetaTypeData::Ids idToType;
+    QQmlMetaTypeData::Names nameToType;
+    QQmlMetaTypeData::MetaObjects metaObjectToType;
+};
+
 QT_END_NAMESPACE
 
 #endif // QQMLMETATYPEDATA_P_H
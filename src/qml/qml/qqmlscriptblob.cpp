@@ -54,47 +54,62 @@ void QQmlScriptBlob::dataReceived(const SourceCodeData &data)
         return;
     }
 
+    m_sourceCode = data;
+    m_isDebugging = m_typeLoader->isDebugging();
+    scheduleSourceCompilation();
+}
+
+void QQmlScriptBlob::compileSource()
+{
+    // This may run on a thread of the compile pool. Only touch m_compiledUnit and m_sourceErrors.
     QString error;
-    QString source = data.readAll(&error);
+    QString source = m_sourceCode.readAll(&error);
     if (!error.isEmpty()) {
-        setError(error);
+        QQmlError e;
+        e.setDescription(error);
+        m_sourceErrors << e;
         return;
     }
 
-    QQmlRefPointer<QV4::CompiledData::CompilationUnit> unit;
-
     if (m_isModule) {
         QList<QQmlJS::DiagnosticMessage> diagnostics;
-        unit = QV4::Compiler::Codegen::compileModule(
-                m_typeLoader->isDebugging(), urlString(), source, data.sourceTimeStamp(),
+        m_compiledUnit = QV4::Compiler::Codegen::compileModule(
+                m_isDebugging, urlString(), source, m_sourceCode.sourceTimeStamp(),
                 &diagnostics);
-        QList<QQmlError> errors = QQmlEnginePrivate::qmlErrorFromDiagnostics(urlString(), diagnostics);
-        if (!errors.isEmpty()) {
-            setError(errors);
-            return;
-        }
-    } else {
-        QmlIR::Document irUnit(urlString(), finalUrlString(), m_typeLoader->isDebugging());
+        m_sourceErrors = QQmlEnginePrivate::qmlErrorFromDiagnostics(urlString(), diagnostics);
+        return;
+    }
 
-        irUnit.jsModule.sourceTimeStamp = data.sourceTimeStamp();
+    QmlIR::Document irUnit(urlString(), finalUrlString(), m_isDebugging);
 
-        QmlIR::ScriptDirectivesCollector collector(&irUnit);
-        irUnit.jsParserEngine.setDirectives(&collector);
+    irUnit.jsModule.sourceTimeStamp = m_sourceCode.sourceTimeStamp();
 
-        QList<QQmlError> errors;
-        irUnit.javaScriptCompilationUnit = QV4::Script::precompile(
-                     &irUnit.jsModule, &irUnit.jsParserEngine, &irUnit.jsGenerator, urlString(),
-                     source, &errors, QV4::Compiler::ContextType::ScriptImportedByQML);
+    QmlIR::ScriptDirectivesCollector collector(&irUnit);
+    irUnit.jsParserEngine.setDirectives(&collector);
 
-        source.clear();
-        if (!errors.isEmpty()) {
-            setError(errors);
-            return;
-        }
+    irUnit.javaScriptCompilationUnit = QV4::Script::precompile(
+                 &irUnit.jsModule, &irUnit.jsParserEngine, &irUnit.jsGenerator, urlString(),
+                 source, &m_sourceErrors, QV4::Compiler::ContextType::ScriptImportedByQML);
+
+    source.clear();
+    if (!m_sourceErrors.isEmpty())
+        return;
+
+    QmlIR::QmlUnitGenerator qmlGenerator;
+    qmlGenerator.generate(irUnit);
+    m_compiledUnit = std::move(irUnit.javaScriptCompilationUnit);
+}
 
-        QmlIR::QmlUnitGenerator qmlGenerator;
-        qmlGenerator.generate(irUnit);
-        unit = std::move(irUnit.javaScriptCompilationUnit);
+void QQmlScriptBlob::sourceCompiled()
+{
+    assertTypeLoaderThread();
+
+    const SourceCodeData data = std::exchange(m_sourceCode, SourceCodeData());
+    QQmlRefPointer<QV4::CompiledData::CompilationUnit> unit = std::move(m_compiledUnit);
+
+    if (!m_sourceErrors.isEmpty()) {
+        setError(std::exchange(m_sourceErrors, QList<QQmlError>()));
+        return;
     }
 
     if (m_typeLoader->writeCacheFile()) {
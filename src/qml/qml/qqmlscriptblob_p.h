@@ -43,6 +43,8 @@ public:
 protected:
     void dataReceived(const SourceCodeData &) override;
     void initializeFromCachedUnit(const QQmlPrivate::CachedQmlUnit *unit) override;
+    void compileSource() override;
+    void sourceCompiled() override;
     void done() override;
 
     QString stringAt(int index) const override;
@@ -53,6 +55,13 @@ private:
 
     QList<ScriptReference> m_scripts;
     QQmlRefPointer<QQmlScriptData> m_scriptData;
+
+    // Used while the source is compiled, possibly in a compile thread.
+    SourceCodeData m_sourceCode;
+    QQmlRefPointer<QV4::CompiledData::CompilationUnit> m_compiledUnit;
+    QList<QQmlError> m_sourceErrors;
+    bool m_isDebugging = false;
+
     const bool m_isModule;
 };
 
@@ -648,7 +648,41 @@ void QQmlTypeData::dataReceived(const SourceCodeData &data)
         return;
     }
 
-    if (!loadFromSource())
+    createDocument();
+    scheduleSourceCompilation();
+}
+
+void QQmlTypeData::compileSource()
+{
+    // This may run on a thread of the compile pool. Only touch m_document and m_sourceErrors.
+    QString sourceError;
+    const QString source = m_backupSourceCode.readAll(&sourceError);
+    if (!sourceError.isEmpty()) {
+        QQmlError e;
+        e.setDescription(sourceError);
+        m_sourceErrors << e;
+        return;
+    }
+
+    QmlIR::IRBuilder compiler;
+    if (!compiler.generateFromQml(source, finalUrlString(), m_document.data())) {
+        m_sourceErrors.reserve(compiler.errors.size());
+        for (const QQmlJS::DiagnosticMessage &msg : std::as_const(compiler.errors)) {
+            QQmlError e;
+            e.setUrl(url());
+            e.setLine(qmlConvertSourceCoordinate<quint32, int>(msg.loc.startLine));
+            e.setColumn(qmlConvertSourceCoordinate<quint32, int>(msg.loc.startColumn));
+            e.setDescription(msg.message);
+            m_sourceErrors << e;
+        }
+    }
+}
+
+void QQmlTypeData::sourceCompiled()
+{
+    assertTypeLoaderThread();
+
+    if (!takeSourceErrors())
         return;
 
     continueLoadFromIR();
@@ -683,33 +717,29 @@ bool QQmlTypeData::loadFromSource()
 {
     assertTypeLoaderThread();
 
+    createDocument();
+    compileSource();
+    return takeSourceErrors();
+}
+
+void QQmlTypeData::createDocument()
+{
+    assertTypeLoaderThread();
+
     m_document.reset(
             new QmlIR::Document(urlString(), finalUrlString(), m_typeLoader->isDebugging()));
     m_document->jsModule.sourceTimeStamp = m_backupSourceCode.sourceTimeStamp();
-    QmlIR::IRBuilder compiler;
+}
 
-    QString sourceError;
-    const QString source = m_backupSourceCode.readAll(&sourceError);
-    if (!sourceError.isEmpty()) {
-        setError(sourceError);
-        return false;
-    }
+bool QQmlTypeData::takeSourceErrors()
+{
+    assertTypeLoaderThread();
 
-    if (!compiler.generateFromQml(source, finalUrlString(), m_document.data())) {
-        QList<QQmlError> errors;
-        errors.reserve(compiler.errors.size());
-        for (const QQmlJS::DiagnosticMessage &msg : std::as_const(compiler.errors)) {
-            QQmlError e;
-            e.setUrl(url());
-            e.setLine(qmlConvertSourceCoordinate<quint32, int>(msg.loc.startLine));
-            e.setColumn(qmlConvertSourceCoordinate<quint32, int>(msg.loc.startColumn));
-            e.setDescription(msg.message);
-            errors << e;
-        }
-        setError(errors);
-        return false;
-    }
-    return true;
+    if (m_sourceErrors.isEmpty())
+        return true;
+
+    setError(std::exchange(m_sourceErrors, QList<QQmlError>()));
+    return false;
 }
 
 void QQmlTypeData::restoreIR(const QQmlRefPointer<QV4::CompiledData::CompilationUnit> &unit)
@@ -79,6 +79,8 @@ protected:
     void dataReceived(const SourceCodeData &) override;
     void initializeFromCachedUnit(const QQmlPrivate::CachedQmlUnit *unit) override;
     void allDependenciesDone() override;
+    void sourceCompiled() override;
+    void compileSource() override;
     void downloadProgressChanged(qreal) override;
 
     QString stringAt(int index) const override;
@@ -89,6 +91,8 @@ private:
     bool tryLoadFromDiskCache();
     bool loadFromDiskCache(const QQmlRefPointer<QV4::CompiledData::CompilationUnit> &unit);
     bool loadFromSource();
+    void createDocument();
+    bool takeSourceErrors();
     void restoreIR(const QQmlRefPointer<QV4::CompiledData::CompilationUnit> &unit);
     void continueLoadFromIR();
     void resolveTypes();
@@ -114,6 +118,7 @@ private:
 
     SourceCodeData m_backupSourceCode; // used when cache verification fails.
     QScopedPointer<QmlIR::Document> m_document;
+    QList<QQmlError> m_sourceErrors; // written by compileSource(), possibly in a compile thread
     QV4::CompiledData::TypeReferenceMap m_typeReferences;
 
     QList<ScriptReference> m_scripts;
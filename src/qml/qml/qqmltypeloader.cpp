@@ -27,6 +27,7 @@
 #include <QtCore/qdiriterator.h>
 #include <QtCore/qfile.h>
 #include <QtCore/qlibraryinfo.h>
+#include <QtCore/qsavefile.h>
 #include <QtCore/qthread.h>
 
 #ifdef Q_OS_MACOS
@@ -288,9 +289,189 @@ void QQmlTypeLoader::loadWithCachedUnitThread(const QQmlDataBlob::Ptr &blob, con
 {
     ASSERT_LOADTHREAD();
 
+    if (blob->type() != QQmlDataBlob::QmldirFile && QQmlFile::isSynchronous(blob->m_url))
+        recordLoad(blob->type(), blob->urlString());
     setCachedUnit(blob, unit);
 }
 
+/*!
+\internal
+Remembers that the file at \a location has been loaded as a blob of the given \a type, so that
+it can be written to the load manifest.
+*/
+void QQmlTypeLoader::recordLoad(QQmlDataBlob::Type type, const QString &location)
+{
+    ASSERT_LOADTHREAD();
+
+    // With URL interceptors in place we cannot request the same URLs again next time.
+    if (QQmlTypeLoaderConfiguredDataConstPtr(&m_data)->loadManifestPath.isEmpty()
+            || hasUrlInterceptors()) {
+        return;
+    }
+
+    QQmlTypeLoaderThreadDataPtr data(&m_data);
+    data->loadManifest.append({ type, location });
+    if (data->prefetching)
+        QQmlTypeLoaderSharedDataPtr(&m_data)->unrequestedPrefetches.insert(location);
+}
+
+/*!
+\internal
+Returns \c true if the current thread is loading files for the prefetch of the load manifest.
+*/
+bool QQmlTypeLoader::isPrefetching() const
+{
+    QQmlTypeLoaderThread *t = thread();
+    return t && t->isThisThread() && QQmlTypeLoaderThreadDataConstPtr(&m_data)->prefetching;
+}
+
+/*!
+\internal
+Remembers that the application asked for \a url, so that it is kept in the load manifest even
+if the prefetch loaded it.
+*/
+void QQmlTypeLoader::recordRequest(const QQmlTypeLoaderSharedDataPtr &data, const QUrl &url)
+{
+    if (!data->unrequestedPrefetches.isEmpty())
+        data->unrequestedPrefetches.remove(url.toString());
+}
+
+/*!
+\internal
+Loads the next qmldir file, document or script listed in the load manifest of the previous
+session, so that it is ready by the time the application asks for it. The manifest is read on
+the first call. Documents and scripts are loaded the regular way. If the files have changed in
+the mean time, they are recompiled or taken from the disk cache, as usual. Blobs that fail to
+load are removed from the cache again, so that a later request will try again.
+
+Returns \c true if there are more entries left.
+*/
+bool QQmlTypeLoader::prefetchLoadManifestThread()
+{
+    ASSERT_LOADTHREAD();
+
+    QQmlTypeLoaderThreadData::LoadManifestEntry entry;
+    {
+        QQmlTypeLoaderThreadDataPtr threadData(&m_data);
+        if (!std::exchange(threadData->loadManifestRead, true)) {
+            QFile file(QQmlTypeLoaderConfiguredDataConstPtr(&m_data)->loadManifestPath);
+            if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+                while (!file.atEnd()) {
+                    const QString line = QString::fromUtf8(file.readLine()).trimmed();
+                    const qsizetype separator = line.indexOf(QLatin1Char(' '));
+                    if (separator <= 0)
+                        continue;
+
+                    const QStringView kind = QStringView(line).left(separator);
+                    const QString location = line.mid(separator + 1);
+                    if (kind == QLatin1String("qmldir"))
+                        threadData->prefetchQueue.append({ QQmlDataBlob::QmldirFile, location });
+                    else if (kind == QLatin1String("qml"))
+                        threadData->prefetchQueue.append({ QQmlDataBlob::QmlFile, location });
+                    else if (kind == QLatin1String("js"))
+                        threadData->prefetchQueue.append({ QQmlDataBlob::JavaScriptFile, location });
+                }
+            }
+        }
+
+        if (threadData->prefetchQueue.isEmpty()) {
+            QQmlTypeLoaderSharedDataPtr(&m_data)->loadManifestPrefetchDone = true;
+            return false;
+        }
+        entry = threadData->prefetchQueue.takeFirst();
+    }
+
+    QQmlTypeLoaderThreadDataPtr(&m_data)->prefetching = true;
+    if (entry.type == QQmlDataBlob::QmldirFile) {
+        if (QFile::exists(entry.location))
+            qmldirContent(entry.location);
+    } else if (const QUrl url(entry.location); QQmlFile::isSynchronous(url)
+               && QFile::exists(QQmlFile::urlToLocalFileOrQrc(url))) {
+        const QQmlDataBlob::Ptr blob = entry.type == QQmlDataBlob::QmlFile
+                ? QQmlDataBlob::Ptr(getType(url, Asynchronous).data())
+                : QQmlDataBlob::Ptr(getScript(url, url).data());
+
+        // Let the compile pool, if any, finish the document before we check for errors.
+        thread()->finishCompileJobs();
+
+        if (blob->isError()) {
+            QQmlTypeLoaderSharedDataPtr data(&m_data);
+            if (blob->type() == QQmlDataBlob::QmlFile) {
+                if (data->typeCache.value(url).data() == blob.data())
+                    data->typeCache.remove(url);
+            } else if (data->scriptCache.value(url).data() == blob.data()) {
+                data->scriptCache.remove(url);
+            }
+        }
+    }
+    QQmlTypeLoaderThreadDataPtr(&m_data)->prefetching = false;
+
+    if (!QQmlTypeLoaderThreadDataConstPtr(&m_data)->prefetchQueue.isEmpty())
+        return true;
+    QQmlTypeLoaderSharedDataPtr(&m_data)->loadManifestPrefetchDone = true;
+    return false;
+}
+
+/*!
+\internal
+Writes the files loaded in this session to the load manifest, so that the next session can
+prefetch them. The qmldir files come first, so that they are parsed before the documents
+importing them. Documents and scripts that failed to load are left out, and so are files that
+were only loaded by the prefetch.
+*/
+void QQmlTypeLoader::writeLoadManifest()
+{
+    ASSERT_ENGINETHREAD();
+    Q_ASSERT(!thread());
+
+    const QString path = QQmlTypeLoaderConfiguredDataConstPtr(&m_data)->loadManifestPath;
+    if (path.isEmpty())
+        return;
+
+    QQmlTypeLoaderThreadDataConstPtr threadData(&m_data);
+    if (threadData->loadManifest.isEmpty())
+        return;
+
+    QQmlTypeLoaderSharedDataConstPtr sharedData(&m_data);
+    const auto failed = [&](const QQmlTypeLoaderThreadData::LoadManifestEntry &entry) {
+        const QUrl url(entry.location);
+        if (entry.type == QQmlDataBlob::QmlFile) {
+            const QQmlRefPointer<QQmlTypeData> blob = sharedData->typeCache.value(url);
+            return blob && blob->isError();
+        }
+        if (entry.type == QQmlDataBlob::JavaScriptFile) {
+            const QQmlRefPointer<QQmlScriptBlob> blob = sharedData->scriptCache.value(url);
+            return blob && blob->isError();
+        }
+        return false;
+    };
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        return;
+
+    QSet<QString> written;
+    for (const bool qmldirs : { true, false }) {
+        for (const auto &entry : threadData->loadManifest) {
+            if ((entry.type == QQmlDataBlob::QmldirFile) != qmldirs || failed(entry)
+                    || sharedData->unrequestedPrefetches.contains(entry.location)
+                    || written.contains(entry.location)) {
+                continue;
+            }
+            written.insert(entry.location);
+
+            const char *kind = entry.type == QQmlDataBlob::QmldirFile
+                    ? "qmldir "
+                    : (entry.type == QQmlDataBlob::QmlFile ? "qml " : "js ");
+            file.write(kind);
+            file.write(entry.location.toUtf8());
+            file.write("\n");
+        }
+    }
+
+    file.commit();
+}
+
 void QQmlTypeLoader::loadThread(const QQmlDataBlob::Ptr &blob)
 {
     ASSERT_LOADTHREAD();
@@ -312,6 +493,8 @@ void QQmlTypeLoader::loadThread(const QQmlDataBlob::Ptr &blob)
         if (blob->setProgress(1.f) && blob->isAsync())
             thread()->callDownloadProgressChanged(blob, 1.);
 
+        if (blob->type() != QQmlDataBlob::QmldirFile)
+            recordLoad(blob->type(), blob->urlString());
         setData(blob, fileName);
 
     } else {
@@ -378,6 +561,8 @@ void QQmlTypeLoader::networkReplyFinished(QNetworkReply *reply)
         QByteArray data = reply->readAll();
         setData(blob, data);
     }
+
+    thread()->finishCompileJobs();
 }
 
 void QQmlTypeLoader::networkReplyProgress(QNetworkReply *reply,
@@ -458,6 +643,28 @@ void QQmlTypeLoader::setData(const QQmlDataBlob::Ptr &blob, const QQmlDataBlob::
 
     blob->dataReceived(d);
 
+    if (!blob->isError() && !blob->isWaiting() && !blob->m_isCompilingSource)
+        blob->allDependenciesDone();
+
+    blob->m_inCallback = false;
+
+    blob->tryDone();
+}
+
+void QQmlTypeLoader::sourceCompiled(const QQmlDataBlob::Ptr &blob)
+{
+    ASSERT_LOADTHREAD();
+
+    Q_TRACE_SCOPE(QQmlCompiling, blob->url());
+    QQmlCompilingProfiler prof(profiler(), blob.data());
+
+    Q_ASSERT(blob->m_isCompilingSource);
+    blob->m_isCompilingSource = false;
+
+    blob->m_inCallback = true;
+
+    blob->sourceCompiled();
+
     if (!blob->isError() && !blob->isWaiting())
         blob->allDependenciesDone();
 
@@ -652,6 +859,7 @@ static void initializeConfiguredData(
     QV4::ExecutionEngine *v4 = engine->handle();
     data->diskCacheOptions = v4->diskCacheOptions();
     data->isDebugging = v4->debugger() != nullptr;
+    data->loadManifestPath = qEnvironmentVariable("QML_LOAD_MANIFEST");
     data->initialized = true;
 }
 
@@ -666,7 +874,19 @@ void QQmlTypeLoader::startThread()
         // or a debugger may have been connected in between.
         QQmlTypeLoaderConfiguredDataPtr data(&m_data);
         initializeConfiguredData(data, m_data.engine());
+        const bool prefetch = !data->loadManifestPath.isEmpty()
+                && !std::exchange(data->loadManifestPrefetched, true);
         m_data.createThread(this);
+
+        // Don't hold up the load that has caused the thread to start, or anything else the
+        // engine thread does right away. The entries are then prefetched one at a time, so that
+        // later loads never wait for more than one of them.
+        if (prefetch) {
+            QMetaObject::invokeMethod(m_data.engine(), [this]() {
+                if (QQmlTypeLoaderThread *t = thread())
+                    t->prefetchLoadManifest();
+            }, Qt::QueuedConnection);
+        }
     }
 }
 
@@ -1266,6 +1486,8 @@ QQmlTypeLoader::~QQmlTypeLoader()
 
     shutdownThread();
 
+    writeLoadManifest();
+
     // Delete the thread before clearing the cache. Otherwise it will be started up again.
     invalidate();
 
@@ -1294,6 +1516,7 @@ QQmlRefPointer<QQmlTypeData> QQmlTypeLoader::getType(const QUrl &unNormalizedUrl
              !QDir::isRelativePath(QQmlFile::urlToLocalFileOrQrc(unNormalizedUrl))));
 
     const QUrl url = normalize(unNormalizedUrl);
+    const bool requested = !isPrefetching();
 
     const auto handleExisting = [&](const QQmlRefPointer<QQmlTypeData> &typeData) {
         if ((mode == PreferSynchronous || mode == Synchronous) && QQmlFile::isSynchronous(url)) {
@@ -1317,6 +1540,8 @@ QQmlRefPointer<QQmlTypeData> QQmlTypeLoader::getType(const QUrl &unNormalizedUrl
     QQmlRefPointer<QQmlTypeData> typeData;
     {
         QQmlTypeLoaderSharedDataPtr data(&m_data);
+        if (requested)
+            recordRequest(data, url);
 
         typeData = data->typeCache.value(url);
         if (typeData)
@@ -1391,10 +1616,13 @@ QQmlRefPointer<QQmlScriptBlob> QQmlTypeLoader::getScript(
              !QDir::isRelativePath(QQmlFile::urlToLocalFileOrQrc(unNormalizedUrl))));
 
     const QUrl url = normalize(unNormalizedUrl);
+    const bool requested = !isPrefetching();
 
     QQmlRefPointer<QQmlScriptBlob> scriptBlob;
     {
         QQmlTypeLoaderSharedDataPtr data(&m_data);
+        if (requested)
+            recordRequest(data, url);
         scriptBlob = data->scriptCache.value(url);
 
         // Also try the relative URL since manually registering native modules doesn't require
@@ -1659,6 +1887,9 @@ const QQmlTypeLoaderQmldirContent QQmlTypeLoader::qmldirContent(const QString &f
         }
     }
 
+    if (!data->prefetching)
+        QQmlTypeLoaderSharedDataPtr(&m_data)->unrequestedPrefetches.remove(filePath);
+
     QQmlTypeLoaderQmldirContent **val = data->importQmlDirCache.value(filePath);
     if (val)
         return **val;
@@ -1674,6 +1905,7 @@ const QQmlTypeLoaderQmldirContent QQmlTypeLoader::qmldirContent(const QString &f
     } else if (file.open(QFile::ReadOnly)) {
         QByteArray data = file.readAll();
         qmldir->setContent(filePath, QString::fromUtf8(data));
+        recordLoad(QQmlDataBlob::QmldirFile, filePath);
     } else {
         ERROR(NOT_READABLE_ERROR.arg(filePath));
     }
@@ -1818,6 +2050,16 @@ bool QQmlTypeLoader::isScriptLoaded(const QUrl &url) const
     return data->scriptCache.contains(url);
 }
 
+/*!
+\internal
+Returns \c true once all the entries of the load manifest have been prefetched.
+*/
+bool QQmlTypeLoader::isLoadManifestPrefetched() const
+{
+    const QQmlTypeLoaderSharedDataConstPtr data(&m_data);
+    return data->loadManifestPrefetchDone;
+}
+
 /*!
 \internal
 
@@ -200,6 +200,7 @@ public:
 
     bool isTypeLoaded(const QUrl &url) const;
     bool isScriptLoaded(const QUrl &url) const;
+    bool isLoadManifestPrefetched() const;
 
     void loadWithStaticData(
             const QQmlDataBlob::Ptr &blob, const QByteArray &data, Mode mode = PreferSynchronous);
@@ -301,6 +302,7 @@ private:
 
     void startThread();
     void shutdownThread();
+    void writeLoadManifest();
     QQmlTypeLoaderThread *ensureThread()
     {
         if (!thread())
@@ -313,6 +315,10 @@ private:
     void loadThread(const QQmlDataBlob::Ptr &);
     void loadWithStaticDataThread(const QQmlDataBlob::Ptr &, const QByteArray &);
     void loadWithCachedUnitThread(const QQmlDataBlob::Ptr &blob, const QQmlPrivate::CachedQmlUnit *unit);
+    bool prefetchLoadManifestThread();
+    void recordLoad(QQmlDataBlob::Type type, const QString &location);
+    bool isPrefetching() const;
+    void recordRequest(const QQmlTypeLoaderSharedDataPtr &data, const QUrl &url);
 #if QT_CONFIG(qml_network)
     void networkReplyFinished(QNetworkReply *);
     void networkReplyProgress(QNetworkReply *, qint64, qint64);
@@ -322,6 +328,7 @@ private:
     void setData(const QQmlDataBlob::Ptr &, const QString &fileName);
     void setData(const QQmlDataBlob::Ptr &, const QQmlDataBlob::SourceCodeData &);
     void setCachedUnit(const QQmlDataBlob::Ptr &blob, const QQmlPrivate::CachedQmlUnit *unit);
+    void sourceCompiled(const QQmlDataBlob::Ptr &blob);
 
     QStringList importPathList(PathType type) const;
     void clearQmldirInfo();
@@ -52,6 +52,13 @@ public:
     ImportDirCache importDirCache;
 
     int typeCacheTrimThreshold = MinimumTypeCacheTrimThreshold;
+
+    // All the entries of the load manifest have been prefetched
+    bool loadManifestPrefetchDone = false;
+
+    // Locations loaded by the prefetch that the application hasn't asked for, yet. They are left
+    // out of the next load manifest, so that files the application stopped using drop out.
+    QSet<QString> unrequestedPrefetches;
 };
 
 class QQmlTypeLoaderThreadData
@@ -91,6 +98,19 @@ public:
     typedef QHash<QNetworkReply *, QQmlDataBlob::Ptr> NetworkReplies;
     NetworkReplies networkReplies;
 #endif
+
+    // Local files loaded in this session, in the order they were loaded. Only recorded if
+    // QML_LOAD_MANIFEST is set, and written to the manifest when the type loader is destroyed.
+    struct LoadManifestEntry {
+        QQmlDataBlob::Type type;
+        QString location; // URL for documents and scripts, file path for qmldir files
+    };
+    QList<LoadManifestEntry> loadManifest;
+
+    // Entries of the load manifest of the previous session that are yet to be prefetched
+    QList<LoadManifestEntry> prefetchQueue;
+    bool loadManifestRead = false;
+    bool prefetching = false; // Loads happening now are triggered by the prefetch
 };
 
 class QQmlTypeLoaderConfiguredData
@@ -113,6 +133,9 @@ public:
             = QV4::ExecutionEngine::DiskCache::Enabled;
     bool isDebugging = false;
     bool initialized = false;
+
+    QString loadManifestPath;
+    bool loadManifestPrefetched = false;
 };
 
 #if QT_CONFIG(qml_network)
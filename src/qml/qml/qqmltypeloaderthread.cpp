@@ -14,6 +14,14 @@ QT_BEGIN_NAMESPACE
 QQmlTypeLoaderThread::QQmlTypeLoaderThread(QQmlTypeLoader *loader)
     : m_loader(loader)
 {
+#if QT_CONFIG(qml_type_loader_thread)
+    const int compileThreads = qEnvironmentVariableIntValue("QML_TYPELOADER_COMPILE_THREADS");
+    if (compileThreads > 0) {
+        m_compilePool = std::make_unique<QThreadPool>();
+        m_compilePool->setMaxThreadCount(compileThreads);
+    }
+#endif
+
     // Do that after initializing all the members.
     startup();
 }
@@ -21,6 +29,12 @@ QQmlTypeLoaderThread::QQmlTypeLoaderThread(QQmlTypeLoader *loader)
 QQmlTypeLoaderThread::~QQmlTypeLoaderThread()
 {
     shutdown();
+
+#if QT_CONFIG(qml_type_loader_thread)
+    if (m_compilePool)
+        m_compilePool->waitForDone();
+    m_finishedCompileJobs.clear();
+#endif
 }
 
 #if QT_CONFIG(qml_network)
@@ -102,19 +116,96 @@ void QQmlTypeLoaderThread::drop(const QQmlDataBlob::Ptr &b)
     postMethodToThread(&This::dropThread, b);
 }
 
+void QQmlTypeLoaderThread::prefetchLoadManifest()
+{
+    postMethodToThread(&This::prefetchLoadManifestThread);
+}
+
+/*!
+    \internal
+    Runs QQmlDataBlob::compileSource() for \a b on the compile pool, if there is one. Returns
+    \c false if there is no compile pool. In that case the caller has to compile the source
+    itself.
+ */
+bool QQmlTypeLoaderThread::startCompileJob(const QQmlDataBlob::Ptr &b)
+{
+#if QT_CONFIG(qml_type_loader_thread)
+    Q_ASSERT(isThisThread());
+    if (!m_compilePool)
+        return false;
+
+    {
+        QMutexLocker locker(&m_compileMutex);
+        ++m_runningCompileJobs;
+    }
+
+    m_compilePool->start([this, blob = b]() mutable {
+        blob->compileSource();
+
+        // Hand over our reference. The blob must not be destroyed on the compile thread.
+        QMutexLocker locker(&m_compileMutex);
+        m_finishedCompileJobs.push_back(std::move(blob));
+        --m_runningCompileJobs;
+        m_compileJobDone.wakeAll();
+    });
+    return true;
+#else
+    Q_UNUSED(b);
+    return false;
+#endif
+}
+
+/*!
+    \internal
+    Waits for all compile jobs, including the ones started while finishing others, and lets
+    the type loader continue with their blobs. This is called at the end of each message
+    processed by the type loader thread. The engine thread relies on all the work triggered by
+    a message being done when the message has been processed, when it waits for a synchronous
+    load. Independent blobs loaded in the course of a message are still compiled concurrently.
+ */
+void QQmlTypeLoaderThread::finishCompileJobs()
+{
+#if QT_CONFIG(qml_type_loader_thread)
+    Q_ASSERT(isThisThread());
+    if (!m_compilePool || m_finishingCompileJobs)
+        return;
+
+    m_finishingCompileJobs = true;
+    QMutexLocker locker(&m_compileMutex);
+    while (m_runningCompileJobs > 0 || !m_finishedCompileJobs.empty()) {
+        if (m_finishedCompileJobs.empty()) {
+            m_compileJobDone.wait(&m_compileMutex);
+            continue;
+        }
+
+        std::vector<QQmlDataBlob::Ptr> finished;
+        finished.swap(m_finishedCompileJobs);
+        locker.unlock();
+        for (const QQmlDataBlob::Ptr &blob : finished)
+            m_loader->sourceCompiled(blob);
+        finished.clear();
+        locker.relock();
+    }
+    m_finishingCompileJobs = false;
+#endif
+}
+
 void QQmlTypeLoaderThread::loadThread(const QQmlDataBlob::Ptr &b)
 {
     m_loader->loadThread(b);
+    finishCompileJobs();
 }
 
 void QQmlTypeLoaderThread::loadWithStaticDataThread(const QQmlDataBlob::Ptr &b, const QByteArray &d)
 {
     m_loader->loadWithStaticDataThread(b, d);
+    finishCompileJobs();
 }
 
 void QQmlTypeLoaderThread::loadWithCachedUnitThread(const QQmlDataBlob::Ptr &b, const QQmlPrivate::CachedQmlUnit *unit)
 {
     m_loader->loadWithCachedUnitThread(b, unit);
+    finishCompileJobs();
 }
 
 void QQmlTypeLoaderThread::callCompletedMain(const QQmlDataBlob::Ptr &b)
@@ -158,4 +249,20 @@ void QQmlTypeLoaderThread::dropThread(const QQmlDataBlob::Ptr &b)
     Q_UNUSED(b);
 }
 
+void QQmlTypeLoaderThread::prefetchLoadManifestThread()
+{
+    const bool more = m_loader->prefetchLoadManifestThread();
+    finishCompileJobs();
+
+    // Post the next entry from the engine thread. Loads requested in the mean time are handled
+    // before it, and a synchronous load never waits for more than the current entry.
+    if (more)
+        postMethodToMain(&This::prefetchLoadManifestMain);
+}
+
+void QQmlTypeLoaderThread::prefetchLoadManifestMain()
+{
+    prefetchLoadManifest();
+}
+
 QT_END_NAMESPACE
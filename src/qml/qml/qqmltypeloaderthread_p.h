@@ -21,6 +21,15 @@
 
 #include <QtQml/qtqmlglobal.h>
 
+#if QT_CONFIG(qml_type_loader_thread)
+#include <QtCore/qmutex.h>
+#include <QtCore/qthreadpool.h>
+#include <QtCore/qwaitcondition.h>
+
+#include <memory>
+#include <vector>
+#endif
+
 #if QT_CONFIG(qml_network)
 #include <private/qqmltypeloadernetworkreplyproxy_p.h>
 #include <QtNetwork/qnetworkaccessmanager.h>
@@ -58,6 +67,10 @@ public:
     void initializeEngine(QQmlExtensionInterface *, const char *);
     void initializeEngine(QQmlEngineExtensionInterface *, const char *);
     void drop(const QQmlDataBlob::Ptr &b);
+    void prefetchLoadManifest();
+
+    bool startCompileJob(const QQmlDataBlob::Ptr &b);
+    void finishCompileJobs();
 
 private:
     void loadThread(const QQmlDataBlob::Ptr &b);
@@ -68,12 +81,23 @@ private:
     void initializeExtensionMain(QQmlExtensionInterface *iface, const char *uri);
     void initializeEngineExtensionMain(QQmlEngineExtensionInterface *iface, const char *uri);
     void dropThread(const QQmlDataBlob::Ptr &b);
+    void prefetchLoadManifestThread();
+    void prefetchLoadManifestMain();
 
     QQmlTypeLoader *m_loader;
 #if QT_CONFIG(qml_network)
     mutable QNetworkAccessManager *m_networkAccessManager = nullptr;
     mutable QQmlTypeLoaderNetworkReplyProxy *m_networkReplyProxy = nullptr;
 #endif // qml_network
+
+#if QT_CONFIG(qml_type_loader_thread)
+    QMutex m_compileMutex;
+    QWaitCondition m_compileJobDone;
+    std::vector<QQmlDataBlob::Ptr> m_finishedCompileJobs;
+    int m_runningCompileJobs = 0;
+    bool m_finishingCompileJobs = false;
+    std::unique_ptr<QThreadPool> m_compilePool;
+#endif
 };
 
 QT_END_NAMESPACE
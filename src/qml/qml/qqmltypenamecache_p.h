@@ -102,8 +102,11 @@ public:
 private:
     friend class QQmlImports;
 
-    static QHashedStringRef toHashedStringRef(const QHashedStringRef &key) { return key; }
-    static QHashedStringRef toHashedStringRef(const QV4::String *key)
+    static QHashedStringRef toHashedStringRef(const QHashedStringRef &key, QString *)
+    {
+        return key;
+    }
+    static QHashedStringRef toHashedStringRef(const QV4::String *key, QString *storage)
     {
         const QV4::Heap::String *heapString = key->d();
 
@@ -116,7 +119,13 @@ private:
         // This is safe because the string data is backed by the QV4::String we got as
         // parameter. The contract about passing V4 values as parameters is that you have to
         // scope them first, so that they don't get gc'd while the callee is working on them.
-        const QStringPrivate &text = heapString->text();
+        // Compact Latin-1 text has no UTF-16 form of its own. storage holds on to the widened
+        // text the identifier table caches for it.
+        if (heapString->textIsLatin1) {
+            *storage = heapString->toQString();
+            return QHashedStringRef(*storage);
+        }
+        const QStringPrivate &text = heapString->utf16Text();
         return QHashedStringRef(QStringView(text.ptr, text.size));
     }
 
@@ -142,8 +151,9 @@ private:
             QList<QQmlError> errors;
             QQmlType t;
             bool typeRecursionDetected = false;
+            QString nameStorage;
             const bool typeFound = m_imports->resolveType(
-                    typeLoader, toHashedStringRef(name), &t, nullptr, &typeNamespace, &errors,
+                    typeLoader, toHashedStringRef(name, &nameStorage), &t, nullptr, &typeNamespace, &errors,
                     QQmlType::AnyRegistrationType,
                     recursionRestriction == QQmlImport::AllowRecursion
                             ? &typeRecursionDetected
@@ -122,9 +122,23 @@ QDataStream &operator>>(QDataStream &stream, QQmlProfilerTypedEvent &event)
         qint64 delta;
         stream >> delta;
 
+        // Newer servers add the allocation site, and its location the first time it is seen
+        QQmlProfilerEventLocation location;
+        QString function;
+        if (!stream.atEnd()) {
+            stream >> event.serverTypeId;
+            if (!stream.atEnd()) {
+                QString filename;
+                qint32 line = 0;
+                qint32 column = 0;
+                stream >> filename >> line >> column >> function;
+                location = QQmlProfilerEventLocation(filename, line, column);
+            }
+        }
+
         event.type = QQmlProfilerEventType(
                     static_cast<Message>(messageType),
-                    MaximumRangeType, subtype);
+                    MaximumRangeType, subtype, location, function);
         event.event.setNumbers<qint64>({delta});
         break;
     }
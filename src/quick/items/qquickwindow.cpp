@@ -37,6 +37,7 @@
 #include <QtCore/QRunnable>
 #include <QtQml/qqmlincubator.h>
 #include <QtQml/qqmlinfo.h>
+#include <QtQml/private/qqmlengine_p.h>
 #include <QtQml/private/qqmlmetatype_p.h>
 
 #include <QtQuick/private/qquickpixmap_p.h>
@@ -326,6 +327,9 @@ struct PolishLoopDetector
 
 void QQuickWindowPrivate::polishItems()
 {
+    // Deferred binding updates may still change what needs to be polished.
+    QQmlEnginePrivate::flushAllBindingUpdates();
+
     // An item can trigger polish on another item, or itself for that matter,
     // during its updatePolish() call. Because of this, we cannot simply
     // iterate through the set, we must continue pulling items out until it
@@ -4,15 +4,23 @@
 #include <QtGui/qguiapplication.h>
 #include <QtQml/qqmlengine.h>
 #include <QtQml/qqmlapplicationengine.h>
+#include <QtQml/qqmlcomponent.h>
 
 int main(int argc, char *argv[])
 {
     QGuiApplication app(argc, argv);
     QQmlEngine someWeirdEngine; // add another engine to cause some trouble
 
+    // Tests that need events from both engines can have the other one run a document, too.
+    QScopedPointer<QObject> someWeirdObject;
+    const QString someWeirdFile = qEnvironmentVariable("QQMLDEBUGJSSERVER_OTHER_ENGINE_FILE");
+    if (!someWeirdFile.isEmpty()) {
+        QQmlComponent component(&someWeirdEngine, QUrl::fromLocalFile(someWeirdFile));
+        someWeirdObject.reset(component.create());
+    }
+
     QQmlApplicationEngine engine;
     engine.load(QUrl::fromLocalFile(QLatin1String(argv[argc - 1])));
 
     return app.exec();
 }
-
@@ -0,0 +1,12 @@
+import QtQml 2.0
+
+QtObject {
+    function allocate(i) {
+        var y = { u: [i, i + 1, i + 2] }
+        if (i < 3)
+            allocate(i + 1);
+        return y;
+    }
+
+    Component.onCompleted: allocate(0)
+}
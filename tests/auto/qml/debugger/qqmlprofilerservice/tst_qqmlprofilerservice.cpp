@@ -193,6 +193,7 @@ private:
                 const QVector<qint64> &expectedNumbers);
 
     QList<QQmlDebugClient *> createClients() override;
+    QQmlDebugProcess *createProcess(const QString &executable) override;
     QScopedPointer<QQmlProfilerTestClient> m_client;
 
 private slots:
@@ -209,6 +210,7 @@ private slots:
     void flushInterval();
     void translationBinding();
     void memory();
+    void memoryMultiEngine();
     void compile();
     void multiEngine();
     void batchOverflow();
@@ -217,6 +219,7 @@ private:
     bool m_recordFromStart = true;
     bool m_flushInterval = false;
     bool m_isComplete = false;
+    QString m_otherEngineFile;
 
     // Don't use ({...}) here as MSVC will interpret that as the "QVector(int size)" ctor.
     const QVector<qint64> m_rangeStart = (QVector<qint64>() << RangeStart);
@@ -458,6 +461,16 @@ QList<QQmlDebugClient *> tst_QQmlProfilerService::createClients()
     return QList<QQmlDebugClient *>({m_client->client});
 }
 
+QQmlDebugProcess *tst_QQmlProfilerService::createProcess(const QString &executable)
+{
+    QQmlDebugProcess *process = QQmlDebugTest::createProcess(executable);
+    if (!m_otherEngineFile.isEmpty()) {
+        process->addEnvironment(QLatin1String("QQMLDEBUGJSSERVER_OTHER_ENGINE_FILE=")
+                                + m_otherEngineFile);
+    }
+    return process;
+}
+
 void tst_QQmlProfilerService::cleanup()
 {
     auto log = [this](const QQmlProfilerEvent &data, int i) {
@@ -503,6 +516,7 @@ void tst_QQmlProfilerService::cleanup()
     }
 
     m_client.reset();
+    m_otherEngineFile.clear();
     QQmlDebugTest::cleanup();
 }
 
@@ -714,13 +728,54 @@ void tst_QQmlProfilerService::memory()
 
     QVERIFY(m_client);
     int smallItems = 0;
+    bool seenAllocationSite = false;
     for (const auto& message : m_client->jsHeapMessages) {
         const QQmlProfilerEventType &type = m_client->types[message.typeIndex()];
-        if (type.detailType() == SmallItem)
+        if (type.detailType() == SmallItem) {
             ++smallItems;
+            if (type.data() == QLatin1String("recurse")
+                    && type.location().filename().endsWith(QLatin1String("memory.qml"))
+                    && type.location().line() >= 8 && type.location().line() <= 12) {
+                seenAllocationSite = true;
+            }
+        }
     }
 
     QVERIFY(smallItems > 5);
+    QVERIFY2(seenAllocationSite, "No allocation attributed to recurse()");
+}
+
+void tst_QQmlProfilerService::memoryMultiEngine()
+{
+    // Both engines allocate. Their allocation sites must not share IDs, or the client would
+    // attribute the allocations of one engine to the sites of the other.
+    m_otherEngineFile = testFile("memoryOtherEngine.qml");
+    QCOMPARE(connectTo(true, "memory.qml", true, 0, false,
+                       debugJsServerPath("qqmlprofilerservice")), ConnectSuccess);
+    checkProcessTerminated();
+
+    checkTraceReceived();
+    checkJsHeap();
+
+    QVERIFY(m_client);
+    bool seenRecurse = false;
+    bool seenAllocate = false;
+    for (const auto& message : m_client->jsHeapMessages) {
+        const QQmlProfilerEventType &type = m_client->types[message.typeIndex()];
+        if (type.detailType() != SmallItem)
+            continue;
+        const QString fileName = type.location().filename();
+        if (type.data() == QLatin1String("recurse")) {
+            QVERIFY(fileName.endsWith(QLatin1String("/memory.qml")));
+            seenRecurse = true;
+        } else if (type.data() == QLatin1String("allocate")) {
+            QVERIFY(fileName.endsWith(QLatin1String("/memoryOtherEngine.qml")));
+            seenAllocate = true;
+        }
+    }
+
+    QVERIFY2(seenRecurse, "No allocation attributed to recurse()");
+    QVERIFY2(seenAllocate, "No allocation attributed to allocate()");
 }
 
 static bool hasCompileEvents(const QVector<QQmlProfilerEventType> &types)
@@ -282,9 +282,16 @@ private slots:
     void applyOnHugeArray();
     void reflectApplyOnHugeArray();
     void jsonStringifyHugeArray();
+    void jsonParseRepeatedShapes();
+    void jsonParseStrings();
+    void writeJson();
+    void ropeStrings();
+    void polymorphicLookups();
+    void transitionCachingSetters();
 
     void tostringRecursionCheck();
     void arrayIncludesWithLargeArray();
+    void packedArrays();
     void printCircularArray();
     void typedArraySet();
     void dataViewCtor();
@@ -5563,6 +5570,80 @@ void tst_QJSEngine::arrayIncludesWithLargeArray()
     QCOMPARE(value.toBool(), false);
 }
 
+void tst_QJSEngine::packedArrays()
+{
+    QJSEngine engine;
+    QJSValue result = engine.evaluate(R"js(
+        function check(actual, expected, what) {
+            if (actual !== expected && !(actual !== actual && expected !== expected))
+                throw what + ": expected " + expected + ", got " + actual;
+        }
+        function fill(a, n, f) {
+            for (let i = 0; i < n; ++i)
+                a[i] = f(i);
+            return a;
+        }
+        function sum(a) {
+            let s = 0;
+            for (let i = 0; i < a.length; ++i)
+                s += a[i];
+            return s;
+        }
+
+        for (let round = 0; round < 50; ++round) {
+            let ints = fill([], 100, i => i);
+            check(sum(ints), 4950, "ints");
+            check(ints.indexOf(42), 42, "indexOf int");
+            check(ints.indexOf("42"), -1, "indexOf string");
+            check(ints.includes(99), true, "includes");
+            check(ints.includes(NaN), false, "includes NaN");
+
+            // int -> double
+            ints[10] = 0.5;
+            check(sum(ints), 4940.5, "doubles");
+            check(ints.indexOf(0.5), 10, "indexOf double");
+            ints[11] = NaN;
+            check(ints.indexOf(NaN), -1, "indexOf NaN");
+            check(ints.includes(NaN), true, "includes NaN in doubles");
+            ints[12] = -0;
+            check(ints.indexOf(-0), 0, "indexOf -0");
+
+            // double -> generic
+            ints[13] = "x";
+            check(ints[13], "x", "string");
+            check(ints.indexOf("x"), 13, "indexOf generic");
+
+            // holes
+            let holes = fill([], 10, i => i);
+            holes[20] = 1;
+            check(holes[15], undefined, "hole");
+            check(holes.indexOf(undefined), -1, "indexOf hole");
+            check(holes.includes(undefined), true, "includes hole");
+
+            // accessors and frozen arrays
+            let frozen = Object.freeze(fill([], 5, i => i));
+            frozen[1] = 42;
+            check(frozen[1], 1, "frozen");
+            let accessor = fill([], 5, i => i);
+            Object.defineProperty(accessor, 2, { get: () => 7 });
+            check(accessor[2], 7, "accessor");
+
+            // callbacks changing the array
+            let mutated = fill([], 5, i => i);
+            let seen = [];
+            mutated.forEach((v, i, a) => { if (i === 1) a[3] = "three"; seen.push(v); });
+            check(seen.join(), "0,1,2,three,4", "forEach");
+            mutated = fill([], 5, i => i);
+            check(mutated.map((v, i, a) => { a.length = 3; return v; }).length, 5, "map");
+            mutated = fill([], 5, i => i);
+            check(mutated.reduce((acc, v, i, a) => { a[i + 1] = 0.5; return acc + v; }), 2.5, "reduce");
+        }
+        "ok";
+    )js");
+    QVERIFY2(!result.isError(), qPrintable(result.toString()));
+    QCOMPARE(result.toString(), QStringLiteral("ok"));
+}
+
 void tst_QJSEngine::printCircularArray()
 {
     QJSEngine engine;
@@ -5642,6 +5723,310 @@ JSON.stringify([], v3);
     QCOMPARE(value.toString(), QLatin1String("RangeError: Invalid array length."));
 }
 
+void tst_QJSEngine::jsonParseRepeatedShapes()
+{
+    QJSEngine engine;
+    const QJSValue result = engine.evaluate(R"js(
+        let text = "[";
+        for (let i = 0; i < 100; ++i) {
+            if (i)
+                text += ",\n        ";
+            if (i % 10 == 3)
+                text += `{"y": ${i}, "x": ${i}}`;
+            else if (i % 10 == 7)
+                text += `{"x": ${i}, "y": 1, "y": ${i}, "0": "zero", "__proto__": 5}`;
+            else
+                text += `{"x": ${i}, "y": ${i}, "n\\u0061me": "item${i}"}`;
+        }
+        text += "]";
+
+        const parsed = JSON.parse(text);
+        let errors = [];
+        for (let i = 0; i < parsed.length; ++i) {
+            const o = parsed[i];
+            const keys = Object.keys(o).join();
+            if (o.x !== i || o.y !== i)
+                errors.push(i + ": wrong values " + JSON.stringify(o));
+            if (i % 10 == 3 && keys !== "y,x")
+                errors.push(i + ": wrong keys " + keys);
+            if (i % 10 == 7 && (keys !== "0,x,y,__proto__" || o[0] !== "zero"
+                                || Object.getPrototypeOf(o) !== Object.prototype)) {
+                errors.push(i + ": wrong keys " + keys);
+            }
+            if (i % 10 != 3 && i % 10 != 7 && (keys !== "x,y,name" || o.name !== "item" + i))
+                errors.push(i + ": wrong keys " + keys);
+        }
+        errors.join("\n");
+    )js");
+    QVERIFY2(!result.isError(), qPrintable(result.toString()));
+    QCOMPARE(result.toString(), QString());
+}
+
+void tst_QJSEngine::jsonParseStrings()
+{
+    QJSEngine engine;
+    QJSValue result = engine.evaluate(
+            R"js(JSON.parse('["a long string without escapes", "tab\\tand \\"quotes\\" and \\u00e9 and \\ud83d\\ude00", "", "\\\\"]'))js");
+    QVERIFY2(!result.isError(), qPrintable(result.toString()));
+    QCOMPARE(result.property(0).toString(), QStringLiteral("a long string without escapes"));
+    QCOMPARE(result.property(1).toString(),
+             QStringLiteral("tab\tand \"quotes\" and \u00e9 and \U0001F600"));
+    QCOMPARE(result.property(2).toString(), QString());
+    QCOMPARE(result.property(3).toString(), QStringLiteral("\\"));
+
+    result = engine.evaluate(QStringLiteral("JSON.parse('[\"control\\\\u0001\"]')"));
+    QVERIFY(!result.isError());
+    QCOMPARE(result.property(0).toString(), QStringLiteral("control\u0001"));
+
+    // raw control characters, unterminated strings and bad escapes are rejected
+    const QStringList invalid = {
+        QStringLiteral("\"a long string with a raw\ttab\""),
+        QStringLiteral("\"a long string that is not terminated"),
+        QStringLiteral("\"a long string with a bad \\x escape\""),
+        QStringLiteral("{\"unterminated key: 1}"),
+    };
+    for (const QString &json : invalid) {
+        engine.globalObject().setProperty(QStringLiteral("json"), json);
+        result = engine.evaluate(QStringLiteral("JSON.parse(json)"));
+        QVERIFY2(result.isError(), qPrintable(json));
+        QCOMPARE(result.errorType(), QJSValue::SyntaxError);
+    }
+}
+
+void tst_QJSEngine::writeJson()
+{
+    QJSEngine engine;
+    const QJSValue value = engine.evaluate(R"js(
+        let items = [];
+        for (let i = 0; i < 5000; ++i) {
+            items.push({
+                id: i,
+                name: "item \"" + i + "\"é😀",
+                tags: [i % 3 == 0, null, undefined, () => i, new Number(i / 4)],
+                skipped: undefined,
+                date: { toJSON(key) { return key + i; } }
+            });
+        }
+        ({ items: items, empty: {}, none: [] })
+    )js");
+    QVERIFY2(!value.isError(), qPrintable(value.toString()));
+    engine.globalObject().setProperty(QStringLiteral("value"), value);
+
+    for (int indent : { 0, 2 }) {
+        const QString expected = engine.evaluate(
+                QStringLiteral("JSON.stringify(value, null, %1)").arg(indent)).toString();
+        QVERIFY(expected.size() > (1 << 17));
+
+        QBuffer buffer;
+        QVERIFY(buffer.open(QIODevice::WriteOnly));
+        QVERIFY(engine.writeJson(value, &buffer, indent));
+        QCOMPARE(QString::fromUtf8(buffer.data()), expected);
+    }
+
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    QVERIFY(engine.writeJson(QJSValue(QStringLiteral("a\tb")), &buffer));
+    QCOMPARE(buffer.data(), QByteArray("\"a\\tb\""));
+
+    // no JSON representation
+    QVERIFY(!engine.writeJson(QJSValue(), &buffer));
+
+    // cycles throw, but the exception doesn't leak into the engine
+    const QJSValue cyclic = engine.evaluate(QStringLiteral("let c = { a: [] }; c.a.push(c); c"));
+    QVERIFY(!engine.writeJson(cyclic, &buffer));
+    QVERIFY(!engine.hasError());
+    QCOMPARE(engine.evaluate(QStringLiteral("1 + 1")).toInt(), 2);
+}
+
+void tst_QJSEngine::ropeStrings()
+{
+    QJSEngine engine;
+    // Build ropes from pieces of different sizes, so that matches span the borders between
+    // them, and compare against a flat copy of the same text. Strings passed to C++ are
+    // flattened, so the ropes are only ever handled in JavaScript.
+    QJSValue result = engine.evaluate(R"js(
+        var pieces = ["ab", "c", "\ud83d", "\ude00", "needle", "", "x".repeat(300), "nee",
+                      "dle", "abcab", "n", "eedl", "e!"];
+        function makeRope() {
+            let rope = "";
+            for (let round = 0; round < 20; ++round) {
+                for (let i = 0; i < pieces.length; ++i)
+                    rope += pieces[(i + round) % pieces.length];
+            }
+            return rope;
+        }
+        var flat = makeRope().split("").join("");
+        var rope = makeRope();
+        function onRope(method, ...args) { return makeRope()[method](...args); }
+        function onKeptRope(method, ...args) { return rope[method](...args); }
+        function onFlat(method, ...args) { return flat[method](...args); }
+    )js");
+    QVERIFY2(!result.isError(), qPrintable(result.toString()));
+
+    QJSValue globalObject = engine.globalObject();
+    QJSValue onRope = globalObject.property(QStringLiteral("onRope"));
+    QJSValue onKeptRope = globalObject.property(QStringLiteral("onKeptRope"));
+    QJSValue onFlat = globalObject.property(QStringLiteral("onFlat"));
+    const int length = globalObject.property(QStringLiteral("flat")).toString().size();
+    QCOMPARE(engine.evaluate(QStringLiteral("makeRope().length")).toInt(), length);
+
+    const QStringList needles = {
+        QStringLiteral("needle"), QStringLiteral("abcab"), QStringLiteral("cab"),
+        QStringLiteral("e!n"), QStringLiteral("😀"), QStringLiteral("x"), QStringLiteral("zzz"),
+        QString(), QString(299, u'x') + u'n'
+    };
+    const QList<double> froms = { 0, 1, 5, 333, 1000, double(length - 3), double(length), 1e9, -5 };
+    for (const QString &needle : needles) {
+        for (double from : froms) {
+            const QJSValueList indexOf = { QStringLiteral("indexOf"), needle, from };
+            QCOMPARE(onRope.call(indexOf).toInt(), onFlat.call(indexOf).toInt());
+            const QJSValueList includes = { QStringLiteral("includes"), needle, from };
+            QCOMPARE(onRope.call(includes).toBool(), onFlat.call(includes).toBool());
+        }
+    }
+
+    for (int i = -1; i <= length; i += 7) {
+        for (const QString &method : { QStringLiteral("charCodeAt"), QStringLiteral("charAt"),
+                                       QStringLiteral("codePointAt") }) {
+            const QJSValueList args = { method, i };
+            QCOMPARE(onKeptRope.call(args).toString(), onFlat.call(args).toString());
+        }
+    }
+
+    const QJSValueList slice = { QStringLiteral("slice"), 7, -11 };
+    QCOMPARE(onRope.call(slice).toString(), onFlat.call(slice).toString());
+    QCOMPARE(engine.evaluate(QStringLiteral("[...(makeRope() + \"tail\")].join(\"|\")")).toString(),
+             engine.evaluate(QStringLiteral("[...(flat + \"tail\")].join(\"|\")")).toString());
+
+    // Repeated lookups eventually flatten the rope, without changing the results.
+    result = engine.evaluate(R"js(
+        let sum = 0;
+        for (let i = 0; i < rope.length; ++i)
+            sum += rope.charCodeAt(i) - flat.charCodeAt(i);
+        sum;
+    )js");
+    QCOMPARE(result.toInt(), 0);
+}
+
+void tst_QJSEngine::polymorphicLookups()
+{
+    QJSEngine engine;
+    // More shapes than a polymorphic lookup can hold, with x stored in all the different
+    // places a lookup can find it.
+    const QJSValue result = engine.evaluate(R"js(
+        function Inherited() {}
+        Inherited.prototype.x = 5;
+        var withAccessor = { get x() { return this.base + 1; } };
+        var makers = [
+            () => ({ x: 1 }),
+            () => ({ a: 0, x: 2 }),
+            () => {
+                let o = {};
+                for (let i = 0; i < 20; ++i)
+                    o["p" + i] = i;
+                o.x = 3;
+                return o;
+            },
+            () => ({ get x() { return 4; } }),
+            () => new Inherited,
+            () => { let o = Object.create(withAccessor); o.base = 5; return o; },
+            () => ({ b: 0, c: 0, x: 7 }),
+            () => ({ y: 8 }),
+            () => new Proxy({ x: 9 }, {}),
+            () => "string",
+        ];
+
+        function readX(o) { return o.x; }
+        function readShape(i) { return readX(makers[i]()); }
+    )js");
+    QVERIFY2(!result.isError(), qPrintable(result.toString()));
+
+    QJSValue readShape = engine.globalObject().property(QStringLiteral("readShape"));
+    QJSValueList expected = { 1, 2, 3, 4, 5, 6, 7, QJSValue(), 9, QJSValue() };
+    for (int round = 0; round < 40; ++round) {
+        // Grow the number of shapes slowly, so that the lookup goes through all its states.
+        const int count = qMin(int(expected.size()), 1 + (round >> 2));
+        for (int i = 0; i < count; ++i) {
+            const QJSValue x = readShape.call({ i });
+            QVERIFY2(x.strictlyEquals(expected[i]),
+                     qPrintable(QStringLiteral("round %1, shape %2: %3").arg(round).arg(i)
+                                        .arg(x.toString())));
+        }
+
+        if (round == 30) {
+            // Changing the prototype has to invalidate the cached shapes.
+            engine.evaluate(QStringLiteral(
+                    "delete Inherited.prototype.x; Inherited.prototype.z = 0; "
+                    "Inherited.prototype.x = 50;"));
+            expected[4] = 50;
+            engine.collectGarbage();
+        }
+    }
+}
+
+void tst_QJSEngine::transitionCachingSetters()
+{
+    QJSEngine engine;
+    // Each store adds a property, with objects of different shapes reaching the same store.
+    // The objects grow well past their inline properties, so that member data has to grow.
+    const QJSValue result = engine.evaluate(R"js(
+        function fill(o, tag) {
+            o.a = tag; o.b = tag + 1; o.c = tag + 2; o.d = tag + 3; o.e = tag + 4;
+            o.f = tag + 5; o.g = tag + 6; o.h = tag + 7; o.i = tag + 8; o.j = tag + 9;
+            return o;
+        }
+
+        function WithSetter() {}
+        Object.defineProperty(WithSetter.prototype, "e", {
+            set(v) { this.seen = v; }, get() { return this.seen; }
+        });
+        function ReadOnly() {}
+        Object.defineProperty(ReadOnly.prototype, "f", { value: -1, writable: false });
+
+        var makers = [
+            () => ({}),
+            () => ({ x: 0 }),
+            () => ({ x: 0, y: 0 }),
+            () => new WithSetter,
+            () => new ReadOnly,
+            () => ({ a: 0, x: 0 }),
+            () => Object.freeze({}),
+        ];
+
+        var records = [];
+        for (let round = 0; round < 40; ++round) {
+            const count = Math.min(makers.length, 1 + (round >> 2));
+            for (let i = 0; i < count; ++i)
+                records.push([i, fill(makers[i](), round * 100 + i * 10)]);
+            if (round % 10 === 9)
+                gc();
+        }
+        records.length;
+    )js");
+    QVERIFY2(!result.isError(), qPrintable(result.toString()));
+
+    QJSValue records = engine.globalObject().property(QStringLiteral("records"));
+    const int count = result.toInt();
+    QVERIFY(count > 0);
+    for (int n = 0; n < count; ++n) {
+        const QJSValue record = records.property(n);
+        const int kind = record.property(0).toInt();
+        const QJSValue o = record.property(1);
+        if (kind == 6) {
+            QVERIFY(!o.hasOwnProperty(QStringLiteral("a")));
+            QVERIFY(!o.hasOwnProperty(QStringLiteral("j")));
+            continue;
+        }
+        const QJSValue tag = o.property(QStringLiteral("a"));
+        QVERIFY(tag.isNumber());
+        QCOMPARE(o.property(QStringLiteral("j")).toInt(), tag.toInt() + 9);
+        QCOMPARE(o.property(QStringLiteral("e")).toInt(), tag.toInt() + 4);
+        QCOMPARE(o.property(QStringLiteral("f")).toInt(), kind == 4 ? -1 : tag.toInt() + 5);
+        if (kind == 3)
+            QVERIFY(!o.hasOwnProperty(QStringLiteral("e")));
+    }
+}
+
 void tst_QJSEngine::typedArraySet()
 {
     QJSEngine engine;
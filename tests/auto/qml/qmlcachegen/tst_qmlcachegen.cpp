@@ -69,6 +69,7 @@ private slots:
 
     void scriptStringCachegenInteraction();
     void saveableUnitPointer();
+    void unitPack();
 
     void aotstatsSerialization();
     void aotstatsGeneration_data();
@@ -97,7 +98,7 @@ public:
     }
 };
 
-static bool generateCache(const QString &qmlFileName, QByteArray *capturedStderr = nullptr)
+static bool runQmlcachegen(const QStringList &arguments, QByteArray *capturedStderr = nullptr)
 {
 #if defined(QTEST_CROSS_COMPILED)
     QTest::qFail("You cannot call qmlcachegen on the target.", __FILE__, __LINE__);
@@ -108,7 +109,7 @@ static bool generateCache(const QString &qmlFileName, QByteArray *capturedStderr
         proc.setProcessChannelMode(QProcess::ForwardedChannels);
     proc.setProgram(QLibraryInfo::path(QLibraryInfo::LibraryExecutablesPath)
                     + QLatin1String("/qmlcachegen"));
-    proc.setArguments(QStringList() << qmlFileName);
+    proc.setArguments(arguments);
     proc.start();
     if (!proc.waitForFinished())
         return false;
@@ -121,6 +122,11 @@ static bool generateCache(const QString &qmlFileName, QByteArray *capturedStderr
     return proc.exitCode() == 0;
 }
 
+static bool generateCache(const QString &qmlFileName, QByteArray *capturedStderr = nullptr)
+{
+    return runQmlcachegen(QStringList() << qmlFileName, capturedStderr);
+}
+
 tst_qmlcachegen::tst_qmlcachegen()
     : QQmlDataTest(QT_QMLTEST_DATADIR)
 {
@@ -901,6 +907,85 @@ void tst_qmlcachegen::saveableUnitPointer()
     QCOMPARE(unit.flags, flags);
 }
 
+void tst_qmlcachegen::unitPack()
+{
+#if defined(QTEST_CROSS_COMPILED)
+    QSKIP("Cannot call qmlcachegen on cross-compiled target.");
+#endif
+
+    const auto writeSources = [](const QTemporaryDir &tempDir) {
+        const auto writeTempFile = [&tempDir](const QString &fileName, const char *contents) {
+            QFile f(tempDir.path() + '/' + fileName);
+            const bool ok = f.open(QIODevice::WriteOnly | QIODevice::Truncate);
+            Q_ASSERT(ok);
+            f.write(contents);
+            return f.fileName();
+        };
+
+        return QStringList {
+            writeTempFile("test.qml", "import QtQml\n"
+                                      "import \"script.js\" as Script\n"
+                                      "QtObject {\n"
+                                      "    property int value: Script.value()\n"
+                                      "}"),
+            writeTempFile("script.js", "function value() { return 42 }")
+        };
+    };
+
+    const auto loadFromDisk = [](const QString &filePath, QString *errorString) {
+        auto unit = QQml::makeRefPointer<QV4::CompiledData::CompilationUnit>();
+        return unit->loadFromDisk(QUrl::fromLocalFile(filePath), QFileInfo(filePath).lastModified(),
+                                  errorString)
+                ? unit
+                : QQmlRefPointer<QV4::CompiledData::CompilationUnit>();
+    };
+
+    {
+        QTemporaryDir tempDir;
+        QVERIFY(tempDir.isValid());
+        const QStringList sources = writeSources(tempDir);
+        const QString packFilePath = tempDir.path() + u'/'
+                + QLatin1String(QV4::CompiledData::unit_pack_file_name);
+        QVERIFY(runQmlcachegen(QStringList { "-o"_L1, packFilePath } + sources));
+        QVERIFY(QFile::exists(packFilePath));
+        for (const QString &source : sources)
+            QVERIFY(!QFile::exists(source + u'c'));
+
+        QString errorString;
+        for (const QString &source : sources) {
+            const auto unit = loadFromDisk(source, &errorString);
+            QVERIFY2(unit, qPrintable(errorString));
+            QVERIFY(unit->localCachePath.isEmpty());
+        }
+
+        QQmlEngine engine;
+        CleanlyLoadingComponent component(&engine, QUrl::fromLocalFile(sources.first()));
+        QScopedPointer<QObject> obj(component.create());
+        QVERIFY2(!obj.isNull(), qPrintable(component.errorString()));
+        QCOMPARE(obj->property("value").toInt(), 42);
+    }
+
+    {
+        QTemporaryDir tempDir;
+        QVERIFY(tempDir.isValid());
+        const QStringList sources = writeSources(tempDir);
+        const QString packFilePath = tempDir.path() + u'/'
+                + QLatin1String(QV4::CompiledData::unit_pack_file_name);
+        QVERIFY(runQmlcachegen(QStringList { "-o"_L1, packFilePath } + sources));
+
+        // A damaged pack file is ignored as a whole.
+        {
+            QFile pack(packFilePath);
+            QVERIFY(pack.open(QIODevice::ReadWrite));
+            QVERIFY(pack.seek(pack.size() - 1));
+            QCOMPARE(pack.write("x", 1), qint64(1));
+        }
+
+        QString errorString;
+        QVERIFY(!loadFromDisk(sources.first(), &errorString));
+    }
+}
+
 void tst_qmlcachegen::aotstatsSerialization()
 {
     const auto createEntry = [](const auto &d, const auto &n, const auto &e, const auto &l,
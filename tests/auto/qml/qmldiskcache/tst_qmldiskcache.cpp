@@ -43,6 +43,7 @@ private slots:
     void reuseStaticMappings();
     void invalidateSaveLoadCache();
     void duplicateIdsInInlineComponents();
+    void jitProfile();
 
     void inlineComponentDoesNotCauseConstantInvalidation_data();
     void inlineComponentDoesNotCauseConstantInvalidation();
@@ -1258,6 +1259,59 @@ void tst_qmldiskcache::duplicateIdsInInlineComponents()
     }
 }
 
+void tst_qmldiskcache::jitProfile()
+{
+    QQmlEngine engine;
+    TestCompiler testCompiler(&engine);
+    QVERIFY(testCompiler.tempDir.isValid());
+
+    const QByteArray contents = QByteArrayLiteral("import QtQml\n"
+                                                  "QtObject {\n"
+                                                  "    function f() { return 1 }\n"
+                                                  "    function g() { return 2 }\n"
+                                                  "}");
+    QVERIFY2(testCompiler.compile(contents), qPrintable(testCompiler.lastErrorString));
+
+    const QUrl url = QUrl::fromLocalFile(testCompiler.testFilePath);
+    const QDateTime timeStamp = QFileInfo(testCompiler.testFilePath).lastModified();
+    {
+        auto unit = QQml::makeRefPointer<QV4::CompiledData::CompilationUnit>();
+        QVERIFY2(unit->loadFromDisk(url, timeStamp, &testCompiler.lastErrorString),
+                 qPrintable(testCompiler.lastErrorString));
+        QVERIFY(unit->jitProfile.isEmpty());
+        QVERIFY(unit->unitData()->functionTableSize >= 2);
+        QVERIFY2(unit->saveJitProfile({ 0, 1 }, &testCompiler.lastErrorString),
+                 qPrintable(testCompiler.lastErrorString));
+    }
+
+    // The profile follows the unit, which is still valid.
+    QVERIFY2(testCompiler.verify(), qPrintable(testCompiler.lastErrorString));
+    {
+        auto unit = QQml::makeRefPointer<QV4::CompiledData::CompilationUnit>();
+        QVERIFY2(unit->loadFromDisk(url, timeStamp, &testCompiler.lastErrorString),
+                 qPrintable(testCompiler.lastErrorString));
+        QCOMPARE(unit->jitProfile, QList<quint32>({ 0, 1 }));
+    }
+
+    // A profile recorded for a different unit is ignored.
+    {
+        QFile cacheFile(testCompiler.cacheFilePath);
+        QVERIFY(cacheFile.open(QIODevice::ReadWrite));
+        QV4::CompiledData::Unit header;
+        QCOMPARE(cacheFile.read(reinterpret_cast<char *>(&header), sizeof(header)),
+                 qint64(sizeof(header)));
+        QVERIFY(cacheFile.seek(header.unitSize + offsetof(QV4::CompiledData::JitProfile,
+                                                          unitChecksum)));
+        QCOMPARE(cacheFile.write(QByteArray(16, 'x')), qint64(16));
+    }
+    {
+        auto unit = QQml::makeRefPointer<QV4::CompiledData::CompilationUnit>();
+        QVERIFY2(unit->loadFromDisk(url, timeStamp, &testCompiler.lastErrorString),
+                 qPrintable(testCompiler.lastErrorString));
+        QVERIFY(unit->jitProfile.isEmpty());
+    }
+}
+
 void tst_qmldiskcache::inlineComponentDoesNotCauseConstantInvalidation_data()
 {
     QTest::addColumn<QByteArray>("code");
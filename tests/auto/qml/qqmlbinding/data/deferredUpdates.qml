@@ -0,0 +1,9 @@
+import QtQml
+
+QtObject {
+    property int source: 0
+    property int sum: source + doubled
+    property int doubled: source * 2
+    property int sumChanges: 0
+    onSumChanged: ++sumChanges
+}
@@ -0,0 +1,10 @@
+import QtQml
+
+QtObject {
+    id: root
+    property int source: 0
+    property QtObject child: QtObject {
+        property int doubled: root.source * 2
+    }
+    property int incremented: source + 1
+}
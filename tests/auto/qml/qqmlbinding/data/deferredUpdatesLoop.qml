@@ -0,0 +1,6 @@
+import QtQml
+
+QtObject {
+    property int a: b + 1
+    property int b: a + 1
+}
@@ -7,6 +7,7 @@
 #include <private/qqmlanybinding_p.h>
 #include <private/qqmlbind_p.h>
 #include <private/qqmlcomponentattached_p.h>
+#include <private/qqmlengine_p.h>
 #include <private/qqmlpropertytopropertybinding_p.h>
 #include <private/qquickrectangle_p.h>
 
@@ -50,6 +51,9 @@ private slots:
     void propertiesAttachedToBindingItself();
     void toggleEnableProperlyRemembersValues();
     void qQmlPropertyToPropertyBinding();
+    void deferredUpdates();
+    void deferredUpdatesLoop();
+    void deferredUpdatesDeletedTarget();
 
 private:
     QQmlEngine engine;
@@ -781,6 +785,80 @@ void tst_qqmlbinding::qQmlPropertyToPropertyBinding()
     QCOMPARE(target->right(), 11 + 33);
 }
 
+void tst_qqmlbinding::deferredUpdates()
+{
+    QQmlEngine e;
+    QQmlEnginePrivate *ep = QQmlEnginePrivate::get(&e);
+    ep->deferBindingUpdates = true;
+
+    QQmlComponent c(&e, testFileUrl("deferredUpdates.qml"));
+    std::unique_ptr<QObject> root { c.create() };
+    QVERIFY2(root, qPrintable(c.errorString()));
+    ep->flushBindingUpdates();
+    root->setProperty("sumChanges", 0);
+    const QQmlEnginePrivate::BindingUpdateStatistics before = ep->bindingUpdateStatistics;
+
+    root->setProperty("source", 1);
+    root->setProperty("source", 2);
+    root->setProperty("source", 3);
+
+    // Nothing is updated until we get back to the event loop.
+    QCOMPARE(root->property("doubled").toInt(), 0);
+    QCOMPARE(root->property("sum").toInt(), 0);
+    QCOMPARE(ep->bindingUpdateStatistics.queued - before.queued, quint64(2));
+    QCOMPARE(ep->bindingUpdateStatistics.coalesced - before.coalesced, quint64(4));
+
+    QTRY_COMPARE(root->property("sum").toInt(), 9);
+    QCOMPARE(root->property("doubled").toInt(), 6);
+    QCOMPARE(root->property("sumChanges").toInt(), 1);
+
+    // "doubled" is updated before "sum", so that "sum" is only updated once.
+    QCOMPARE(ep->bindingUpdateStatistics.evaluated - before.evaluated, quint64(2));
+    QCOMPARE(ep->bindingUpdateStatistics.coalesced - before.coalesced, quint64(5));
+}
+
+void tst_qqmlbinding::deferredUpdatesLoop()
+{
+    QQmlEngine e;
+    QQmlEnginePrivate *ep = QQmlEnginePrivate::get(&e);
+    ep->deferBindingUpdates = true;
+
+    QQmlComponent c(&e, testFileUrl("deferredUpdatesLoop.qml"));
+    std::unique_ptr<QObject> root { c.create() };
+    QVERIFY2(root, qPrintable(c.errorString()));
+
+    // The updates keep queuing each other, until the engine gives up.
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(".*Binding loop detected for property.*"));
+    ep->flushBindingUpdates();
+    QVERIFY(ep->bindingUpdateStatistics.evaluated > 0);
+}
+
+void tst_qqmlbinding::deferredUpdatesDeletedTarget()
+{
+    QQmlEngine e;
+    QQmlEnginePrivate *ep = QQmlEnginePrivate::get(&e);
+    ep->deferBindingUpdates = true;
+
+    QQmlComponent c(&e, testFileUrl("deferredUpdatesDeletedTarget.qml"));
+    std::unique_ptr<QObject> root { c.create() };
+    QVERIFY2(root, qPrintable(c.errorString()));
+    ep->flushBindingUpdates();
+
+    QObject *child = root->property("child").value<QObject *>();
+    QVERIFY(child);
+    const QQmlEnginePrivate::BindingUpdateStatistics before = ep->bindingUpdateStatistics;
+
+    root->setProperty("source", 5);
+    QCOMPARE(ep->bindingUpdateStatistics.queued - before.queued, quint64(2));
+
+    // The binding of "doubled" stays queued after its target is gone.
+    delete child;
+    ep->flushBindingUpdates();
+
+    QCOMPARE(root->property("incremented").toInt(), 6);
+    QCOMPARE(ep->bindingUpdateStatistics.evaluated - before.evaluated, quint64(1));
+}
+
 QTEST_MAIN(tst_qqmlbinding)
 
 #include "tst_qqmlbinding.moc"
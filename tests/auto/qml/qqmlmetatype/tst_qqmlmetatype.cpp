@@ -14,6 +14,13 @@
 #include <private/qqmlanybinding_p.h>
 #include <QtQuickTestUtils/private/qmlutils_p.h>
 
+#include <QtCore/qscopeguard.h>
+#include <QtCore/qthread.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
 using namespace Qt::StringLiterals;
 
 class tst_qqmlmetatype : public QQmlDataTest
@@ -54,6 +61,7 @@ private slots:
 
     void clearPropertyCaches();
     void builtins();
+    void concurrentLookups();
 };
 
 class TestType : public QObject
@@ -840,6 +848,64 @@ void tst_qqmlmetatype::builtins()
     checkObjectBuiltin<QQmlComponent>("Component");
 }
 
+void tst_qqmlmetatype::concurrentLookups()
+{
+    // Type lookups from other threads don't take the type registry lock. They must never see a
+    // type that doesn't match what was registered, while the registry keeps changing underneath.
+    std::atomic<bool> done = false;
+    std::atomic<int> failures = 0;
+    const auto lookUp = [&]() {
+        while (!done.load()) {
+            const QQmlType byName = QQmlMetaType::qmlType(
+                    QStringLiteral("Controller"), QStringLiteral("concurrent"),
+                    QTypeRevision::fromVersion(1, 0));
+            if (byName.isValid() && byName.typeId() != QMetaType::fromType<Controller1 *>())
+                ++failures;
+
+            const QQmlType byMetaObject = QQmlMetaType::qmlType(&Controller1::staticMetaObject);
+            if (byMetaObject.isValid()
+                    && byMetaObject.typeId() != QMetaType::fromType<Controller1 *>()) {
+                ++failures;
+            }
+
+            const QQmlPropertyCache::ConstPtr cache
+                    = QQmlMetaType::propertyCache(&Controller1::staticMetaObject);
+            if (!cache || cache->firstCppMetaObject() != &Controller1::staticMetaObject)
+                ++failures;
+        }
+    };
+
+    std::vector<std::unique_ptr<QThread>> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back(QThread::create(lookUp));
+        threads.back()->start();
+    }
+
+    const auto stopThreads = [&]() {
+        done = true;
+        for (const auto &thread : threads)
+            thread->wait();
+    };
+    const auto guard = qScopeGuard(stopThreads);
+
+    for (int i = 0; i < 200; ++i) {
+        const int id = qmlRegisterType<Controller1>("concurrent", 1, 0, "Controller");
+        const QQmlType registered = QQmlMetaType::qmlType(
+                QStringLiteral("Controller"), QStringLiteral("concurrent"),
+                QTypeRevision::fromVersion(1, 0));
+        QVERIFY(registered.isValid());
+        QCOMPARE(registered.typeId(), QMetaType::fromType<Controller1 *>());
+
+        QQmlMetaType::unregisterType(id);
+        QVERIFY(!QQmlMetaType::qmlType(
+                QStringLiteral("Controller"), QStringLiteral("concurrent"),
+                QTypeRevision::fromVersion(1, 0)).isValid());
+    }
+
+    stopThreads();
+    QCOMPARE(failures.load(), 0);
+}
+
 QTEST_MAIN(tst_qqmlmetatype)
 
 #include "tst_qqmlmetatype.moc"
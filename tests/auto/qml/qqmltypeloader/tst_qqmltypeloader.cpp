@@ -51,6 +51,8 @@ private slots:
     void signalHandlersAreCompatible();
     void loadTypeOnShutdown();
     void floodTypeLoaderEventQueue();
+    void compileInParallel();
+    void loadManifest();
 
 private:
     void checkSingleton(const QString & dataDirectory);
@@ -864,6 +866,166 @@ void tst_QQMLTypeLoader::floodTypeLoaderEventQueue()
     }
 }
 
+void tst_QQMLTypeLoader::compileInParallel()
+{
+    qputenv("QML_TYPELOADER_COMPILE_THREADS", "4");
+    qputenv("QML_DISABLE_DISK_CACHE", "1");
+    const auto guard = qScopeGuard([]() {
+        qunsetenv("QML_TYPELOADER_COMPILE_THREADS");
+        qunsetenv("QML_DISABLE_DISK_CACHE");
+    });
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const auto writeFile = [&](const QString &name, const QString &contents) {
+        QFile file(dir.filePath(name));
+        return file.open(QIODevice::WriteOnly) && file.write(contents.toUtf8()) >= 0;
+    };
+
+    constexpr int numTypes = 32;
+    QString main = QLatin1String("import QtQml\nQtObject {\n");
+    QStringList values;
+    for (int i = 0; i < numTypes; ++i) {
+        QVERIFY(writeFile(QString::fromLatin1("Type%1.qml").arg(i), QString::fromLatin1(
+                "import QtQml\nimport \"script%1.js\" as Script\n"
+                "QtObject { property int value: Script.value() }\n").arg(i)));
+        QVERIFY(writeFile(QString::fromLatin1("script%1.js").arg(i), QString::fromLatin1(
+                ".pragma library\nfunction value() { return %1; }\n").arg(i)));
+        main += QString::fromLatin1("    property QtObject t%1: Type%1 {}\n").arg(i);
+        values.append(QString::fromLatin1("t%1.value").arg(i));
+    }
+    main += QLatin1String("    property int sum: ") + values.join(QLatin1String(" + "))
+            + QLatin1String("\n}\n");
+    QVERIFY(writeFile(QLatin1String("main.qml"), main));
+    QVERIFY(writeFile(QLatin1String("Broken.qml"),
+                      QLatin1String("import QtQml\nQtObject {\n    property int x: \n}\n")));
+
+    const QUrl mainUrl = QUrl::fromLocalFile(dir.filePath(QLatin1String("main.qml")));
+    const QUrl brokenUrl = QUrl::fromLocalFile(dir.filePath(QLatin1String("Broken.qml")));
+
+    for (const auto mode : { QQmlComponent::PreferSynchronous, QQmlComponent::Asynchronous }) {
+        QQmlEngine engine;
+
+        QQmlComponent component(&engine, mainUrl, mode);
+        if (mode == QQmlComponent::PreferSynchronous)
+            QVERIFY2(component.isReady(), qPrintable(component.errorString()));
+        else
+            QTRY_VERIFY2(component.isReady(), qPrintable(component.errorString()));
+
+        QScopedPointer<QObject> o(component.create());
+        QVERIFY(!o.isNull());
+        QCOMPARE(o->property("sum").toInt(), numTypes * (numTypes - 1) / 2);
+
+        QQmlComponent broken(&engine, brokenUrl, mode);
+        QTRY_VERIFY(broken.isError());
+        QCOMPARE(broken.errors().first().url(), brokenUrl);
+    }
+}
+
+void tst_QQMLTypeLoader::loadManifest()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString manifest = dir.filePath(QLatin1String("load.manifest"));
+
+    qputenv("QML_LOAD_MANIFEST", QFile::encodeName(manifest));
+    qputenv("QML_DISABLE_DISK_CACHE", "1");
+    const auto guard = qScopeGuard([]() {
+        qunsetenv("QML_LOAD_MANIFEST");
+        qunsetenv("QML_DISABLE_DISK_CACHE");
+    });
+
+    const auto writeFile = [&](const QString &name, const QByteArray &contents) {
+        QFile file(dir.filePath(name));
+        return file.open(QIODevice::WriteOnly) && file.write(contents) == contents.size();
+    };
+
+    QVERIFY(writeFile(QLatin1String("main.qml"),
+                      "import QtQml\nimport \"helper.js\" as Helper\n"
+                      "QtObject {\n    property QtObject child: Child {}\n"
+                      "    property int value: Helper.value()\n}\n"));
+    QVERIFY(writeFile(QLatin1String("Child.qml"), "import QtQml\nQtObject {}\n"));
+    QVERIFY(writeFile(QLatin1String("helper.js"), "function value() { return 42; }\n"));
+
+    const QUrl mainUrl = QUrl::fromLocalFile(dir.filePath(QLatin1String("main.qml")));
+    const QUrl childUrl = QUrl::fromLocalFile(dir.filePath(QLatin1String("Child.qml")));
+    const QUrl helperUrl = QUrl::fromLocalFile(dir.filePath(QLatin1String("helper.js")));
+
+    {
+        QQmlEngine engine;
+        QQmlComponent component(&engine, mainUrl);
+        QVERIFY2(component.isReady(), qPrintable(component.errorString()));
+        QScopedPointer<QObject> o(component.create());
+        QVERIFY(!o.isNull());
+        QCOMPARE(o->property("value").toInt(), 42);
+    }
+
+    {
+        QFile file(manifest);
+        QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Text));
+        const QByteArray contents = file.readAll();
+        QVERIFY(contents.contains("qml " + mainUrl.toString().toUtf8() + '\n'));
+        QVERIFY(contents.contains("qml " + childUrl.toString().toUtf8() + '\n'));
+        QVERIFY(contents.contains("js " + helperUrl.toString().toUtf8() + '\n'));
+    }
+
+    const auto loadUnrelated = [&](QQmlEngine *engine) {
+        // Starts the type loader thread. The prefetching starts once we are back in the event loop.
+        QQmlComponent component(engine);
+        component.setData("import QtQml\nQtObject {}\n",
+                          QUrl::fromLocalFile(dir.filePath(QLatin1String("unrelated.qml"))));
+        return component.isReady();
+    };
+
+    // A file the application doesn't use anymore.
+    QVERIFY(writeFile(QLatin1String("Stale.qml"), "import QtQml\nQtObject {}\n"));
+    const QUrl staleUrl = QUrl::fromLocalFile(dir.filePath(QLatin1String("Stale.qml")));
+    {
+        QFile file(manifest);
+        QVERIFY(file.open(QIODevice::Append | QIODevice::Text));
+        file.write("qml " + staleUrl.toString().toUtf8() + '\n');
+    }
+
+    {
+        QQmlEngine engine;
+        QVERIFY(loadUnrelated(&engine));
+        const QQmlTypeLoader &loader = QQmlEnginePrivate::get(&engine)->typeLoader;
+        QVERIFY(!loader.isLoadManifestPrefetched());
+        QTRY_VERIFY(loader.isLoadManifestPrefetched());
+        QVERIFY(loader.isTypeLoaded(mainUrl));
+        QVERIFY(loader.isTypeLoaded(childUrl));
+        QVERIFY(loader.isScriptLoaded(helperUrl));
+        QVERIFY(loader.isTypeLoaded(staleUrl));
+
+        QQmlComponent component(&engine, mainUrl);
+        QVERIFY2(component.isReady(), qPrintable(component.errorString()));
+    }
+
+    // Only what the application asked for is written back.
+    {
+        QFile file(manifest);
+        QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Text));
+        const QByteArray contents = file.readAll();
+        QVERIFY(contents.contains("qml " + mainUrl.toString().toUtf8() + '\n'));
+        QVERIFY(!contents.contains(staleUrl.toString().toUtf8()));
+    }
+
+    // Prefetched documents are still checked. The ones that fail are not kept around.
+    QVERIFY(writeFile(QLatin1String("Child.qml"), "import QtQml\nQtObject {\n"));
+    {
+        QQmlEngine engine;
+        QVERIFY(loadUnrelated(&engine));
+        const QQmlTypeLoader &loader = QQmlEnginePrivate::get(&engine)->typeLoader;
+        QTRY_VERIFY(loader.isLoadManifestPrefetched());
+        QVERIFY(!loader.isTypeLoaded(mainUrl));
+        QVERIFY(!loader.isTypeLoaded(childUrl));
+        QVERIFY(loader.isScriptLoaded(helperUrl));
+
+        QQmlComponent component(&engine, mainUrl);
+        QVERIFY(component.isError());
+    }
+}
+
 QTEST_MAIN(tst_QQMLTypeLoader)
 
 #include "tst_qqmltypeloader.moc"
@@ -6,11 +6,17 @@
 #include <QtCore/qprocess.h>
 #endif
 #include <QtCore/qtemporaryfile.h>
+#include <QtQml/qjsengine.h>
 #include <QtQml/qqml.h>
 #include <QtQml/qqmlapplicationengine.h>
 #include <QtQuickTestUtils/private/qmlutils_p.h>
 
 #include <private/qv4global_p.h>
+#include <private/qjsvalue_p.h>
+#include <private/qv4functionobject_p.h>
+#if QT_CONFIG(qml_jit) && QT_CONFIG(thread)
+#include <private/qv4backgroundcompiler_p.h>
+#endif
 
 #ifdef Q_OS_WIN
 #include <qt_windows.h>
@@ -28,6 +34,9 @@ private slots:
     void perfMapFile();
     void functionTable();
     void jitEnabled();
+    void feedbackFastPaths();
+    void loopEntry();
+    void backgroundCompilation();
 };
 
 tst_QV4Assembler::tst_QV4Assembler()
@@ -143,6 +152,230 @@ void tst_QV4Assembler::jitEnabled()
 #endif
 }
 
+void tst_QV4Assembler::feedbackFastPaths()
+{
+#if !QT_CONFIG(process)
+    QSKIP("Depends on QProcess");
+#elif !defined(Q_OS_LINUX) || defined(Q_OS_ANDROID)
+    QSKIP("perf map files are only generated on linux");
+#else
+    // The JIT thresholds are read once per process. Therefore run this in a process of its own.
+    const QString qmljs = QLibraryInfo::path(QLibraryInfo::BinariesPath) + "/qmljs";
+    QProcess process;
+
+    QTemporaryFile infile;
+    QVERIFY(infile.open());
+    infile.write(R"(
+function inlineProperty(o) { return o.x; }
+function memberDataProperty(o) { return o.p39; }
+function add(a, b) { return a + b; }
+function sub(a, b) { return a - b; }
+function mul(a, b) { return a * b; }
+function makeBig() {
+    var o = {};
+    for (var i = 0; i < 40; ++i)
+        o["p" + i] = i;
+    return o;
+}
+
+var results = [];
+var small = { x: 1, y: 2 };
+for (var i = 0; i < 4; ++i)
+    results.push(inlineProperty(small));
+results.push(inlineProperty({ y: 2, x: 3 }));
+results.push(inlineProperty("x"));
+results.push(inlineProperty(small));
+
+var big = makeBig();
+for (i = 0; i < 4; ++i)
+    results.push(memberDataProperty(big));
+var other = makeBig();
+other.p39 = "changed";
+results.push(memberDataProperty(other));
+
+for (i = 0; i < 4; ++i)
+    results.push(add(0.5, 1), sub(0.5, 1), mul(0.5, 3));
+results.push(add(2147483647, 1), sub(-2147483648, 1), mul(65536, 65536));
+results.push(add(Infinity, -Infinity), mul(0, Infinity), 1 / mul(-0.5, 0));
+results.push(add("a", 1.5), sub("3", 0.5), add(true, 0.5));
+
+var result = results.join(",");
+if (result !== "1,1,1,1,3,,1,"
+        + "39,39,39,39,changed,"
+        + "1.5,-0.5,1.5,1.5,-0.5,1.5,1.5,-0.5,1.5,1.5,-0.5,1.5,"
+        + "2147483648,-2147483649,4294967296,"
+        + "NaN,NaN,-Infinity,"
+        + "a1.5,2.5,1.5") {
+    throw new Error(result);
+}
+)");
+    infile.close();
+
+    // Let the interpreter fill the lookups before the functions get compiled.
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.insert("QV4_PROFILE_WRITE_PERF_MAP", "1");
+    environment.insert("QV4_JIT_CALL_THRESHOLD", "2");
+
+    process.setProcessEnvironment(environment);
+    process.start(qmljs, QStringList({infile.fileName()}));
+    QVERIFY(process.waitForStarted());
+    const qint64 pid = process.processId();
+    QVERIFY(pid != 0);
+    QVERIFY(process.waitForFinished());
+    QCOMPARE(process.exitCode(), 0);
+
+    // The results above must come from compiled code, too.
+    QFile file(QString::fromLatin1("/tmp/perf-%1.map").arg(pid));
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QList<QByteArray> functions;
+    while (!file.atEnd())
+        functions.append(file.readLine().split(' ').last());
+    for (const char *name : { "inlineProperty\n", "memberDataProperty\n", "add\n", "sub\n", "mul\n" })
+        QVERIFY2(functions.contains(name), name);
+#endif
+}
+
+void tst_QV4Assembler::loopEntry()
+{
+#if !QT_CONFIG(process)
+    QSKIP("Depends on QProcess");
+#elif !defined(Q_OS_LINUX) || defined(Q_OS_ANDROID)
+    QSKIP("perf map files are only generated on linux");
+#else
+    // The JIT thresholds are read once per process. Therefore run this in a process of its own.
+    const QString qmljs = QLibraryInfo::path(QLibraryInfo::BinariesPath) + "/qmljs";
+    QProcess process;
+
+    QTemporaryFile infile;
+    QVERIFY(infile.open());
+    infile.write(R"(
+function sum(n) {
+    var total = 0;
+    for (var i = 0; i < n; ++i)
+        total += i;
+    return total;
+}
+function nested(n) {
+    var total = 0;
+    for (var i = 0; i < n; ++i) {
+        var j = 0;
+        do {
+            total += j;
+        } while (++j < i);
+    }
+    return total;
+}
+function captured(n) {
+    let fns = [];
+    for (let i = 0; i < n; ++i)
+        fns.push(() => i);
+    return fns[n - 1]() + fns[0]();
+}
+function guarded(n) {
+    var total = 0;
+    try {
+        for (var i = 0; i < n; ++i)
+            total += i;
+    } catch (e) {
+        return -1;
+    }
+    return total;
+}
+function throwing(n) {
+    for (var i = 0; i < n; ++i) {
+        if (i === n - 1)
+            throw new Error("at " + i);
+    }
+}
+function caught(n) {
+    try {
+        throwing(n);
+    } catch (e) {
+        return e.message;
+    }
+}
+var result = [sum(1000), nested(50), captured(100), guarded(1000), caught(100)].join(",");
+if (result !== "499500,19600,99,499500,at 99")
+    throw new Error(result);
+)");
+    infile.close();
+
+    // Functions are only ever called once here. Only their loops can get them compiled.
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.insert("QV4_PROFILE_WRITE_PERF_MAP", "1");
+    environment.insert("QV4_JIT_CALL_THRESHOLD", "1000");
+    environment.insert("QV4_JIT_LOOP_THRESHOLD", "10");
+
+    process.setProcessEnvironment(environment);
+    process.start(qmljs, QStringList({infile.fileName()}));
+    QVERIFY(process.waitForStarted());
+    const qint64 pid = process.processId();
+    QVERIFY(pid != 0);
+    QVERIFY(process.waitForFinished());
+    QCOMPARE(process.exitCode(), 0);
+
+    QFile file(QString::fromLatin1("/tmp/perf-%1.map").arg(pid));
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QList<QByteArray> functions;
+    while (!file.atEnd())
+        functions.append(file.readLine().split(' ').last());
+    for (const char *name : { "sum\n", "nested\n", "captured\n", "throwing\n" })
+        QVERIFY2(functions.contains(name), name);
+#endif
+}
+
+void tst_QV4Assembler::backgroundCompilation()
+{
+#if !QT_CONFIG(qml_jit) || !QT_CONFIG(thread)
+    QSKIP("Background compilation requires the JIT and thread support");
+#else
+    qputenv("QV4_JIT_BACKGROUND", "1");
+    QJSEngine engine;
+    qunsetenv("QV4_JIT_BACKGROUND");
+
+    QV4::JIT::BackgroundCompiler *compiler = engine.handle()->backgroundCompiler;
+    if (!compiler)
+        QSKIP("The JIT is not available");
+
+    QJSValue fib = engine.evaluate(QStringLiteral(
+            "(function fib(n) { return n < 2 ? n : fib(n - 1) + fib(n - 2); })"));
+    QVERIFY(fib.isCallable());
+    const QV4::Function *function
+            = QJSValuePrivate::asManagedType<QV4::JavaScriptFunctionObject>(&fib)->function();
+    QVERIFY(function);
+
+    // The calls alternate between the interpreter and compiled code while the compiler is busy.
+    for (int i = 0; i < 50; ++i)
+        QCOMPARE(fib.call({ 20 }).toInt(), 6765);
+
+    // Once the worker is done, a call installs the code. From then on, it runs instead of the
+    // interpreter.
+    const auto installedOnCall = [&]() {
+        fib.call({ 1 });
+        return function->jittedCode != nullptr;
+    };
+    QTRY_VERIFY(installedOnCall());
+    QVERIFY(function->codeRef);
+    QCOMPARE(fib.call({ 25 }).toInt(), 75025);
+
+    // The code was compiled on the worker, not on this thread.
+    const QV4::JIT::BackgroundCompiler::Statistics statistics = compiler->statistics();
+    QVERIFY(statistics.compiled > 0);
+    QVERIFY(statistics.installed > 0);
+    QVERIFY(statistics.workerThread != nullptr);
+    QVERIFY(statistics.workerThread != QThread::currentThreadId());
+
+    // Leave some functions in the queue. The engine must cancel them when it goes away.
+    const QJSValue result = engine.evaluate(QStringLiteral(R"(
+        var values = [];
+        for (var i = 0; i < 10; ++i)
+            values.push((function(x) { return x * 2; })(i));
+        values.join(",");
+    )"));
+    QCOMPARE(result.toString(), QStringLiteral("0,2,4,6,8,10,12,14,16,18"));
+#endif
+}
+
 QTEST_MAIN(tst_QV4Assembler)
 
 #include "tst_qv4assembler.moc"
@@ -5,6 +5,10 @@
 #include <QQmlEngine>
 #include <QLoggingCategory>
 #include <QQmlComponent>
+#include <QBuffer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 
 #include <private/qv4mm_p.h>
 #include <private/qv4qobjectwrapper_p.h>
@@ -12,6 +16,7 @@
 #include <private/qqmlengine_p.h>
 #include <private/qv4identifiertable_p.h>
 #include <private/qv4arraydata_p.h>
+#include <private/qv4internalclass_p.h>
 #include <private/qqmlcomponentattached_p.h>
 #include <private/qv4mapobject_p.h>
 #include <private/qv4setobject_p.h>
@@ -47,6 +52,15 @@ private slots:
     void forInOnProxyMarksTarget();
     void allocWithMemberDataMidwayDrain();
     void markObjectWrappersAfterMarkWeakValues();
+    void generationalMinorCollection();
+    void parallelMarking();
+    void backgroundSweep();
+    void heapSnapshot();
+    void compaction();
+    void compactionKeepsProtoLookups();
+    void compactionKeepsGlobalLookups();
+    void latin1Identifiers();
+    void dictionaryInternalClasses();
 };
 
 tst_qv4mm::tst_qv4mm()
@@ -835,6 +849,456 @@ void tst_qv4mm::markObjectWrappersAfterMarkWeakValues()
     QCOMPARE(qvariant_cast<QObject *>(retrieved)->objectName(), "yep");
 }
 
+void tst_qv4mm::generationalMinorCollection()
+{
+    qputenv("QV4_GC_GENERATIONAL", "1");
+    QV4::ExecutionEngine engine;
+    qunsetenv("QV4_GC_GENERATIONAL");
+    QV4::MemoryManager *mm = engine.memoryManager;
+    QVERIFY(mm->isGenerational());
+    mm->setGCTimeLimit(0);
+
+    QV4::PersistentValue old(&engine, engine.newObject()->asReturnedValue());
+    mm->runFullGC();
+    QVERIFY(!mm->minorCollection);
+    // the survivors form the old generation, and the barrier stays active
+    QVERIFY(old.asManaged()->markBit());
+    QVERIFY(engine.isGCOngoing);
+    QVERIFY(mm->isRecordingRememberedSet());
+
+    QV4::Heap::Object *young = engine.newObject();
+    QV4::Heap::Object *unreachable = engine.newObject();
+    {
+        QV4::Scope scope(&engine);
+        QV4::ScopedObject o(scope, old.value());
+        QV4::ScopedString name(scope, engine.newString(QStringLiteral("young")));
+        QV4::ScopedValue v(scope, young->asReturnedValue());
+        o->put(name, v);
+    }
+    // storing into an old object remembers the young one
+    QVERIFY(young->isMarked());
+    QVERIFY(!unreachable->isMarked());
+
+    mm->runGC();
+    QVERIFY(mm->minorCollection);
+    QVERIFY(young->inUse());
+    QVERIFY(!unreachable->inUse());
+    QCOMPARE(mm->statistics.minorCollections, 1u);
+}
+
+void tst_qv4mm::parallelMarking()
+{
+#if QT_CONFIG(thread)
+    qputenv("QV4_GC_MARK_THREADS", "4");
+    QJSEngine jsEngine;
+    qunsetenv("QV4_GC_MARK_THREADS");
+    QV4::ExecutionEngine *v4 = jsEngine.handle();
+    QVERIFY(v4->memoryManager->parallelMarkPool);
+    v4->memoryManager->setGCTimeLimit(0);
+
+    const QJSValue list = jsEngine.evaluate(QStringLiteral(R"(
+        var list = [];
+        for (var i = 0; i < 20000; ++i)
+            list.push({ index: i, name: "item" + i, children: [i, { value: i }], fn: function() { return i; } });
+        list;
+    )"));
+    QVERIFY(list.isArray());
+    const uint roundsBefore = v4->memoryManager->statistics.parallelMarkRounds;
+    const quint64 packetsBefore = v4->memoryManager->statistics.parallelMarkPackets;
+    jsEngine.collectGarbage();
+    QVERIFY(v4->memoryManager->statistics.parallelMarkRounds > roundsBefore);
+    QVERIFY(v4->memoryManager->statistics.parallelMarkPackets > packetsBefore);
+
+    const QJSValue check = jsEngine.evaluate(QStringLiteral(R"(
+        var ok = true;
+        for (var i = 0; i < list.length; ++i) {
+            ok = ok && list[i].index === i && list[i].name === "item" + i
+                    && list[i].children[1].value === i && typeof list[i].fn === "function";
+        }
+        ok;
+    )"));
+    QVERIFY(check.toBool());
+#else
+    QSKIP("Parallel marking requires thread support");
+#endif
+}
+
+void tst_qv4mm::backgroundSweep()
+{
+    {
+        // without a background sweeper, the sweep is finished in the same increment
+        QJSEngine jsEngine;
+        QV4::MemoryManager *mm = jsEngine.handle()->memoryManager;
+        QVERIFY(!mm->backgroundSweeper);
+        auto sm = mm->gcStateMachine.get();
+        sm->reset();
+        mm->gcBlocked = QV4::MemoryManager::NormalBlocked;
+        while (sm->state != QV4::GCState::DoSweep) {
+            QV4::GCStateInfo& stateInfo = sm->stateInfoMap[int(sm->state)];
+            sm->state = stateInfo.execute(sm, sm->stateData);
+        }
+        QV4::GCStateInfo& sweepInfo = sm->stateInfoMap[int(sm->state)];
+        sm->state = sweepInfo.execute(sm, sm->stateData);
+        QCOMPARE(sm->state, QV4::GCState::Invalid);
+        QVERIFY(!mm->internalClassSweepPending);
+        QCOMPARE(mm->gcBlocked, QV4::MemoryManager::Unblocked);
+    }
+
+#if QT_CONFIG(thread)
+    qputenv("QV4_GC_BACKGROUND_SWEEP", "1");
+    QJSEngine jsEngine;
+    qunsetenv("QV4_GC_BACKGROUND_SWEEP");
+    QV4::ExecutionEngine *v4 = jsEngine.handle();
+    QV4::MemoryManager *mm = v4->memoryManager;
+    QVERIFY(mm->backgroundSweeper);
+
+    const QJSValue list = jsEngine.evaluate(QStringLiteral(R"(
+        var list = [];
+        for (var i = 0; i < 20000; ++i) {
+            var garbage = { name: "garbage" + i, sparse: [] };
+            garbage.sparse[100000 + i] = i;
+            list.push({ index: i, name: "item" + i });
+        }
+        list;
+    )"));
+    QVERIFY(list.isArray());
+
+    auto sm = mm->gcStateMachine.get();
+    sm->reset();
+    mm->gcBlocked = QV4::MemoryManager::NormalBlocked;
+    while (sm->state != QV4::GCState::FinishSweep) {
+        QV4::GCStateInfo& stateInfo = sm->stateInfoMap[int(sm->state)];
+        sm->state = stateInfo.execute(sm, sm->stateData);
+    }
+    QVERIFY(mm->internalClassSweepPending);
+
+    // the chunks the sweeper works on are still allocated
+    const size_t backgroundSweptChunks = mm->blockAllocator.backgroundSweptChunks;
+    QVERIFY(backgroundSweptChunks > 0);
+    QVERIFY(mm->getAllocatedMem() >= backgroundSweptChunks * QV4::Chunk::DataSize);
+
+    // the mutator keeps running while the chunks are swept
+    const QJSValue more = jsEngine.evaluate(QStringLiteral(R"(
+        var more = [];
+        for (var i = 0; i < 1000; ++i)
+            more.push({ index: i, name: "more" + i });
+        more;
+    )"));
+    QVERIFY(more.isArray());
+
+    QVERIFY(mm->tryForceGCCompletion());
+    QVERIFY(!mm->internalClassSweepPending);
+    QCOMPARE(mm->blockAllocator.backgroundSweptChunks, size_t(0));
+    jsEngine.collectGarbage();
+
+    const QJSValue check = jsEngine.evaluate(QStringLiteral(R"(
+        var ok = true;
+        for (var i = 0; i < list.length; ++i)
+            ok = ok && list[i].index === i && list[i].name === "item" + i;
+        for (var i = 0; i < more.length; ++i)
+            ok = ok && more[i].index === i && more[i].name === "more" + i;
+        ok;
+    )"));
+    QVERIFY(check.toBool());
+#else
+    QSKIP("Background sweeping requires thread support");
+#endif
+}
+
+void tst_qv4mm::heapSnapshot()
+{
+    QJSEngine jsEngine;
+    const QJSValue leak = jsEngine.evaluate(QStringLiteral(R"(
+        var leak = { marker: "heapSnapshotMarker" };
+        leak;
+    )"));
+    QVERIFY(leak.isObject());
+
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    QVERIFY(jsEngine.writeHeapSnapshot(&buffer));
+
+    QJsonParseError error;
+    const QJsonObject snapshot = QJsonDocument::fromJson(buffer.data(), &error).object();
+    QCOMPARE(error.error, QJsonParseError::NoError);
+
+    const QJsonObject meta = snapshot[QLatin1String("snapshot")].toObject();
+    const QJsonArray nodes = snapshot[QLatin1String("nodes")].toArray();
+    const QJsonArray edges = snapshot[QLatin1String("edges")].toArray();
+    const QJsonArray strings = snapshot[QLatin1String("strings")].toArray();
+    const int nodeFieldCount = 6;
+    const int edgeFieldCount = 3;
+    QCOMPARE(nodes.size(), meta[QLatin1String("node_count")].toInt() * nodeFieldCount);
+    QCOMPARE(edges.size(), meta[QLatin1String("edge_count")].toInt() * edgeFieldCount);
+
+    int edgeCount = 0;
+    int markerNode = -1;
+    for (int i = 0; i < nodes.size(); i += nodeFieldCount) {
+        edgeCount += nodes[i + 4].toInt();
+        const QString name = strings[nodes[i + 1].toInt()].toString();
+        if (nodes[i].toInt() == 2 && name == QLatin1String("heapSnapshotMarker"))
+            markerNode = i;
+    }
+    QCOMPARE(edgeCount * edgeFieldCount, edges.size());
+    QVERIFY(markerNode > 0);
+
+    bool referenced = false;
+    for (int i = 0; i < edges.size(); i += edgeFieldCount)
+        referenced = referenced || edges[i + 2].toInt() == markerNode;
+    QVERIFY(referenced);
+
+    // the snapshot must not confuse the next gc cycle
+    jsEngine.collectGarbage();
+    QCOMPARE(leak.property(QStringLiteral("marker")).toString(),
+             QStringLiteral("heapSnapshotMarker"));
+}
+
+void tst_qv4mm::compaction()
+{
+    qputenv("QV4_GC_COMPACT", "1");
+    QJSEngine jsEngine;
+    qunsetenv("QV4_GC_COMPACT");
+    QV4::ExecutionEngine *v4 = jsEngine.handle();
+    QV4::MemoryManager *mm = v4->memoryManager;
+    QVERIFY(mm->compactingGC);
+
+    jsEngine.evaluate(QStringLiteral(R"(
+        var all = [];
+        for (var i = 0; i < 20000; ++i) {
+            var o = { a: i, b: i + 1, c: i + 2, d: i + 3, e: i + 4, f: i + 5, g: i + 6 };
+            o.list = [i, i + 1, i + 2];
+            Object.defineProperty(o.list, 1, { value: i + 1, writable: false });
+            all.push(o);
+        }
+        var keep = all.filter(function(o, index) { return index % 100 === 0; });
+        all = null;
+    )"));
+    const size_t chunksBefore = mm->dataAllocator.chunks.size();
+    QVERIFY(chunksBefore > 0);
+
+    jsEngine.collectGarbage();
+    QVERIFY(mm->statistics.evacuatedChunks > 0);
+    QVERIFY(mm->dataAllocator.chunks.size() < chunksBefore);
+
+    const QJSValue check = jsEngine.evaluate(QStringLiteral(R"(
+        var ok = keep.length === 200;
+        for (var i = 0; i < keep.length; ++i) {
+            var o = keep[i];
+            var n = i * 100;
+            ok = ok && o.a === n && o.d === n + 3 && o.g === n + 6
+                    && o.list.length === 3 && o.list[0] === n && o.list[2] === n + 2
+                    && !Object.getOwnPropertyDescriptor(o.list, 1).writable;
+            o.list.push(n + 3);
+            ok = ok && o.list[3] === n + 3;
+        }
+        ok;
+    )"));
+    QVERIFY(check.toBool());
+}
+
+void tst_qv4mm::compactionKeepsProtoLookups()
+{
+    qputenv("QV4_GC_COMPACT", "1");
+    QJSEngine jsEngine;
+    qunsetenv("QV4_GC_COMPACT");
+    QV4::ExecutionEngine *v4 = jsEngine.handle();
+    QV4::MemoryManager *mm = v4->memoryManager;
+    QVERIFY(mm->compactingGC);
+
+    jsEngine.evaluate(QStringLiteral(R"(
+        function readDeep(o) { return o.p20; }
+        var all = [];
+        for (var i = 0; i < 20000; ++i) {
+            var o = {};
+            for (var j = 0; j < 24; ++j)
+                o["p" + j] = i + j;
+            all.push(o);
+        }
+        var proto = all[5000];
+        var child = Object.create(proto);
+        readDeep(child);
+        readDeep(child);
+        var keep = all.filter(function(o, index) { return index % 100 === 0; });
+        all = null;
+    )"));
+
+    QV4::Scope scope(v4);
+    const QJSValue proto = jsEngine.globalObject().property(QStringLiteral("proto"));
+    QV4::ScopedObject protoObject(scope, QJSValuePrivate::asReturnedValue(&proto));
+    QVERIFY(protoObject);
+    QVERIFY(protoObject->internalClass()->isUsedAsProto());
+    QV4::Heap::MemberData *memberData = protoObject->d()->memberData;
+    QVERIFY(memberData);
+
+    jsEngine.collectGarbage();
+    QVERIFY(mm->statistics.evacuatedChunks > 0);
+    QCOMPARE(protoObject->d()->memberData.get(), memberData);
+
+    QCOMPARE(jsEngine.evaluate(QStringLiteral("readDeep(child)")).toInt(), 5020);
+    QCOMPARE(jsEngine.evaluate(QStringLiteral("keep[1].p23")).toInt(), 123);
+}
+
+void tst_qv4mm::compactionKeepsGlobalLookups()
+{
+    qputenv("QV4_GC_COMPACT", "1");
+    QJSEngine jsEngine;
+    qunsetenv("QV4_GC_COMPACT");
+    QV4::ExecutionEngine *v4 = jsEngine.handle();
+    QV4::MemoryManager *mm = v4->memoryManager;
+    QVERIFY(mm->compactingGC);
+
+    // Global lookups point into the property data of the global object, which isn't a prototype.
+    jsEngine.evaluate(QStringLiteral(R"(
+        var all = [];
+        for (var i = 0; i < 20000; ++i) {
+            var o = {};
+            for (var j = 0; j < 24; ++j)
+                o["p" + j] = i + j;
+            all.push(o);
+        }
+        var globalValue = 42;
+        function readGlobal() { return globalValue; }
+        readGlobal();
+        readGlobal();
+        var keep = all.filter(function(o, index) { return index % 100 === 0; });
+        all = null;
+    )"));
+
+    QV4::Heap::MemberData *memberData = v4->globalObject->d()->memberData;
+    QVERIFY(memberData);
+
+    jsEngine.collectGarbage();
+    QVERIFY(mm->statistics.evacuatedChunks > 0);
+    QCOMPARE(v4->globalObject->d()->memberData.get(), memberData);
+
+    QCOMPARE(jsEngine.evaluate(QStringLiteral("readGlobal()")).toInt(), 42);
+    QCOMPARE(jsEngine.evaluate(QStringLiteral("globalValue = 43; readGlobal()")).toInt(), 43);
+    QCOMPARE(jsEngine.evaluate(QStringLiteral("keep[1].p23")).toInt(), 123);
+}
+
+void tst_qv4mm::latin1Identifiers()
+{
+    QJSEngine jsEngine;
+    QV4::ExecutionEngine *v4 = jsEngine.handle();
+    QV4::Scope scope(v4);
+
+    const QString latin1 = QString::fromUtf8("caf\xc3\xa9_identifier");
+    const QString wideText = latin1 + u'1';
+    // The text of a string may be borrowed. It's a compact copy that gets interned.
+    QV4::ScopedString source(scope, v4->newString(QString(latin1).append(u'1')));
+    const QV4::PropertyKey key = source->toPropertyKey();
+    QVERIFY(!source->d()->textIsLatin1);
+    QV4::ScopedString compact(scope, v4->identifierTable->stringForId(key));
+    QVERIFY(compact->d() != source->d());
+    QVERIFY(compact->d()->textIsLatin1);
+    QCOMPARE(compact->d()->length(), latin1.size() + 1);
+    QCOMPARE(compact->d()->retainedTextSize(), std::size_t(latin1.size() + 1));
+    QCOMPARE(compact->propertyKey(), key);
+
+    // Hashing and lookups work the same on both forms.
+    QCOMPARE(compact->hashValue(),
+             QV4::String::createHashValue(wideText.constData(), wideText.size(), nullptr));
+    QCOMPARE(v4->identifierTable->insertString(wideText), compact->d());
+    QV4::ScopedString fresh(scope, v4->newString(wideText));
+    QVERIFY(fresh->equals(compact));
+    QCOMPARE(fresh->toPropertyKey(), key);
+
+    // New identifiers are stored in compact form right away.
+    const QString newText = latin1 + u'2';
+    QV4::ScopedString inserted(scope, v4->identifierTable->insertString(newText));
+    QVERIFY(inserted->d()->textIsLatin1);
+    QCOMPARE(inserted->toQString(), newText);
+
+    // Non-Latin-1 text and text shared with a QString stay UTF-16.
+    QV4::ScopedString wide(scope, v4->newString(QString::fromUtf8("\xe6\x97\xa5\xe6\x9c\xac")));
+    wide->toPropertyKey();
+    QVERIFY(!wide->d()->textIsLatin1);
+    QV4::ScopedString shared(scope, v4->newString(latin1));
+    shared->toPropertyKey();
+    QVERIFY(!shared->d()->textIsLatin1);
+    QVERIFY(!v4->identifierTable->stringForId(shared->propertyKey())->textIsLatin1);
+
+    // Converting to QString widens into a temporary. The compact form stays.
+    QCOMPARE(compact->toQString(), wideText);
+    QVERIFY(compact->d()->textIsLatin1);
+    QCOMPARE(compact->d()->retainedTextSize(), std::size_t(wideText.size()));
+    QCOMPARE(compact->d()->charCodeAt(3), char16_t(0xe9));
+
+    const QJSValue result = jsEngine.evaluate(QStringLiteral(R"(
+        const parsed = JSON.parse('{"alpha": 1, "béta": 2, "日": 3}');
+        Object.keys(parsed).join() + ":" + parsed.alpha + parsed["béta"] + parsed["日"]
+            + ("al" + "pha" in parsed)
+    )"));
+    QCOMPARE(result.toString(), QString::fromUtf8("alpha,b\xc3\xa9ta,\xe6\x97\xa5:123true"));
+}
+
+void tst_qv4mm::dictionaryInternalClasses()
+{
+    QJSEngine jsEngine;
+    QV4::ExecutionEngine *v4 = jsEngine.handle();
+
+    const QV4::InternalClassStatistics before = QV4::internalClassStatistics(v4);
+    QJSValue result = jsEngine.evaluate(QStringLiteral(R"(
+        function Proto() {}
+        var map = new Proto;
+        for (let i = 0; i < 2000; ++i)
+            map["key" + i] = i;
+        Object.defineProperty(map, "accessor", { get() { return this.key7 * 2; }, configurable: true });
+
+        function readKey7(o) { return o.key7; }
+        function readInherited(o) { return o.inherited; }
+        map;
+    )"));
+    QVERIFY2(!result.isError(), qPrintable(result.toString()));
+
+    QJSValue map = result;
+    QJSValue readKey7 = jsEngine.globalObject().property(QStringLiteral("readKey7"));
+    QJSValue readInherited = jsEngine.globalObject().property(QStringLiteral("readInherited"));
+    for (int i = 0; i < 10; ++i) {
+        QCOMPARE(readKey7.call({ map }).toInt(), 7);
+        QVERIFY(readInherited.call({ map }).isUndefined());
+    }
+
+    // Members added to the dictionary in place have to show up in cached lookups.
+    jsEngine.evaluate(QStringLiteral("Proto.prototype.inherited = 'proto'"));
+    QCOMPARE(readInherited.call({ map }).toString(), QStringLiteral("proto"));
+    jsEngine.evaluate(QStringLiteral("map.inherited = 'own'"));
+    QCOMPARE(readInherited.call({ map }).toString(), QStringLiteral("own"));
+
+    QVERIFY(map.deleteProperty(QStringLiteral("key7")));
+    QVERIFY(readKey7.call({ map }).isUndefined());
+    jsEngine.evaluate(QStringLiteral("map.key7 = 70"));
+    QCOMPARE(readKey7.call({ map }).toInt(), 70);
+    QCOMPARE(map.property(QStringLiteral("accessor")).toInt(), 140);
+    QCOMPARE(map.property(QStringLiteral("key1999")).toInt(), 1999);
+    QCOMPARE(jsEngine.evaluate(QStringLiteral("Object.keys(map).length")).toInt(), 2001);
+
+    // Objects used as prototypes can be dictionaries, too.
+    result = jsEngine.evaluate(QStringLiteral(R"(
+        var base = {};
+        for (let i = 0; i < 500; ++i)
+            base["p" + i] = i;
+        var derived = Object.create(base);
+        function readP(o) { return o.p499; }
+        readP(derived);
+    )"));
+    QCOMPARE(result.toInt(), 499);
+    result = jsEngine.evaluate(QStringLiteral("base.p500 = 500; delete base.p499; readP(derived)"));
+    QVERIFY(result.isUndefined());
+
+    result = jsEngine.evaluate(QStringLiteral("JSON.parse(JSON.stringify(map))"));
+    QCOMPARE(result.property(QStringLiteral("key1999")).toInt(), 1999);
+    QCOMPARE(result.property(QStringLiteral("key0")).toInt(), 0);
+    jsEngine.collectGarbage();
+
+    const QV4::InternalClassStatistics after = QV4::internalClassStatistics(v4);
+    QVERIFY(after.dictionaryClasses > before.dictionaryClasses);
+
+    // Without dictionaries, each of the members added above would have its own class.
+    QVERIFY(after.classes - before.classes < 2000);
+    QVERIFY(after.totalBytes() > 0);
+}
+
 QTEST_MAIN(tst_qv4mm)
 
 #include "tst_qv4mm.moc"
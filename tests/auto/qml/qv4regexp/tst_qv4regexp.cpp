@@ -3,6 +3,11 @@
 
 #include <qtest.h>
 #include <QtQml/qjsengine.h>
+#include <private/qv4regexp_p.h>
+
+#include <algorithm>
+
+using namespace Qt::StringLiterals;
 
 class tst_qv4regexp : public QObject
 {
@@ -10,6 +15,10 @@ class tst_qv4regexp : public QObject
 
 private slots:
     void catchJitFail();
+    void sharedJitCode();
+    void backReferences_data();
+    void backReferences();
+    void backReferenceFallbackKeepsJit();
 };
 
 void tst_qv4regexp::catchJitFail()
@@ -23,6 +32,126 @@ void tst_qv4regexp::catchJitFail()
     QVERIFY(result.toBool());
 }
 
+void tst_qv4regexp::sharedJitCode()
+{
+#if ENABLE(YARR_JIT)
+    const QString program = QLatin1String(
+            "var matches = 0;"
+            "for (var i = 0; i < 10; ++i) {"
+            "    if (/^shared-(\\d+)-code$/.test('shared-' + i + '-code'))"
+            "        ++matches;"
+            "}"
+            "matches;");
+
+    QV4::RegExpCodeCache *cache = QV4::RegExpCodeCache::instance();
+    const QV4::RegExpCodeCache::Statistics before = cache->statistics();
+
+    {
+        QJSEngine engine;
+        QCOMPARE(engine.evaluate(program).toInt(), 10);
+    }
+
+    const QV4::RegExpCodeCache::Statistics compiled = cache->statistics();
+    if (compiled.misses == before.misses)
+        QSKIP("The regular expression JIT is not available.");
+    QCOMPARE(compiled.misses, before.misses + 1);
+
+    // The first engine is gone, but the code is still cached.
+    QJSEngine engine;
+    QCOMPARE(engine.evaluate(program).toInt(), 10);
+
+    const QV4::RegExpCodeCache::Statistics shared = cache->statistics();
+    QCOMPARE(shared.misses, compiled.misses);
+    QCOMPARE(shared.hits, compiled.hits + 1);
+#else
+    QSKIP("The regular expression JIT is not available.");
+#endif
+}
+
+void tst_qv4regexp::backReferences_data()
+{
+    QTest::addColumn<QString>("regexp");
+    QTest::addColumn<QString>("subject");
+    QTest::addColumn<bool>("jitted");
+
+    QTest::newRow("plain") << u"/(ab)\\1/"_s << u"xabab"_s << true;
+    QTest::newRow("named") << u"/(?<pair>ab)\\k<pair>/"_s << u"xabab"_s << true;
+    QTest::newRow("forward") << u"/\\1(ab)/"_s << u"xab"_s << true;
+    QTest::newRow("ignore case, Latin-1") << u"/(\u00e9t\u00e9)\\1/i"_s
+                                          << u"x\u00e9t\u00e9\u00c9T\u00c9"_s << true;
+    QTest::newRow("ignore case, Cyrillic") << u"/(\u0434\u0430)\\1/i"_s
+                                           << u"x\u0434\u0430\u0414\u0410"_s << false;
+}
+
+void tst_qv4regexp::backReferences()
+{
+    QFETCH(QString, regexp);
+    QFETCH(QString, subject);
+    QFETCH(bool, jitted);
+
+    QJSEngine engine;
+    engine.globalObject().setProperty(u"subject"_s, subject);
+    const QJSValue result = engine.evaluate(
+            u"var matches = 0;"
+            "for (var i = 0; i < 10; ++i) {"
+            "    if (%1.test(subject))"
+            "        ++matches;"
+            "}"
+            "matches;"_s.arg(regexp));
+    QCOMPARE(result.toInt(), 10);
+
+#if ENABLE(YARR_JIT_BACKREFERENCES)
+    QV4::RegExpCodeCache *cache = QV4::RegExpCodeCache::instance();
+    if (cache->statistics().entries == 0)
+        QSKIP("The regular expression JIT is not available.");
+
+    const QString pattern = regexp.mid(1, regexp.lastIndexOf(u'/') - 1);
+    const auto fallbacks = cache->interpreterFallbacks();
+    const bool fellBack = std::any_of(
+            fallbacks.begin(), fallbacks.end(),
+            [&](const QV4::RegExpCodeCache::InterpreterFallback &fallback) {
+        return fallback.pattern == pattern;
+    });
+    QCOMPARE(fellBack, !jitted);
+#else
+    Q_UNUSED(jitted);
+#endif
+}
+
+void tst_qv4regexp::backReferenceFallbackKeepsJit()
+{
+#if ENABLE(YARR_JIT_BACKREFERENCES)
+    // Subjects the JIT can't fold are matched by the interpreter. That must not stop the JIT
+    // from matching the other ones.
+    QJSEngine engine;
+    const QJSValue result = engine.evaluate(
+            u"var re = /(k.)\\1/i;"
+            "var subjects = ['xkaKA', 'xk\u0434K\u0414'];"
+            "var matches = 0;"
+            "for (var i = 0; i < 20; ++i) {"
+            "    if (re.test(subjects[i % 2]))"
+            "        ++matches;"
+            "}"
+            "matches;"_s);
+    QCOMPARE(result.toInt(), 20);
+
+    QV4::RegExpCodeCache *cache = QV4::RegExpCodeCache::instance();
+    if (cache->statistics().entries == 0)
+        QSKIP("The regular expression JIT is not available.");
+
+    const auto fallbacks = cache->interpreterFallbacks();
+    const auto fallback = std::find_if(
+            fallbacks.begin(), fallbacks.end(),
+            [](const QV4::RegExpCodeCache::InterpreterFallback &fallback) {
+        return fallback.pattern == u"(k.)\\1"_s;
+    });
+    QVERIFY(fallback != fallbacks.end());
+    QVERIFY(fallback->count <= 10);
+#else
+    QSKIP("The regular expression JIT does not support back references here.");
+#endif
+}
+
 QTEST_MAIN(tst_qv4regexp)
 
 #include "tst_qv4regexp.moc"
@@ -56,6 +56,47 @@ static bool argumentsFromCommandLineAndFile(QStringList& allArguments, const QSt
     return true;
 }
 
+static int generatePack(const QStringList &sources, const QString &outputFileName)
+{
+    QV4::CompiledData::UnitPackBuilder builder;
+    for (const QString &inputFile : sources) {
+        const QString fileName = QFileInfo(inputFile).fileName();
+        const QQmlJSSaveFunction saveFunction = [&builder, &fileName](
+                const QV4::CompiledData::SaveableUnitPointer &unit,
+                const QQmlJSAotFunctionMap &aotFunctions, QString *errorString) {
+            Q_UNUSED(aotFunctions);
+            return unit.saveToDisk<char>(
+                    [&builder, &fileName, errorString](const char *data, quint32 size) {
+                        return builder.addUnit(fileName, data, size, errorString);
+            });
+        };
+
+        QQmlJSCompileError error;
+        if (inputFile.endsWith(".qml"_L1)) {
+            if (!qCompileQmlFile(inputFile, saveFunction, nullptr, &error,
+                                 /* storeSourceLocation */ false)) {
+                error.augment("Error compiling qml file: "_L1).print();
+                return EXIT_FAILURE;
+            }
+        } else if (inputFile.endsWith(".js"_L1) || inputFile.endsWith(".mjs"_L1)) {
+            if (!qCompileJSFile(inputFile, inputFile, saveFunction, &error)) {
+                error.augment("Error compiling js file: "_L1).print();
+                return EXIT_FAILURE;
+            }
+        } else {
+            fprintf(stderr, "Ignoring %s input file as it is not QML source code\n",
+                    qPrintable(inputFile));
+        }
+    }
+
+    QString errorString;
+    if (!builder.writeToFile(outputFileName, &errorString)) {
+        fprintf(stderr, "Error writing pack file: %s\n", qPrintable(errorString));
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
 int main(int argc, char **argv)
 {
     // Produce reliably the same output for the same input by disabling QHash's random seeding.
@@ -125,6 +166,7 @@ int main(int argc, char **argv)
         GenerateCacheFile,
         GenerateLoader,
         GenerateLoaderStandAlone,
+        GeneratePack,
     } target = GenerateCacheFile;
 
     QString outputFileName;
@@ -135,6 +177,8 @@ int main(int argc, char **argv)
         target = GenerateCpp;
         if (outputFileName.endsWith("qmlcache_loader.cpp"_L1))
             target = GenerateLoader;
+    } else if (outputFileName.endsWith(".qmlcpack"_L1)) {
+        target = GeneratePack;
     }
 
     if (target == GenerateLoader && parser.isSet(resourceNameOption))
@@ -164,7 +208,8 @@ int main(int argc, char **argv)
     const QStringList sources = parser.positionalArguments();
     if (sources.isEmpty()){
         parser.showHelp();
-    } else if (sources.size() > 1 && (target != GenerateLoader && target != GenerateLoaderStandAlone)) {
+    } else if (sources.size() > 1 && (target != GenerateLoader && target != GenerateLoaderStandAlone
+                                      && target != GeneratePack)) {
         fprintf(stderr, "%s\n", qPrintable("Too many input files specified: '"_L1 + sources.join("' '"_L1) + u'\''));
         return EXIT_FAILURE;
     }
@@ -176,6 +221,9 @@ int main(int argc, char **argv)
     if (parser.isSet(filterResourceFileOption))
         return qRelocateResourceFile(inputFile, outputFileName);
 
+    if (target == GeneratePack)
+        return generatePack(sources, outputFileName);
+
     if (target == GenerateLoader) {
         QQmlJSResourceFileMapper mapper(sources);
 
@@ -179,7 +179,14 @@ void QmlProfilerData::addEventType(const QQmlProfilerEventType &type)
         displayName = QString::fromLatin1("SceneGraph:%1").arg(type.detailType());
         break;
     case MemoryAllocation:
-        displayName = QString::fromLatin1("MemoryAllocation:%1").arg(type.detailType());
+        if (type.location().filename().isEmpty()) {
+            displayName = QString::fromLatin1("MemoryAllocation:%1").arg(type.detailType());
+        } else {
+            // allocation site
+            const QString filePath = QUrl(type.location().filename()).path();
+            displayName = QStringView{filePath}.mid(filePath.lastIndexOf(QLatin1Char('/')) + 1)
+                    + QLatin1Char(':') + QString::number(type.location().line());
+        }
         break;
     case DebugMessage:
         displayName = QString::fromLatin1("DebugMessage:%1").arg(type.detailType());